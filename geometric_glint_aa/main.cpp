@@ -11,6 +11,8 @@
 #include "scenerunner.h"
 #include "scene_obj.h"
 
+#include <cstdlib>
+
 std::map<std::string, std::string> sceneInfo = {
 	{ "Ogre"		, "Extra"},
 	{ "Arctic"		, "Figure 1"},
@@ -22,16 +24,43 @@ std::map<std::string, std::string> sceneInfo = {
 
 int main(int argc, char *argv[])
 {
-	if (argc != 2)
+	if (argc < 2)
 	{ 
 		std::cout << "Please launch with scene param: Sphere | Tubes | Arctic | Sponza | Ogre" << std::endl << "Launching default: Arctic." << std::endl;
 	}
-	std::string scene_name = (argc != 2) ? "Arctic" : SceneRunner::parseCLArgs(argc, argv, sceneInfo);
+	std::string scene_name = (argc < 2) ? "Arctic" : SceneRunner::parseCLArgs(argc, argv, sceneInfo);
+
+	// Reference options, after the scene name:
+	//   --samples <spp>                         default 1024
+	//   --sampler <grid|sobol|r2|bluenoise>     default grid
+	//   --checkpoint <file>                     write checkpoints of the reference
+	//   --resume                                resume the reference of the checkpoint
+	SceneSettings settings;
+	for (int i = 2; i < argc; i++) {
+		std::string option = argv[i];
+		if (option == "--resume") {
+			settings.reference_resume = true;
+			continue;
+		}
+		if (i + 1 == argc) {
+			std::cout << "Ignored option: " << option << std::endl;
+			break;
+		}
+		std::string value = argv[++i];
+		glint::SampleSequence sequence;
+		if (option == "--samples" && std::atoi(value.c_str()) > 0)
+			settings.reference_samples = std::atoi(value.c_str());
+		else if (option == "--sampler" && glint::parseSampleSequence(value, sequence))
+			settings.reference_sequence = int(sequence);
+		else if (option == "--checkpoint")
+			settings.reference_checkpoint = value;
+		else
+			std::cout << "Ignored option: " << option << " " << value << std::endl;
+	}
 
 	SceneRunner runner("Real Time Glint - " + scene_name, 1600, 900);
 
 	std::unique_ptr<Scene> scene;
-	SceneSettings settings;
 	if (scene_name == "Arctic") {
 		settings.model_path = MEDIA_PATH + std::string("snow/snowman_applied_modifiers.obj");
 		settings.camera_position = glm::vec3(-17.f, 1.751f, -1.408f);
@@ -8,11 +8,15 @@
 // Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
 
 #include "scene_obj.h"
+#include "dictionary.h"
 
+#include <algorithm>
+#include <cmath>
 #include <time.h>
 #include <string>
 #include <sstream>
 #include <iostream>
+#include <fstream>
 
 #include <glm/gtc/matrix_transform.hpp>
 #include "imgui/imgui.h"
@@ -34,6 +38,11 @@ SceneObj::SceneObj(const SceneSettings& settings) :
 	point_light_intensity(settings.point_light_intensity),		// Point light intensity
 	dir_light_dir(settings.directional_light_direction),		// Directional light (the direction in spherical coordinates)
 	dir_light_intensity(settings.directional_light_intensity),	// Directional light intensity
+	area_light_shape(0),										// Area light: 0 none, 1 rectangle, 2 disk
+	area_light_pos(settings.point_light_position),				// Area light center
+	area_light_size(0.5f, 0.5f),								// Area light half extents
+	area_light_dir(3.14f, 0.f),									// Area light facing direction (down)
+	area_light_radiance(10.f),									// Area light radiance
 	envmap_intensity_scale(settings.scale_intensity_envmap),	// Environment map intensity multiplier
 	
 	override_materials_params(false),		// Override materials parameters
@@ -46,7 +55,29 @@ SceneObj::SceneObj(const SceneSettings& settings) :
 	kernel_size(0.5f),				// Size of the filtering kernel
 	use_hemis_derivatives(true),
 	
-	super_sampling(false),			// Super sampling activation. Use to produce references.
+	super_sampling(settings.reference_resume),			// Super sampling activation. Use to produce references.
+	super_sampling_count(std::max(1, settings.reference_samples)),	// Samples per pixel of the references
+	reference_sequence(int(settings.reference_sequence)),			// Subpixel sample positions of the references
+	reference_samples_per_frame(4),	// Samples of the progressive reference per displayed frame
+	reference_shader_samples(1),	// Subsamples per axis shaded by the fragment shader (1: ground truth)
+	reference_sample_count(0),		// DON'T MODIFY
+	reference_reset(true),			// DON'T MODIFY
+	reference_adaptive(false),		// Stop the reference once most pixels have converged
+	reference_error_threshold(0.02f),	// Relative standard error of a converged pixel
+	reference_converged_target(0.99f),	// Fraction of converged pixels that stops the reference
+	reference_min_samples(16),		// Samples before the first convergence test
+	reference_tiles_valid(false),	// DON'T MODIFY
+	reference_converged_fraction(0.f),	// DON'T MODIFY
+	reference_index(0),				// DON'T MODIFY
+	reference_checkpoint(!settings.reference_checkpoint.empty()),	// Write checkpoints of the references
+	reference_checkpoint_interval(64),	// Samples between two checkpoints
+	reference_checkpoint_path(settings.reference_checkpoint.empty() ? "./glints_reference.ckpt" : settings.reference_checkpoint),
+	reference_resume(settings.reference_resume),	// Resume the checkpoint at the first frame
+	use_taa(false),					// Temporal anti-aliasing of the interactive frames
+	taa_feedback(0.1f),				// Weight of the current frame in the TAA history
+	taa_frame(0),					// DON'T MODIFY
+	taa_index(0),					// DON'T MODIFY
+	taa_history_valid(false),		// DON'T MODIFY
 	tonemapping(true),				// Apply tone mapping to the final image. It is applied during the post-process phase.
 	max_intensity(10.),				// Exposure of the final image. It is applied during the post-process phase.
 	gamma_correction(true),			// Apply gamma correction to the final image. It is applied during the post-process phase.
@@ -55,22 +86,60 @@ SceneObj::SceneObj(const SceneSettings& settings) :
 	lean_mode(0),					// 0 Full lean mapping, 1 lean mapping without rho, 
 	use_env_map(true),				// true: use envmap
 	use_bump(true),					// true: activate bump mapping
+	cell_count_view(0),				// 0 shading, 1 heat map of the cells of the ellipse bounding boxes, 2 of the visited cells
+	use_cell_tables(true),			// true: occupancy bitmask, disabled for references
+#ifdef GLINT_SHADER_FLOAT16
+	use_float16(true),				// true: half-precision glint shader, when supported
+#else
+	use_float16(false),				// true: half-precision glint shader, when supported
+#endif
+	paired_dictionary(false),		// true: one fetch of the paired layout of the dictionary per cell (N pairs of marginals only)
+	stochastic_lod(false),			// true: one glint LOD per pixel instead of the interpolation of two
+	frame_index(0),					// DON'T MODIFY, decorrelates the stochastic LOD of successive frames and samples
+	gpu_frame_ms(0.f),				// DON'T MODIFY, GPU time of the last measured frame
+	adaptive_cell_budget(false),	// true: fewer glint cells per pixel when the frame exceeds target_frame_ms
+	target_frame_ms(16.6f),			// Target GPU frame time of the adaptive cell budget
+	glint_cull_threshold(0.f),		// Lights with a glint radiance bounded by glint_cull_threshold * max_intensity are skipped, 0: off
+	glint_cache(CacheAtlasPages * CacheAtlasPages),
+	use_glint_cache(false),			// true: glint specular of the point and directional lights read from the texture-space cache
+	glint_cache_tolerance(0.01f),	// Relative change of the camera, lights or materials that shades the cached pages again
+	glint_cache_pages_per_frame(64),// Pages of the cache shaded per frame
+	glint_cache_shaded_pages(0),	// DON'T MODIFY
+	cache_feedback_index(0),		// DON'T MODIFY
+	cache_feedback_frame(0),		// DON'T MODIFY
+	depth_prepass(true),			// true: depth prepass, the glint shader only runs on visible fragments
+	shading_path(0),				// 0 forward, 1 deferred, 2 forward with the glints of the lights in the tiled compute pass (when supported)
+	glint_resolution_scale(1),		// 1, 2 or 4: resolution divider of the glints of the lights of the deferred pass
+	glint_low_res_scale(0),			// DON'T MODIFY
+	tex_glint_low_res(0),			// DON'T MODIFY
+	fbo_glint_low_res(0),			// DON'T MODIFY
+	glint_work_capacity(0),			// DON'T MODIFY
+	use_clustered_lights(false),	// true: clustered point lights (when supported)
+	cluster_lights_dirty(true),		// DON'T MODIFY
+	cluster_light_count(256),		// Number of clustered point lights
+	cluster_light_intensity(1.f),	// Intensity of each clustered point light
+	cluster_light_spread(10.f),		// Half extent of the box of the clustered lights, around the point light
+	cluster_light_cutoff(0.01f),	// Irradiance at the radius of influence of a clustered light
 
 	// Record parameter
 	format(true),					// true PNG, false EXR
 	show_imgui(true),				// DON'T MODIFY, used to hide imgui when a frame capture is made.
 
 	// CONSTANT
-	super_sampling_count(32),		// DON'T MODIFY, Square root number of samples. Use to produce references.
 	tPrev(0.0f),					// DON'T MODIFY
 	skybox(1000.)					// DON'T MODIFY
 {}
 
 void SceneObj::initScene() {
 
+	// Build option GLINT_SHADER_FLOAT16 without driver support
+	use_float16 = use_float16 && shaderFloat16;
+
 	compileAndLinkShader();
 	
 	setupSuperSampling();
+	setupReferenceStatistics();
+	setupTAA();
 	setupPostProcessing();
 	setupQuad();
 
@@ -82,25 +151,98 @@ void SceneObj::initScene() {
 	projection = glm::perspective(glm::radians(60.0f), (float)width / height, 0.01f, 2000.0f);
 	
 
-	// Constant uniform values that don't need to be modified during the update phase.
-	prog_glints.use();
-	prog_glints.setUniform("Resolution", glm::ivec2(width, height));
-
-
 	// Load multiscale dictionary of marginal distributions
 	int numberOfLevels = 16;
-	int numberOfDistributionsPerChannel = 64;
-	dicoTex = Texture::loadMultiscaleMarginalDistributions(MEDIA_PATH + std::string("../media/dictionary/dict_16_192_64_0p5_0p02"), numberOfLevels, numberOfDistributionsPerChannel);
-	
-	prog_glints.setUniform("Dictionary.Alpha", 0.5f);
-	prog_glints.setUniform("Dictionary.N", numberOfDistributionsPerChannel * 3);
-	prog_glints.setUniform("Dictionary.NLevels", numberOfLevels);
-	prog_glints.setUniform("Dictionary.Pyramid0Size", 1 << (numberOfLevels - 1));
+	dictionary_levels = numberOfLevels;
+	dictionary_dists_per_channel = 64;
+	glint::Dictionary dictionary;
+	if (!dictionary.load(MEDIA_PATH + std::string("../media/dictionary/dict_16_192_64_0p5_0p02"), numberOfLevels, dictionary_dists_per_channel))
+		exit(-1);
+	dicoTex = Texture::createMultiscaleMarginalDistributions(dictionary);
+	paired_dico_tex = Texture::createPairedMarginalDistributions(dictionary);
+	dictionary_max_value = dictionary.MaxValue();
+
+	// Glint constants of the materials and of the user values
+	m_model.updateGlintLod(numberOfLevels);
+	user_glint_lod = glint::makeGlintLodBlock(numberOfLevels, log_microfacet_density, microfacet_relative_area);
+	glGenBuffers(1, &user_glint_ubo);
+	glBindBuffer(GL_UNIFORM_BUFFER, user_glint_ubo);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(user_glint_lod), &user_glint_lod, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	glBindBufferBase(GL_UNIFORM_BUFFER, 1, user_glint_ubo);
+
+	// Cell occupancy bitmasks of the user and of the material relative areas
+	cell_table_levels = numberOfLevels + 1;
+	occupancy_areas.push_back(microfacet_relative_area);
+	for (float area : m_model.getMicrofacetRelativeAreas())
+		if (occupancy_areas.size() < 16) // MAX_OCCUPANCY_AREAS
+			occupancy_areas.push_back(area);
+	occupancy_tex = Texture::createCellOccupancyTexture(occupancy_areas, cell_table_levels);
+
+	blue_noise_tex = Texture::createBlueNoiseTexture(64);
+
+	setupGlintCache();
+	setupGlintGBuffer();
+	if (computeShaders) {
+		setupGlintCompute();
+		setupClusteredLights();
+	}
 
+	setGlintConstantUniforms();
+}
+
+// Constant uniform values that don't need to be modified during the update
+// phase. Set again when the glint shader is recompiled.
+void SceneObj::setGlintConstantUniforms() {
+	for (GLSLProgram* prog : { &prog_glints, &prog_glints_deferred }) {
+		prog->use();
+		prog->setUniform("Resolution", glm::ivec2(width, height));
+
+		prog->setUniform("Dictionary.Alpha", 0.5f);
+		prog->setUniform("Dictionary.N", dictionary_dists_per_channel * 3);
+		prog->setUniform("Dictionary.NLevels", dictionary_levels);
+		prog->setUniform("Dictionary.Pyramid0Size", 1 << (dictionary_levels - 1));
+		prog->setUniform("Dictionary.MaxValue", dictionary_max_value);
+
+		prog->setUniform("CellTableLevels", cell_table_levels);
+		prog->setUniform("OccupancyAreaCount", int(occupancy_areas.size()));
+		for (int i = 0; i < int(occupancy_areas.size()); i++)
+			prog->setUniform(("OccupancyAreas[" + std::to_string(i) + "]").c_str(), occupancy_areas[i]);
+	}
+
+	// The deferred pass reads the glint constants from the G-buffer
+	prog_glints.use();
+	prog_glints.bindUniformBlock(Mesh::GlintBlockBinding, "MaterialGlintBlock");
+	prog_glints.bindUniformBlock(1, "UserGlintBlock");
+
+	if (!computeShaders)
+		return;
+	prog_glints_compute.use();
+	prog_glints_compute.setUniform("Dictionary.Alpha", 0.5f);
+	prog_glints_compute.setUniform("Dictionary.N", dictionary_dists_per_channel * 3);
+	prog_glints_compute.setUniform("Dictionary.NLevels", dictionary_levels);
+	prog_glints_compute.setUniform("Dictionary.Pyramid0Size", 1 << (dictionary_levels - 1));
+	prog_glints_compute.setUniform("Dictionary.MaxValue", dictionary_max_value);
+	prog_glints_compute.setUniform("CellTableLevels", cell_table_levels);
+	prog_glints_compute.setUniform("OccupancyAreaCount", int(occupancy_areas.size()));
+	for (int i = 0; i < int(occupancy_areas.size()); i++)
+		prog_glints_compute.setUniform(("OccupancyAreas[" + std::to_string(i) + "]").c_str(), occupancy_areas[i]);
 }
 
 bool SceneObj::update(float t, GLFWwindow* window) {
 	
+	// Cell budget from the GPU time of a previous frame
+	float gpuMs;
+	if (gpu_timer.lastResult(gpuMs)) {
+		gpu_frame_ms = gpuMs;
+		cell_budget_controller.SetTargetMs(target_frame_ms);
+		cell_budget_controller.SetMaxAnisotropy(max_anisotropy);
+		if (adaptive_cell_budget)
+			cell_budget_controller.update(gpuMs);
+		else
+			cell_budget_controller.reset();
+	}
+
 	if (show_imgui){
 		// Start the Dear ImGui frame
 		ImGui_ImplOpenGL3_NewFrame();
@@ -116,6 +258,45 @@ bool SceneObj::update(float t, GLFWwindow* window) {
 					ImGui::Checkbox("GGAA", &filter);
 					ImGui::Checkbox("Use hemispherical derivatives", &use_hemis_derivatives);
 					ImGui::SliderFloat("Kernel size", &kernel_size, 0.f, 2.0f);
+					ImGui::Checkbox("Stochastic LOD (one level per pixel)", &stochastic_lod);
+					ImGui::Checkbox("Paired dictionary (one fetch per cell)", &paired_dictionary);
+					ImGui::InputFloat("Glint culling threshold", &glint_cull_threshold, 0.f, 0.f, "%.1e");
+					ImGui::Checkbox("Texture-space glint cache", &use_glint_cache);
+					ImGui::Text("Shading:");
+					ImGui::SameLine();
+					ImGui::RadioButton("Forward", &shading_path, 0);
+					ImGui::SameLine();
+					ImGui::RadioButton("Deferred", &shading_path, 1);
+					if (computeShaders) {
+						ImGui::SameLine();
+						ImGui::RadioButton("Tiled compute glints", &shading_path, 2);
+					}
+					if (shading_path == 1) {
+						ImGui::Text("Glint resolution:");
+						ImGui::SameLine();
+						ImGui::RadioButton("Full", &glint_resolution_scale, 1);
+						ImGui::SameLine();
+						ImGui::RadioButton("Half", &glint_resolution_scale, 2);
+						ImGui::SameLine();
+						ImGui::RadioButton("Quarter", &glint_resolution_scale, 4);
+					}
+					if (use_glint_cache) {
+						ImGui::SliderFloat("Cache tolerance", &glint_cache_tolerance, 0.f, 0.1f, "%.3f");
+						ImGui::SliderInt("Cache pages per frame", &glint_cache_pages_per_frame, 1, 256);
+						ImGui::Text("Resident pages: %d / %d, shaded: %d", glint_cache.ResidentPageCount(), glint_cache.SlotCount(), glint_cache_shaded_pages);
+					}
+					if (shaderFloat16) {
+						bool float16 = use_float16;
+						ImGui::Checkbox("Half-precision glints", &float16);
+						if (float16 != use_float16) {
+							use_float16 = float16;
+							recompileGlintShaders();
+						}
+					}
+					if (ImGui::Checkbox("Depth prepass", &depth_prepass))
+						recompileGlintShaders();
+					if (computeShaders && ImGui::Checkbox("Clustered point lights", &use_clustered_lights))
+						recompileGlintShaders();
 
 					ImGui::Separator();
 
@@ -131,7 +312,32 @@ bool SceneObj::update(float t, GLFWwindow* window) {
 
 					ImGui::Separator();
 
-					ImGui::Checkbox("1,024 spp (only for saved frames)", &super_sampling);
+					ImGui::Checkbox("Reference (progressive)", &super_sampling);
+					if (super_sampling) {
+						ImGui::Combo("Sampler", &reference_sequence, "Grid\0Sobol\0R2\0Blue noise\0");
+						ImGui::InputInt("Samples per pixel", &super_sampling_count, 64, 256);
+						super_sampling_count = std::max(1, super_sampling_count);
+						ImGui::SliderInt("Samples per frame", &reference_samples_per_frame, 1, 64);
+						ImGui::Text("Subsamples per axis in the shader");
+						for (int k = 1; k <= 8; k *= 2) {
+							ImGui::SameLine();
+							if (ImGui::RadioButton(std::to_string(k).c_str(), &reference_shader_samples, k))
+								reference_reset = true;
+						}
+						int shader_samples = reference_shader_samples * reference_shader_samples;
+						ImGui::Text("Reference samples: %d / %d", std::min(reference_sample_count * shader_samples, super_sampling_count), super_sampling_count);
+						ImGui::Checkbox("Adaptive stopping", &reference_adaptive);
+						if (reference_adaptive) {
+							ImGui::SliderFloat("Relative error", &reference_error_threshold, 0.001f, 0.2f, "%.3f");
+							ImGui::SliderFloat("Converged pixels", &reference_converged_target, 0.5f, 1.f, "%.3f");
+							ImGui::SliderInt("Samples before the test", &reference_min_samples, 2, 256);
+							ImGui::Text("Converged: %.2f %%", reference_converged_fraction * 100.f);
+						}
+					}
+					if (ImGui::Checkbox("Temporal anti-aliasing", &use_taa))
+						taa_history_valid = false;
+					if (use_taa)
+						ImGui::SliderFloat("TAA feedback", &taa_feedback, 0.02f, 1.f, "%.2f");
 
 					ImGui::Separator();
 
@@ -140,6 +346,7 @@ bool SceneObj::update(float t, GLFWwindow* window) {
 					if (ImGui::Button("Save frame")) {
 						show_imgui = false;
 					}
+					bool output_active = ImGui::IsItemActive();
 					ImGui::SameLine();
 					if (format) {
 						if (ImGui::Button("PNG"))
@@ -148,6 +355,25 @@ bool SceneObj::update(float t, GLFWwindow* window) {
 					else
 						if (ImGui::Button("EXR"))
 							format = !format;
+					output_active = output_active || ImGui::IsItemActive();
+
+					if (super_sampling) {
+						ImGui::Checkbox("Checkpoints", &reference_checkpoint);
+						output_active = output_active || ImGui::IsItemActive();
+						if (reference_checkpoint) {
+							ImGui::SameLine();
+							ImGui::InputInt("Samples between checkpoints", &reference_checkpoint_interval, 16, 64);
+							reference_checkpoint_interval = std::max(1, reference_checkpoint_interval);
+							output_active = output_active || ImGui::IsItemActive();
+						}
+						if (ImGui::Button("Resume checkpoint"))
+							reference_resume = true;
+						output_active = output_active || ImGui::IsItemActive();
+						ImGui::Text("%s", reference_checkpoint_path.c_str());
+					}
+
+					// Any other edit restarts the progressive reference
+					reference_reset = reference_reset || (ImGui::IsAnyItemActive() && !output_active);
 
 					ImGui::EndTabItem();
 				}
@@ -181,6 +407,13 @@ bool SceneObj::update(float t, GLFWwindow* window) {
 				if (ImGui::BeginTabItem("Misc")) {
 
 					ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+					ImGui::Text("GPU %.3f ms/frame", gpu_frame_ms);
+					ImGui::Checkbox("Adaptive cell budget", &adaptive_cell_budget);
+					if (adaptive_cell_budget) {
+						ImGui::SliderFloat("Target frame time (ms)", &target_frame_ms, 4.f, 50.f);
+						glint::CellBudget budget = cell_budget_controller.Budget();
+						ImGui::Text("Cells per level: %d, max anisotropy: %.2f", budget.maxCells, budget.maxAnisotropy);
+					}
 					ImGui::Text("Camera position, x: %.3f, y: %.3f, z: %.3f", camera.Position.x, camera.Position.y, camera.Position.z);
 					ImGui::Text("Camera pitch: %.3f, yaw: %.3f", camera.Pitch, camera.Yaw);
 					
@@ -194,11 +427,11 @@ bool SceneObj::update(float t, GLFWwindow* window) {
 					ImGui::Text("Lighting");
 					if(ImGui::TreeNode("Point light")){
 						ImGui::Columns(3);
-						ImGui::DragFloat("Pos x", &light_pos.x, 1.f, -100.f, 100.f, "%.1f");
+						cluster_lights_dirty |= ImGui::DragFloat("Pos x", &light_pos.x, 1.f, -100.f, 100.f, "%.1f");
 						ImGui::NextColumn();
-						ImGui::DragFloat("Pos y", &light_pos.y, 1.f, -100.f, 100.f, "%.1f");
+						cluster_lights_dirty |= ImGui::DragFloat("Pos y", &light_pos.y, 1.f, -100.f, 100.f, "%.1f");
 						ImGui::NextColumn();
-						ImGui::DragFloat("Pos z", &light_pos.z, 1.f, -100.f, 100.f, "%.1f");
+						cluster_lights_dirty |= ImGui::DragFloat("Pos z", &light_pos.z, 1.f, -100.f, 100.f, "%.1f");
 
 						ImGui::Columns(1);
 						ImGui::DragFloat("Intensity", &point_light_intensity, 1.f, 0.f, 1000.f, "%.1f");
@@ -217,12 +450,56 @@ bool SceneObj::update(float t, GLFWwindow* window) {
 
 					}
 
+					if (ImGui::TreeNode("Area light (centroid/covariance glints)")) {
+						ImGui::RadioButton("None", &area_light_shape, 0);
+						ImGui::SameLine();
+						ImGui::RadioButton("Rectangle", &area_light_shape, 1);
+						ImGui::SameLine();
+						ImGui::RadioButton("Disk", &area_light_shape, 2);
+						ImGui::Columns(3);
+						ImGui::DragFloat("Pos x", &area_light_pos.x, 0.1f, -100.f, 100.f, "%.1f");
+						ImGui::NextColumn();
+						ImGui::DragFloat("Pos y", &area_light_pos.y, 0.1f, -100.f, 100.f, "%.1f");
+						ImGui::NextColumn();
+						ImGui::DragFloat("Pos z", &area_light_pos.z, 0.1f, -100.f, 100.f, "%.1f");
+						ImGui::Columns(2);
+						ImGui::DragFloat("Half width", &area_light_size.x, 0.01f, 0.01f, 10.f, "%.2f");
+						ImGui::NextColumn();
+						ImGui::DragFloat("Half height", &area_light_size.y, 0.01f, 0.01f, 10.f, "%.2f");
+						ImGui::NextColumn();
+						ImGui::DragFloat("Theta", &area_light_dir.x, 0.05f, 0.f, 3.14f, "%.2f");
+						ImGui::NextColumn();
+						ImGui::DragFloat("Phi", &area_light_dir.y, 0.05f, 0.f, 6.28f, "%.2f");
+						ImGui::Columns(1);
+						ImGui::DragFloat("Radiance", &area_light_radiance, 0.1f, 0.f, 1000.f, "%.1f");
+						ImGui::TreePop();
+					}
+
+					if (use_clustered_lights && ImGui::TreeNode("Clustered point lights")) {
+						cluster_lights_dirty |= ImGui::SliderInt("Count", &cluster_light_count, 0, 1024);
+						cluster_lights_dirty |= ImGui::DragFloat("Intensity", &cluster_light_intensity, 0.05f, 0.f, 100.f, "%.2f");
+						cluster_lights_dirty |= ImGui::DragFloat("Spread", &cluster_light_spread, 0.1f, 0.f, 100.f, "%.1f");
+						cluster_lights_dirty |= ImGui::DragFloat("Cutoff", &cluster_light_cutoff, 0.001f, 0.001f, 1.f, "%.3f");
+						ImGui::TreePop();
+					}
+
 					if (ImGui::TreeNode("Env map")) {
 						ImGui::DragFloat("Scale intensity envmap", &envmap_intensity_scale, 0.01f, 0.f, 1.f, "%.2f");
 						ImGui::Checkbox("Use envmap", &use_env_map);
 						ImGui::TreePop();
 					}
 
+					ImGui::Separator();
+
+					ImGui::Text("Cells per pixel (heat map, white: 128)");
+					ImGui::RadioButton("Off", &cell_count_view, 0);
+					ImGui::SameLine();
+					ImGui::RadioButton("Bounding box", &cell_count_view, 1);
+					ImGui::SameLine();
+					ImGui::RadioButton("Visited", &cell_count_view, 2);
+
+					ImGui::Checkbox("Precomputed cell tables", &use_cell_tables);
+
 					ImGui::EndTabItem();
 				}
 
@@ -256,47 +533,42 @@ bool SceneObj::update(float t, GLFWwindow* window) {
 	if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
 		camera.ProcessMouseMovement(0.f, -5.f, deltaT);
 	
+	// A resumed reference restores its camera before the uniforms are set
+	if (super_sampling && reference_resume) {
+		reference_resume = false;
+		loadReferenceCheckpoint();
+	}
 
 	view = camera.GetViewMatrix();
 
-	prog_glints.use();
-	prog_glints.setUniform("CameraPosition", camera.Position);
-
-	prog_glints.setUniform("DictionaryTex", 0);  //layout binding not supported on 4.1 mac
-	prog_glints.setUniform("DiffuseTex", 1);
-	prog_glints.setUniform("SlopeTex", 2);
-	prog_glints.setUniform("SecondMomentTex", 3);
-
-	prog_glints.setUniform("LeanMode", lean_mode);
-
-	prog_glints.setUniform("UserSigmasRho", sigmas_rho);
-	prog_glints.setUniform("UserLogMicrofacetDensity", log_microfacet_density);
-	prog_glints.setUniform("UserMicrofacetRelativeArea", microfacet_relative_area);
-
-	prog_glints.setUniform("Filter", filter && !super_sampling);
-	prog_glints.setUniform("UseHemisDerivatives", use_hemis_derivatives);
-	prog_glints.setUniform("KernelSize", kernel_size);
-
-	prog_glints.setUniform("PointLight.L", glm::vec3(point_light_intensity));
-	prog_glints.setUniform("PointLight.Position", light_pos);
-	prog_glints.setUniform("DirLight.L", glm::vec3(dir_light_intensity));
-	prog_glints.setUniform("DirLight.ThetaPhi", dir_light_dir);
-	prog_glints.setUniform("ScaleIntensityEnvMap", envmap_intensity_scale);
-
-	prog_glints.setUniform("ComputeReference", super_sampling);
+	// Precompute the glint constants of the user values when they change
+	if (user_glint_lod.logMicrofacetDensity != log_microfacet_density ||
+		user_glint_lod.microfacetRelativeArea != microfacet_relative_area) {
+		user_glint_lod = glint::makeGlintLodBlock(dictionary_levels, log_microfacet_density, microfacet_relative_area);
+		glBindBuffer(GL_UNIFORM_BUFFER, user_glint_ubo);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(user_glint_lod), &user_glint_lod);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		// Material 0 of the compute pass
+		if (computeShaders) {
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, glint_work_buffers[4]);
+			glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(user_glint_lod), &user_glint_lod);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		}
+	}
 
-	prog_glints.setUniform("UseEnvMap", use_env_map);
-	prog_glints.setUniform("UseBump", use_bump);
-	prog_glints.setUniform("OnlySpecular", only_specular);
-	prog_glints.setUniform("OverrideMaterials", override_materials_params);
+	// The user relative area has its own bitmask
+	if (occupancy_areas[0] != microfacet_relative_area) {
+		occupancy_areas[0] = microfacet_relative_area;
+		Texture::updateCellOccupancyTexture(occupancy_tex, 0, microfacet_relative_area, cell_table_levels);
+		if (computeShaders) {
+			prog_glints_compute.use();
+			prog_glints_compute.setUniform("OccupancyAreas[0]", microfacet_relative_area);
+		}
+	}
 
-	prog_glints.setUniform("DictionaryTex",0);
-	prog_glints.setUniform("DiffuseTex",1);
-	prog_glints.setUniform("SlopeTex",2);
-	prog_glints.setUniform("SecondMomentTex",3);
-	prog_glints.setUniform("SpecularTex",4);
-	prog_glints.setUniform("MaskTex",5);
-	prog_glints.setUniform("EnvMap",6);
+	// The mesh pass and the deferred pass share their parameters
+	setGlintUniforms(prog_glints);
+	setGlintUniforms(prog_glints_deferred);
 
 	prog_post_processing.use();
 	prog_post_processing.setUniform("MaxIntensity", max_intensity);
@@ -307,6 +579,77 @@ bool SceneObj::update(float t, GLFWwindow* window) {
 	return false;
 }
 
+void SceneObj::setGlintUniforms(GLSLProgram& prog) {
+	prog.use();
+	prog.setUniform("CameraPosition", camera.Position);
+
+	prog.setUniform("LeanMode", lean_mode);
+
+	prog.setUniform("UserSigmasRho", sigmas_rho);
+	prog.setUniform("OccupancyAreas[0]", occupancy_areas[0]);
+
+	prog.setUniform("UseCellTables", use_cell_tables && !super_sampling);
+	prog.setUniform("StochasticLOD", stochastic_lod);
+	prog.setUniform("PairedDictionary", paired_dictionary);
+	// Relative to the white point of the tone mapping, off for references
+	prog.setUniform("GlintCullRadiance", super_sampling ? 0.f : std::max(0.f, glint_cull_threshold) * max_intensity);
+
+	prog.setUniform("Filter", filter && !super_sampling);
+	prog.setUniform("UseHemisDerivatives", use_hemis_derivatives);
+	prog.setUniform("KernelSize", kernel_size);
+
+	prog.setUniform("PointLight.L", glm::vec3(point_light_intensity));
+	prog.setUniform("PointLight.Position", light_pos);
+	prog.setUniform("DirLight.L", glm::vec3(dir_light_intensity));
+	prog.setUniform("DirLight.ThetaPhi", dir_light_dir);
+
+	// Basis of the area light, cross(U, V) is its facing direction
+	glm::vec3 n(std::cos(area_light_dir.y) * std::sin(area_light_dir.x), std::cos(area_light_dir.x),
+		std::sin(area_light_dir.y) * std::sin(area_light_dir.x));
+	glm::vec3 t = glm::normalize(glm::cross(n, std::abs(n.y) < 0.99f ? glm::vec3(0.f, 1.f, 0.f) : glm::vec3(1.f, 0.f, 0.f)));
+	glm::vec3 b = glm::cross(n, t);
+	prog.setUniform("AreaLight.Shape", area_light_shape);
+	prog.setUniform("AreaLight.Position", area_light_pos);
+	prog.setUniform("AreaLight.U", t * area_light_size.x);
+	prog.setUniform("AreaLight.V", b * area_light_size.y);
+	prog.setUniform("AreaLight.L", glm::vec3(area_light_radiance));
+	prog.setUniform("ScaleIntensityEnvMap", envmap_intensity_scale);
+
+	prog.setUniform("ComputeReference", super_sampling);
+
+	prog.setUniform("UseEnvMap", use_env_map);
+	prog.setUniform("UseBump", use_bump);
+	prog.setUniform("OnlySpecular", only_specular);
+	prog.setUniform("CellCountView", cell_count_view);
+	prog.setUniform("OverrideMaterials", override_materials_params);
+
+	prog.setUniform("DictionaryTex",0);  //layout binding not supported on 4.1 mac
+	prog.setUniform("DiffuseTex",1);
+	prog.setUniform("SlopeTex",2);
+	prog.setUniform("SecondMomentTex",3);
+	prog.setUniform("SpecularTex",4);
+	prog.setUniform("MaskTex",5);
+	prog.setUniform("EnvMap",6);
+	prog.setUniform("OccupancyTex",7);
+	prog.setUniform("BlueNoiseTex",9);
+	prog.setUniform("PairedDictionaryTex",10);
+	prog.setUniform("CachePageTable",11);
+	prog.setUniform("CacheAtlas",12);
+	for (int i = 0; i < 6; i++)
+		prog.setUniform(("GlintGBufferTex[" + std::to_string(i) + "]").c_str(), 13 + i);
+	prog.setUniform("CacheMode", use_glint_cache && !super_sampling ? 1 : 0);
+
+	if (use_clustered_lights) {
+		prog.setUniform("ClusterView", view);
+		prog.setUniform("ClusterTiles", glm::ivec2(cluster_grid.tilesX, cluster_grid.tilesY));
+		prog.setUniform("ClusterSlices", cluster_grid.slices);
+		prog.setUniform("MaxLightsPerCluster", cluster_grid.maxLightsPerCluster);
+		prog.setUniform("ClusterSliceScaleBias", cluster_grid.SliceScaleBias());
+		prog.setUniform("ClusterTileScale", glm::vec2(float(cluster_grid.tilesX) / float(width),
+			float(cluster_grid.tilesY) / float(height)));
+	}
+}
+
 void SceneObj::render()
 {
 	// Rendering
@@ -315,7 +658,9 @@ void SceneObj::render()
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// draw calls
+	gpu_timer.begin();
 	drawScene();
+	gpu_timer.end();
 
 	// draw imgui if the frame is not saved.
 	if (show_imgui){
@@ -333,7 +678,7 @@ void SceneObj::render()
 			if (filter)
 				ss_file_name << "filter-ks-" << kernel_size << "_";
 			if (super_sampling)
-				ss_file_name << "ss-" << super_sampling_count << "_";
+				ss_file_name << "ss-" << super_sampling_count << "-" << glint::sampleSequenceName(reference_sampler.Sequence()) << "_";
 			else
 				ss_file_name << tt->tm_year << "-" << tt->tm_mon << "-" << tt->tm_mday << "_" << tt->tm_hour << "-" << tt->tm_min << "-" << tt->tm_sec << "_";
 			return ss_file_name.str();
@@ -359,6 +704,68 @@ void SceneObj::resize(int w, int h)
 	prog_quad_fullscreen.use();
 	prog_quad_fullscreen.setUniform("Resolution", glm::ivec2(width, height));
 	projection = glm::perspective(glm::radians(60.0f), (float)w / h, 0.01f, 2000.0f);
+	reference_reset = true;
+}
+
+// The half-precision variant is the same source compiled as GLSL 4.50 with
+// GLINT_FLOAT16 defined, the variant without mask after the depth prepass
+// with GLINT_DEPTH_PREPASS defined. The deferred shading pass is the same
+// source with GLINT_DEFERRED defined, drawn on a fullscreen quad.
+void SceneObj::compileGlintShader() {
+	std::string fragName = SHADER_PATH + std::string("improved_glint_envmap.frag.glsl");
+	std::ifstream fragFile(fragName);
+	std::stringstream fragSource;
+	fragSource << fragFile.rdbuf();
+	std::string code = fragSource.str();
+	std::string version = use_float16 ? "#version 450\n#define GLINT_FLOAT16\n" : "#version 330\n";
+	if (use_clustered_lights)
+		version = (use_float16 ? version : "#version 430\n") + "#define GLINT_CLUSTERED_LIGHTS\n";
+	code = code.substr(code.find('\n') + 1);
+
+	prog_glints.compileShader((SHADER_PATH + std::string("improved_glint_envmap.vert.glsl")).c_str());
+	std::string prepass = depth_prepass ? "#define GLINT_DEPTH_PREPASS\n" : "";
+	prog_glints.compileShader(version + prepass + code, GLSLShader::FRAGMENT, fragName.c_str());
+	prog_glints.link();
+
+	prog_glints_deferred.compileShader((SHADER_PATH + std::string("render_texture.vert.glsl")).c_str());
+	prog_glints_deferred.compileShader(version + "#define GLINT_DEFERRED\n" + code, GLSLShader::FRAGMENT, fragName.c_str());
+	prog_glints_deferred.link();
+}
+
+// After a change of the compile time options
+void SceneObj::recompileGlintShaders() {
+	prog_glints.reset();
+	prog_glints_deferred.reset();
+	if (computeShaders)
+		prog_glints_compute.reset();
+	try {
+		compileGlintShader();
+		if (computeShaders)
+			compileGlintComputeShader();
+	}
+	catch (GLSLProgramException& e) {
+		std::cerr << e.what() << std::endl;
+		exit(EXIT_FAILURE);
+	}
+	setGlintConstantUniforms();
+}
+
+// The tiled compute pass is the glint fragment shader without its fragment
+// stage (GLINT_COMPUTE), followed by glint_tiled.comp.glsl.
+void SceneObj::compileGlintComputeShader() {
+	std::string fragName = SHADER_PATH + std::string("improved_glint_envmap.frag.glsl");
+	std::string compName = SHADER_PATH + std::string("glint_tiled.comp.glsl");
+	std::ifstream fragFile(fragName);
+	std::ifstream compFile(compName);
+	std::stringstream source;
+	source << (use_float16 ? "#version 450\n#define GLINT_FLOAT16\n" : "#version 430\n");
+	source << "#define GLINT_COMPUTE\n";
+	std::string line;
+	std::getline(fragFile, line); // #version 330
+	source << fragFile.rdbuf() << "\n" << compFile.rdbuf();
+
+	prog_glints_compute.compileShader(source.str(), GLSLShader::COMPUTE, compName.c_str());
+	prog_glints_compute.link();
 }
 
 void SceneObj::compileAndLinkShader() {
@@ -367,14 +774,48 @@ void SceneObj::compileAndLinkShader() {
 		prog_skybox.compileShader((SHADER_PATH + std::string("skybox.frag.glsl")).c_str());
 		prog_skybox.link();
 
-		prog_glints.compileShader((SHADER_PATH + std::string("improved_glint_envmap.vert.glsl")).c_str());
-		prog_glints.compileShader((SHADER_PATH + std::string("improved_glint_envmap.frag.glsl")).c_str());
-		prog_glints.link();
+		compileGlintShader();
+		if (computeShaders) {
+			compileGlintComputeShader();
+			prog_light_clusters.compileShader((SHADER_PATH + std::string("light_clusters.comp.glsl")).c_str(), GLSLShader::COMPUTE);
+			prog_light_clusters.link();
+		}
+
+		// Masked variant: DEPTH_MASKED defined after the #version line
+		std::string depthName = SHADER_PATH + std::string("depth_prepass.frag.glsl");
+		std::ifstream depthFile(depthName);
+		std::stringstream depthSource;
+		depthSource << depthFile.rdbuf();
+		std::string depthCode = depthSource.str();
+		size_t versionEnd = depthCode.find('\n') + 1;
+		std::string maskedCode = depthCode.substr(0, versionEnd) + "#define DEPTH_MASKED\n" + depthCode.substr(versionEnd);
+		prog_depth.compileShader((SHADER_PATH + std::string("improved_glint_envmap.vert.glsl")).c_str());
+		prog_depth.compileShader(depthCode, GLSLShader::FRAGMENT, depthName.c_str());
+		prog_depth.link();
+		prog_depth_masked.compileShader((SHADER_PATH + std::string("improved_glint_envmap.vert.glsl")).c_str());
+		prog_depth_masked.compileShader(maskedCode, GLSLShader::FRAGMENT, depthName.c_str());
+		prog_depth_masked.link();
 	
 		prog_quad_fullscreen.compileShader((SHADER_PATH + std::string("render_texture.vert.glsl")).c_str());
 		prog_quad_fullscreen.compileShader((SHADER_PATH + std::string("render_texture.frag.glsl")).c_str());
 		prog_quad_fullscreen.link();
 
+		prog_glint_upsample.compileShader((SHADER_PATH + std::string("render_texture.vert.glsl")).c_str());
+		prog_glint_upsample.compileShader((SHADER_PATH + std::string("glint_upsample.frag.glsl")).c_str());
+		prog_glint_upsample.link();
+
+		prog_taa.compileShader((SHADER_PATH + std::string("render_texture.vert.glsl")).c_str());
+		prog_taa.compileShader((SHADER_PATH + std::string("taa.frag.glsl")).c_str());
+		prog_taa.link();
+
+		prog_reference_accumulate.compileShader((SHADER_PATH + std::string("render_texture.vert.glsl")).c_str());
+		prog_reference_accumulate.compileShader((SHADER_PATH + std::string("reference_accumulate.frag.glsl")).c_str());
+		prog_reference_accumulate.link();
+
+		prog_reference_convergence.compileShader((SHADER_PATH + std::string("render_texture.vert.glsl")).c_str());
+		prog_reference_convergence.compileShader((SHADER_PATH + std::string("reference_convergence.frag.glsl")).c_str());
+		prog_reference_convergence.link();
+
 		prog_post_processing.compileShader((SHADER_PATH + std::string("postprocessing.vert.glsl")).c_str());
 		prog_post_processing.compileShader((SHADER_PATH + std::string("postprocessing.frag.glsl")).c_str());
 		prog_post_processing.link();
@@ -389,28 +830,84 @@ void SceneObj::compileAndLinkShader() {
 void SceneObj::drawScene() {
 
 
-	// Clear the fbo_super_sampling frame buffer
-	glBindFramebuffer(GL_FRAMEBUFFER, fbo_super_sampling);
-	glClearColor(0., 0., 0., 1.);
-	glClear(GL_COLOR_BUFFER_BIT);
-	glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
 	// Sponza position and scale
 	glm::vec3 pos(0., 0., 0.);
 	
-	// Activate super samping only if the current frame will be saved
-	int AA = (super_sampling && !show_imgui)  ? super_sampling_count : 1;
-	int AAAA = AA * AA;
-
+	// References: the samples of reference_sampler are accumulated over the
+	// displayed frames while nothing changes, a saved frame renders the
+	// missing ones. Each sample covers reference_shader_samples^2 subpixel
+	// samples shaded in the fragment shader.
+	int shader_samples = super_sampling ? reference_shader_samples : 1;
+	int sample_count = 1;
+	if (super_sampling) {
+		int subsamples = shader_samples * shader_samples;
+		sample_count = (super_sampling_count + subsamples - 1) / subsamples;
+		glint::SampleSequence sequence = glint::SampleSequence(reference_sequence);
+		if (reference_sampler.Sequence() != sequence || reference_sampler.Count() != sample_count) {
+			reference_sampler.configure(sequence, sample_count);
+			reference_reset = true;
+		}
+	}
+	if (super_sampling && (reference_reset || view != reference_view)) {
+		reference_sample_count = 0;
+		reference_tiles_valid = false;
+		reference_converged_fraction = 0.f;
+	}
+	reference_reset = false;
+	reference_view = view;
+	int first_sample = super_sampling ? reference_sample_count : 0;
+	int last_sample = !super_sampling ? 1 : !show_imgui ? sample_count : std::min(sample_count, first_sample + reference_samples_per_frame);
+	if (super_sampling)
+		reference_sample_count = last_sample;
+
+	// Temporal anti-aliasing: the sample of the frame is one of the
+	// TaaGrid x TaaGrid grid, 7 being coprime with 16 the successive
+	// samples are far apart
+	bool taa_active = use_taa && !super_sampling;
+	if (!taa_active)
+		taa_history_valid = false;
+
+	// Deferred shading. References keep the full precision of the forward
+	// path (the G-buffer stores half floats).
+	bool deferred_active = shading_path == 1 && !super_sampling;
+
+	// Glints of the lights in the tiled compute pass. References and the
+	// heat map of the cells stay in the fragment shader.
+	bool glint_compute_active = shading_path == 2 && computeShaders && !super_sampling && cell_count_view == 0;
+
+	// Light lists of the froxels, shared by all the samples
+	if (use_clustered_lights)
+		buildLightClusters();
+
+	// Texture-space glint cache: shade the requested pages before the frame.
+	// Forward shading only (the cache is addressed per mesh).
+	bool glint_cache_active = use_glint_cache && !super_sampling && !deferred_active;
+	if (glint_cache_active) {
+		glm::mat4 model = glm::scale(glm::mat4(1.0f), glm::vec3(scale.x, scale.y, scale.z));
+		shadeGlintCache(glm::translate(model, pos));
+	}
 
+	// Clear the fbo_super_sampling frame buffer
+	if (first_sample == 0) {
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo_super_sampling);
+		glClearColor(0., 0., 0., 1.);
+		glClear(GL_COLOR_BUFFER_BIT);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
 
-	for (int i = 0; i < AAAA; i++) {
-	
+	for (int n = first_sample; n < last_sample; n++) {
 		///////////////////////////
 		// Render the scene in a frame buffer
 		//  - generate tex_sample
 		////////////////////////
 
+		// Adaptive reference: only the tiles still unconverged
+		bool reference_tiles_active = super_sampling && reference_tiles_valid;
+		if (reference_tiles_active) {
+			glEnable(GL_SCISSOR_TEST);
+			glScissor(reference_scissor.x, reference_scissor.y, reference_scissor.z, reference_scissor.w);
+		}
+
 
 		glEnable(GL_DEPTH_TEST);
 
@@ -424,12 +921,9 @@ void SceneObj::drawScene() {
 		///////////////////////////
 		// Move the camera for each sample
 
-		float offset_x = (float(i % AA) / float(AA)) * 2.f - 1.f;
-		float offset_y = (float(i / AA) / float(AA)) * 2.f - 1.f;
-		offset_x /= float(width);
-		offset_y /= float(height);
-		offset_x += (1.f / float(AA)) / (float(width));
-		offset_y += (1.f / float(AA)) / (float(height));
+		glm::vec2 offset = taa_active 
+			? sampleOffset((taa_frame * 7) % (TaaGrid * TaaGrid), TaaGrid) 
+			: super_sampling ? pixelOffset(reference_sampler.Sample(n)) : glm::vec2(0.f);
 
 		// Set matrices
 		model = glm::mat4(1.0f);
@@ -437,7 +931,7 @@ void SceneObj::drawScene() {
 		model = glm::translate(model, pos);
 	
 		// Define the view model matrix with an offset defined previously
-		glm::vec3 shift(offset_x, offset_y, 0.);
+		glm::vec3 shift(offset.x, offset.y, 0.);
 		glm::mat4 aa = glm::translate(glm::mat4(1.f), shift);
 		glm::mat4 mv = view * model;
 
@@ -458,6 +952,26 @@ void SceneObj::drawScene() {
 			glEnable(GL_DEPTH_TEST);
 		}
 
+		///////////////////////////
+		// Depth prepass: the meshes without mask texture first, no discard
+
+		if (depth_prepass) {
+			glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+			for (int masked = 0; masked < 2; masked++) {
+				GLSLProgram& prog = masked ? prog_depth_masked : prog_depth;
+				prog.use();
+				prog.setUniform("ModelMatrix", model);
+				prog.setUniform("MVP", aa * projection * mv);
+				prog.setUniform("MaskTex", 5);
+				m_model.DrawDepth(prog, masked == 1);
+			}
+			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+			// Only the visible fragments are shaded
+			glDepthFunc(GL_EQUAL);
+			glDepthMask(GL_FALSE);
+		}
+
 		///////////////////////////
 		// Draw scene
 		
@@ -465,42 +979,131 @@ void SceneObj::drawScene() {
 		prog_glints.setUniform("ModelMatrix", model);
 		prog_glints.setUniform("MVP", aa * projection * mv);
 			
-		prog_glints.setUniform("MaxAnisotropy", max_anisotropy);
+		// References are never degraded
+		if (adaptive_cell_budget && !super_sampling) {
+			glint::CellBudget budget = cell_budget_controller.Budget();
+			prog_glints.setUniform("MaxAnisotropy", budget.maxAnisotropy);
+			prog_glints.setUniform("GlintCellBudget", budget.maxCells);
+		}
+		else {
+			prog_glints.setUniform("MaxAnisotropy", max_anisotropy);
+			prog_glints.setUniform("GlintCellBudget", glint::kMaxGlintCells);
+		}
 
+		bindGlintTextures();
+
+		// New stochastic LOD pattern for every frame and every sample. The
+		// samples of a reference do not depend on the frames that rendered
+		// them, so that a resumed reference is identical.
+		int sample_frame_index = super_sampling ? n : frame_index++;
+		prog_glints.setUniform("FrameIndex", sample_frame_index);
+		prog_glints.setUniform("GlintEvaluation", deferred_active ? 2 : glint_compute_active ? 1 : 0);
+		prog_glints.setUniform("ReferenceSubsamples", shader_samples);
+		// Side of the pixel area of one sample of the sampler
+		prog_glints.setUniform("ReferenceCellSize", 1.f / std::sqrt(float(sample_count)));
+		prog_glints.setUniform("ReferenceAdaptive", reference_tiles_active);
+		prog_glints.setUniform("ReferenceTileSize", ReferenceTileSize);
+		prog_glints.setUniform("ReferenceTileTex", 19);
+		glActiveTexture(GL_TEXTURE19);
+		glBindTexture(GL_TEXTURE_2D, tex_reference_tiles);
 		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_1D_ARRAY, dicoTex);
 
-		glActiveTexture(GL_TEXTURE6);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, envmap_tex);
+		if (glint_cache_active || glint_compute_active || deferred_active) {
+			// Pages requested by the pixels (location 1 of the glint shader)
+			// and G-buffer (locations 2 to 7). The deferred pass writes the
+			// color of the meshes.
+			GLenum drawBuffers[] = {
+				deferred_active ? GL_NONE : GL_COLOR_ATTACHMENT0, glint_cache_active ? GL_COLOR_ATTACHMENT1 : GL_NONE,
+				GL_COLOR_ATTACHMENT2, GL_COLOR_ATTACHMENT3, GL_COLOR_ATTACHMENT4,
+				GL_COLOR_ATTACHMENT5, GL_COLOR_ATTACHMENT6, GL_COLOR_ATTACHMENT7 };
+			glDrawBuffers(glint_compute_active || deferred_active ? 8 : 2, drawBuffers);
+			GLuint noRequest[] = { 0u, 0u, 0u, 0u };
+			if (glint_cache_active)
+				glClearBufferuiv(GL_COLOR, 1, noRequest);
+			// No glint light on the background (GlintGBuffer2)
+			if (glint_compute_active)
+				glClearBufferuiv(GL_COLOR, 4, noRequest);
+			// No surface on the background (flags of GlintGBuffer3)
+			if (deferred_active)
+				glClearBufferuiv(GL_COLOR, 5, noRequest);
+		}
 
 		m_model.Draw(prog_glints);
 
+		if (depth_prepass) {
+			glDepthFunc(GL_LESS);
+			glDepthMask(GL_TRUE);
+		}
+
+		if (glint_cache_active || glint_compute_active || deferred_active) {
+			GLenum drawBuffer = GL_COLOR_ATTACHMENT0;
+			glDrawBuffers(1, &drawBuffer);
+		}
+		if (glint_cache_active) {
+			writeGlintCacheFeedback();
+			glBindFramebuffer(GL_FRAMEBUFFER, fbo_sample);
+		}
+		if (glint_compute_active)
+			dispatchGlintCompute(sample_frame_index);
+		if (deferred_active)
+			shadeDeferred(sample_frame_index);
+
+		if (reference_tiles_active)
+			glDisable(GL_SCISSOR_TEST);
+
 		///////////////////////////
-		// Render tex_sample on the next framebuffer with an alpha of 1 / AAAA
-		//  - generate tex_super_sampling
+		// References: Welford statistics of the samples
+		//  - generate tex_reference_mean[reference_index]
 		/////////////////////////
 
-		glBindFramebuffer(GL_FRAMEBUFFER, fbo_super_sampling);
-		glDisable(GL_DEPTH_TEST);
+		if (super_sampling) {
+			accumulateReference(n);
 
-		prog_quad_fullscreen.use();
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, tex_sample);
-		prog_quad_fullscreen.setUniform("Tex", 0);
+			// End of a round of the adaptive reference. The rounds only
+			// depend on n: a resumed reference tests the same samples.
+			bool converged = reference_adaptive && n + 1 >= reference_min_samples
+				&& (n + 1) % reference_samples_per_frame == 0
+				&& updateReferenceConvergence(n + 1);
+			if (converged)
+				reference_sample_count = sample_count;
 
-		// Set the blending function
-		glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE);
-		// Set the alpha to 1 / AAAA
-		glBlendColor(0., 0., 0., 1.f / float(AAAA));
+			if (reference_checkpoint && (converged || n + 1 == sample_count || (n + 1) % reference_checkpoint_interval == 0))
+				saveReferenceCheckpoint(converged ? sample_count : n + 1);
 
+			if (converged)
+				break;
+		}
+		else {
+			///////////////////////////
+			// Add tex_sample to the running mean of the samples, alpha of 1 / (n + 1)
+			//  - generate tex_super_sampling
+			/////////////////////////
 
-		glEnable(GL_BLEND);
-		// Draw tex_sample on the quad
-		glBindVertexArray(quad_vao);
-		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-		glDisable(GL_BLEND);
+			glBindFramebuffer(GL_FRAMEBUFFER, fbo_super_sampling);
+			glDisable(GL_DEPTH_TEST);
 
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			prog_quad_fullscreen.use();
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, tex_sample);
+			prog_quad_fullscreen.setUniform("Tex", 0);
+
+			// Set the blending function
+			glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
+			// Set the alpha to 1 / (n + 1)
+			glBlendColor(0., 0., 0., 1.f / float(n + 1));
+
+
+			glEnable(GL_BLEND);
+			// Draw tex_sample on the quad
+			glBindVertexArray(quad_vao);
+			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+			glDisable(GL_BLEND);
+
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		}
+
+		if (taa_active)
+			resolveTAA(projection * mv, aa * projection * mv);
 	
 	}
 
@@ -515,10 +1118,10 @@ void SceneObj::drawScene() {
 	glDisable(GL_DEPTH_TEST);
 
 	
-	// Draw tex_super_sampling on the quad
+	// Draw tex_super_sampling (or the TAA output, or the reference) on the quad
 	prog_post_processing.use();
 	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, tex_super_sampling);
+	glBindTexture(GL_TEXTURE_2D, taa_active ? tex_taa[taa_index] : super_sampling ? tex_reference_mean[reference_index] : tex_super_sampling);
 	prog_post_processing.setUniform("Tex", 0);
 	glBindVertexArray(quad_vao);
 	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
@@ -571,10 +1174,15 @@ void SceneObj::setupSuperSampling() {
 	glBindFramebuffer(GL_FRAMEBUFFER, fbo_sample);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex_sample, 0);
 
-	glGenRenderbuffers(1, &rb_sample_depth_buffer);
-	glBindRenderbuffer(GL_RENDERBUFFER, rb_sample_depth_buffer);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height); // use a single renderbuffer object for both a depth AND stencil buffer.
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rb_sample_depth_buffer); // now actually attach it
+	// A texture rather than a renderbuffer: the TAA reprojects the pixels
+	// with their depth
+	glGenTextures(1, &tex_sample_depth);
+	glBindTexture(GL_TEXTURE_2D, tex_sample_depth);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH24_STENCIL8, width, height, 0, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, tex_sample_depth, 0);
 
 
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
@@ -585,6 +1193,287 @@ void SceneObj::setupSuperSampling() {
 	prog_quad_fullscreen.setUniform("Resolution", glm::ivec2(width, height));
 }
 
+glm::vec2 SceneObj::sampleOffset(int i, int AA) const {
+	float offset_x = (float(i % AA) / float(AA)) * 2.f - 1.f;
+	float offset_y = (float(i / AA) / float(AA)) * 2.f - 1.f;
+	offset_x /= float(width);
+	offset_y /= float(height);
+	offset_x += (1.f / float(AA)) / (float(width));
+	offset_y += (1.f / float(AA)) / (float(height));
+	return glm::vec2(offset_x, offset_y);
+}
+
+glm::vec2 SceneObj::pixelOffset(glm::vec2 u) const {
+	// A pixel is 2 / width wide in NDC, u = 0.5 is its center
+	return (u * 2.f - 1.f) / glm::vec2(float(width), float(height));
+}
+
+void SceneObj::setupTAA() {
+	glGenTextures(2, tex_taa);
+	glGenFramebuffers(2, fbo_taa);
+	for (int i = 0; i < 2; i++) {
+		glBindTexture(GL_TEXTURE_2D, tex_taa[i]);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+		// The history is read between pixels
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo_taa[i]);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex_taa[i], 0);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Blend tex_super_sampling (one sample) with the reprojected history into
+// tex_taa[taa_index]. The history is dropped after a frame without TAA.
+void SceneObj::resolveTAA(const glm::mat4& viewProjection, const glm::mat4& jitteredViewProjection) {
+	int history = taa_index;
+	taa_index = 1 - taa_index;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo_taa[taa_index]);
+	glDisable(GL_DEPTH_TEST);
+
+	prog_taa.use();
+	prog_taa.setUniform("Tex", 0);
+	prog_taa.setUniform("HistoryTex", 1);
+	prog_taa.setUniform("DepthTex", 2);
+	prog_taa.setUniform("InvViewProjection", glm::inverse(jitteredViewProjection));
+	prog_taa.setUniform("PrevViewProjection", taa_prev_view_projection);
+	prog_taa.setUniform("HistoryValid", taa_history_valid);
+	prog_taa.setUniform("Feedback", taa_feedback);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, tex_super_sampling);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, tex_taa[history]);
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, tex_sample_depth);
+
+	glBindVertexArray(quad_vao);
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	taa_prev_view_projection = viewProjection;
+	taa_history_valid = true;
+	taa_frame++;
+}
+
+void SceneObj::setupReferenceStatistics() {
+	glGenTextures(2, tex_reference_mean);
+	glGenTextures(2, tex_reference_m2);
+	glGenFramebuffers(2, fbo_reference);
+	for (int i = 0; i < 2; i++) {
+		GLuint textures[] = { tex_reference_mean[i], tex_reference_m2[i] };
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo_reference[i]);
+		for (int t = 0; t < 2; t++) {
+			glBindTexture(GL_TEXTURE_2D, textures[t]);
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, NULL);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + t, GL_TEXTURE_2D, textures[t], 0);
+		}
+		GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+		glDrawBuffers(2, drawBuffers);
+	}
+
+	// One texel per tile, read back after each round
+	int tiles_x = (width + ReferenceTileSize - 1) / ReferenceTileSize;
+	int tiles_y = (height + ReferenceTileSize - 1) / ReferenceTileSize;
+	glGenTextures(1, &tex_reference_tiles);
+	glBindTexture(GL_TEXTURE_2D, tex_reference_tiles);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, tiles_x, tiles_y, 0, GL_RED, GL_FLOAT, NULL);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glGenFramebuffers(1, &fbo_reference_tiles);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo_reference_tiles);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex_reference_tiles, 0);
+	reference_tile_counts.resize(size_t(tiles_x) * tiles_y);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Add tex_sample, sample n of the reference, to the statistics of the n
+// previous ones. The whole screen is drawn: the converged tiles are copied
+// to the other texture of the pair.
+void SceneObj::accumulateReference(int n) {
+	int previous = reference_index;
+	reference_index = 1 - reference_index;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo_reference[reference_index]);
+	glDisable(GL_DEPTH_TEST);
+
+	prog_reference_accumulate.use();
+	prog_reference_accumulate.setUniform("Tex", 0);
+	prog_reference_accumulate.setUniform("MeanTex", 1);
+	prog_reference_accumulate.setUniform("M2Tex", 2);
+	prog_reference_accumulate.setUniform("TileTex", 3);
+	prog_reference_accumulate.setUniform("SampleIndex", n);
+	prog_reference_accumulate.setUniform("Adaptive", reference_tiles_valid);
+	prog_reference_accumulate.setUniform("TileSize", ReferenceTileSize);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, tex_sample);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, tex_reference_mean[previous]);
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, tex_reference_m2[previous]);
+	glActiveTexture(GL_TEXTURE3);
+	glBindTexture(GL_TEXTURE_2D, tex_reference_tiles);
+
+	glBindVertexArray(quad_vao);
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Count the unconverged pixels of every tile after sample_count samples,
+// bound the unconverged tiles by reference_scissor. True when the
+// converged fraction reaches reference_converged_target.
+bool SceneObj::updateReferenceConvergence(int sample_count) {
+	int tiles_x = (width + ReferenceTileSize - 1) / ReferenceTileSize;
+	int tiles_y = (height + ReferenceTileSize - 1) / ReferenceTileSize;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo_reference_tiles);
+	glViewport(0, 0, tiles_x, tiles_y);
+	glDisable(GL_DEPTH_TEST);
+
+	prog_reference_convergence.use();
+	prog_reference_convergence.setUniform("MeanTex", 0);
+	prog_reference_convergence.setUniform("M2Tex", 1);
+	prog_reference_convergence.setUniform("SampleCount", sample_count);
+	prog_reference_convergence.setUniform("TileSize", ReferenceTileSize);
+	prog_reference_convergence.setUniform("Threshold", reference_error_threshold);
+	prog_reference_convergence.setUniform("MinLuminance", 1e-3f);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, tex_reference_mean[reference_index]);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, tex_reference_m2[reference_index]);
+	glActiveTexture(GL_TEXTURE0);
+
+	glBindVertexArray(quad_vao);
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+	glReadPixels(0, 0, tiles_x, tiles_y, GL_RED, GL_FLOAT, reference_tile_counts.data());
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, width, height);
+
+	double unconverged = 0.;
+	glm::ivec2 tile_min(tiles_x, tiles_y), tile_max(-1);
+	for (int y = 0; y < tiles_y; y++)
+		for (int x = 0; x < tiles_x; x++) {
+			float count = reference_tile_counts[size_t(y) * tiles_x + x];
+			if (count > 0.f) {
+				unconverged += count;
+				tile_min = glm::min(tile_min, glm::ivec2(x, y));
+				tile_max = glm::max(tile_max, glm::ivec2(x, y));
+			}
+		}
+
+	reference_converged_fraction = 1.f - float(unconverged / (double(width) * double(height)));
+	reference_tiles_valid = true;
+	if (tile_max.x >= 0) {
+		glm::ivec2 origin = tile_min * ReferenceTileSize;
+		glm::ivec2 end = glm::min((tile_max + 1) * ReferenceTileSize, glm::ivec2(width, height));
+		reference_scissor = glm::ivec4(origin, end - origin);
+	}
+	else
+		reference_scissor = glm::ivec4(0);
+	return reference_converged_fraction >= reference_converged_target;
+}
+
+// The statistics of the last sample, the sampler, the adaptive state and
+// the camera
+void SceneObj::saveReferenceCheckpoint(int sample_count) {
+	glint::ReferenceCheckpoint checkpoint;
+	checkpoint.width = width;
+	checkpoint.height = height;
+	checkpoint.cameraPosition = camera.Position;
+	checkpoint.cameraYaw = camera.Yaw;
+	checkpoint.cameraPitch = camera.Pitch;
+	checkpoint.samplesPerPixel = super_sampling_count;
+	checkpoint.sequence = int(reference_sampler.Sequence());
+	checkpoint.shaderSamples = reference_shader_samples;
+	checkpoint.sampleCount = sample_count;
+	checkpoint.adaptive = reference_adaptive;
+	checkpoint.samplesPerRound = reference_samples_per_frame;
+	checkpoint.errorThreshold = reference_error_threshold;
+	checkpoint.convergedTarget = reference_converged_target;
+	checkpoint.minSamples = reference_min_samples;
+	checkpoint.tilesValid = reference_tiles_valid;
+	checkpoint.scissor = reference_scissor;
+	checkpoint.convergedFraction = reference_converged_fraction;
+	checkpoint.tileCounts = reference_tile_counts;
+
+	checkpoint.mean.resize(size_t(width) * height * 4);
+	checkpoint.m2.resize(size_t(width) * height * 4);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo_reference[reference_index]);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_FLOAT, checkpoint.mean.data());
+	glReadBuffer(GL_COLOR_ATTACHMENT1);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_FLOAT, checkpoint.m2.data());
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+
+	glint::writeReferenceCheckpoint(reference_checkpoint_path, checkpoint);
+}
+
+// Back to the state of saveReferenceCheckpoint. The frame buffer must have
+// the size of the checkpoint.
+bool SceneObj::loadReferenceCheckpoint() {
+	glint::ReferenceCheckpoint checkpoint;
+	if (!glint::readReferenceCheckpoint(reference_checkpoint_path, checkpoint))
+		return false;
+	if (checkpoint.width != width || checkpoint.height != height
+		|| checkpoint.tileCounts.size() != reference_tile_counts.size()) {
+		std::cerr << "Reference checkpoint of " << checkpoint.width << " x " << checkpoint.height
+			<< " pixels, the frame is " << width << " x " << height << std::endl;
+		return false;
+	}
+
+	camera = Camera(checkpoint.cameraPosition, glm::vec3(0., 1., 0.), checkpoint.cameraYaw, checkpoint.cameraPitch);
+	reference_view = camera.GetViewMatrix();
+	reference_reset = false;
+
+	super_sampling_count = checkpoint.samplesPerPixel;
+	reference_sequence = checkpoint.sequence;
+	reference_shader_samples = checkpoint.shaderSamples;
+	int subsamples = reference_shader_samples * reference_shader_samples;
+	reference_sampler.configure(glint::SampleSequence(reference_sequence), (super_sampling_count + subsamples - 1) / subsamples);
+	reference_sample_count = checkpoint.sampleCount;
+
+	reference_adaptive = checkpoint.adaptive;
+	reference_samples_per_frame = checkpoint.samplesPerRound;
+	reference_error_threshold = checkpoint.errorThreshold;
+	reference_converged_target = checkpoint.convergedTarget;
+	reference_min_samples = checkpoint.minSamples;
+	reference_tiles_valid = checkpoint.tilesValid;
+	reference_scissor = checkpoint.scissor;
+	reference_converged_fraction = checkpoint.convergedFraction;
+	reference_tile_counts = checkpoint.tileCounts;
+
+	int tiles_x = (width + ReferenceTileSize - 1) / ReferenceTileSize;
+	int tiles_y = (height + ReferenceTileSize - 1) / ReferenceTileSize;
+	glBindTexture(GL_TEXTURE_2D, tex_reference_tiles);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, tiles_x, tiles_y, GL_RED, GL_FLOAT, reference_tile_counts.data());
+	glBindTexture(GL_TEXTURE_2D, tex_reference_mean[reference_index]);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_FLOAT, checkpoint.mean.data());
+	glBindTexture(GL_TEXTURE_2D, tex_reference_m2[reference_index]);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_FLOAT, checkpoint.m2.data());
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	std::cout << "Reference resumed at " << reference_sample_count << " / " << reference_sampler.Count()
+		<< " samples: " << reference_checkpoint_path << std::endl;
+	return true;
+}
+
 void SceneObj::setupPostProcessing(){
 	glGenRenderbuffers(1, &rb_post_processing);
 	glBindRenderbuffer(GL_RENDERBUFFER, rb_post_processing);
@@ -603,6 +1492,434 @@ void SceneObj::setupPostProcessing(){
 
 
 
+void SceneObj::bindGlintTextures() {
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_1D_ARRAY, dicoTex);
+
+	glActiveTexture(GL_TEXTURE6);
+	glBindTexture(GL_TEXTURE_CUBE_MAP, envmap_tex);
+
+	glActiveTexture(GL_TEXTURE7);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, occupancy_tex);
+
+	glActiveTexture(GL_TEXTURE9);
+	glBindTexture(GL_TEXTURE_2D, blue_noise_tex);
+
+	glActiveTexture(GL_TEXTURE10);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, paired_dico_tex);
+
+	glActiveTexture(GL_TEXTURE11);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, cache_page_table_tex);
+
+	glActiveTexture(GL_TEXTURE12);
+	glBindTexture(GL_TEXTURE_2D, cache_atlas_tex);
+}
+
+void SceneObj::setupGlintCache() {
+
+	// Physical pages, alpha is the coverage of the texels by the mesh
+	int atlasSize = CacheAtlasPages * glint::kCachePageSize;
+	glGenTextures(1, &cache_atlas_tex);
+	glBindTexture(GL_TEXTURE_2D, cache_atlas_tex);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, atlasSize, atlasSize);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+	glGenFramebuffers(1, &fbo_cache_atlas);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo_cache_atlas);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, cache_atlas_tex, 0);
+
+	cache_page_table_tex = Texture::createCachePageTable(m_model.getMeshCount());
+
+	// Requested pages, written by the glint shader next to the color
+	glGenTextures(1, &tex_cache_feedback);
+	glBindTexture(GL_TEXTURE_2D, tex_cache_feedback);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, width, height);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo_sample);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, tex_cache_feedback, 0);
+
+	// Subsampled copy, read back asynchronously
+	int feedbackWidth = std::max(1, width / CacheFeedbackScale - 1);
+	int feedbackHeight = std::max(1, height / CacheFeedbackScale - 1);
+	glGenTextures(1, &tex_cache_feedback_small);
+	glBindTexture(GL_TEXTURE_2D, tex_cache_feedback_small);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, feedbackWidth, feedbackHeight);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glGenFramebuffers(1, &fbo_cache_feedback);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo_cache_feedback);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex_cache_feedback_small, 0);
+
+	glGenBuffers(2, pbo_cache_feedback);
+	for (int i = 0; i < 2; i++) {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_cache_feedback[i]);
+		glBufferData(GL_PIXEL_PACK_BUFFER, feedbackWidth * feedbackHeight * sizeof(GLuint), NULL, GL_STREAM_READ);
+		cache_feedback_pending[i] = false;
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Copy one pixel of every CacheFeedbackScale^2 block of the feedback and
+// start its read back. The pixel of the block changes every frame (one
+// block is dropped so that the shifted blocks stay in the frame).
+void SceneObj::writeGlintCacheFeedback() {
+	int feedbackWidth = std::max(1, width / CacheFeedbackScale - 1);
+	int feedbackHeight = std::max(1, height / CacheFeedbackScale - 1);
+	int offsetX = (cache_feedback_frame * 3) % CacheFeedbackScale;
+	int offsetY = (cache_feedback_frame * 5) % CacheFeedbackScale;
+	cache_feedback_frame++;
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo_sample);
+	glReadBuffer(GL_COLOR_ATTACHMENT1);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fbo_cache_feedback);
+	glBlitFramebuffer(offsetX, offsetY,
+		offsetX + feedbackWidth * CacheFeedbackScale, offsetY + feedbackHeight * CacheFeedbackScale,
+		0, 0, feedbackWidth, feedbackHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo_cache_feedback);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_cache_feedback[cache_feedback_index]);
+	glReadPixels(0, 0, feedbackWidth, feedbackHeight, GL_RED_INTEGER, GL_UNSIGNED_INT, 0);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	cache_feedback_pending[cache_feedback_index] = true;
+	cache_feedback_index = 1 - cache_feedback_index;
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo_sample);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// The feedback of two frames ago is read: its transfer is done.
+void SceneObj::readGlintCacheFeedback() {
+	if (!cache_feedback_pending[cache_feedback_index])
+		return;
+
+	int feedbackWidth = std::max(1, width / CacheFeedbackScale - 1);
+	int feedbackHeight = std::max(1, height / CacheFeedbackScale - 1);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo_cache_feedback[cache_feedback_index]);
+	const GLuint* feedback = (const GLuint*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0,
+		feedbackWidth * feedbackHeight * sizeof(GLuint), GL_MAP_READ_BIT);
+	if (feedback) {
+		glint_cache.request(feedback, size_t(feedbackWidth) * feedbackHeight);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+	}
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	cache_feedback_pending[cache_feedback_index] = false;
+}
+
+// Texture-space shading of the pages of the cache: each page is the mesh
+// rasterized in its UV space, at the resolution of the page level.
+void SceneObj::shadeGlintCache(const glm::mat4& model) {
+	readGlintCacheFeedback();
+
+	// Everything the cached radiance depends on. The radiance only depends
+	// on the position of the camera, not on its orientation.
+	std::vector<float> state = {
+		camera.Position.x, camera.Position.y, camera.Position.z,
+		light_pos.x, light_pos.y, light_pos.z, point_light_intensity,
+		dir_light_dir.x, dir_light_dir.y, dir_light_intensity,
+		float(override_materials_params), sigmas_rho.x, sigmas_rho.y, sigmas_rho.z,
+		log_microfacet_density, microfacet_relative_area, max_anisotropy,
+		float(filter), kernel_size, float(use_hemis_derivatives),
+		float(lean_mode), float(use_bump), float(paired_dictionary), float(use_float16)
+	};
+	glint_cache.setShadingState(state, glint_cache_tolerance);
+
+	std::vector<glint::CacheUpdate> pages = glint_cache.pagesToShade(glint_cache_pages_per_frame);
+	std::vector<glint::PageTableEntry> entries = glint_cache.takePageTableUpdates();
+	Texture::updateCachePageTable(cache_page_table_tex, entries.data(), entries.size());
+	glint_cache_shaded_pages = int(pages.size());
+	if (pages.empty())
+		return;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo_cache_atlas);
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_SCISSOR_TEST);
+	glClearColor(0., 0., 0., 0.);
+
+	prog_glints.use();
+	prog_glints.setUniform("CacheMode", 2);
+	prog_glints.setUniform("GlintEvaluation", 0);
+	prog_glints.setUniform("ModelMatrix", model);
+	prog_glints.setUniform("MaxAnisotropy", max_anisotropy);
+	prog_glints.setUniform("GlintCellBudget", glint::kMaxGlintCells);
+	bindGlintTextures();
+
+	const float pageSize = float(glint::kCachePageSize);
+	for (const glint::CacheUpdate& update : pages) {
+		int x = (update.slot % CacheAtlasPages) * glint::kCachePageSize;
+		int y = (update.slot / CacheAtlasPages) * glint::kCachePageSize;
+		glViewport(x, y, glint::kCachePageSize, glint::kCachePageSize);
+		glScissor(x, y, glint::kCachePageSize, glint::kCachePageSize);
+		glClear(GL_COLOR_BUFFER_BIT);
+
+		// Scaled UV -> texels of the level -> clip space of the page
+		glm::vec4 bounds = m_model.getUVBoundsMeshX(update.page.mesh);
+		float texels = float((glint::kCacheVirtualPages * glint::kCachePageSize) >> update.page.level);
+		glm::vec2 s = glm::vec2(texels) / glm::vec2(bounds.z, bounds.w) * (2.f / pageSize);
+		glm::vec2 o = -glm::vec2(bounds.x, bounds.y) * s
+			- glm::vec2(float(update.page.x), float(update.page.y)) * 2.f - 1.f;
+		prog_glints.setUniform("CachePageTransform", glm::vec4(s, o));
+
+		m_model.DrawMeshX(prog_glints, update.page.mesh);
+	}
+
+	glDisable(GL_SCISSOR_TEST);
+	glViewport(0, 0, width, height);
+	glEnable(GL_DEPTH_TEST);
+	prog_glints.setUniform("CacheMode", 1);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void SceneObj::setupGlintGBuffer() {
+
+	// G-buffer, next to the color of the glint shader
+	glGenTextures(6, tex_glint_gbuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo_sample);
+	for (int i = 0; i < 6; i++) {
+		glBindTexture(GL_TEXTURE_2D, tex_glint_gbuffer[i]);
+		glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA32UI, width, height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2 + i, GL_TEXTURE_2D, tex_glint_gbuffer[i], 0);
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	// The deferred pass samples the G-buffer: it can't be attached to the
+	// framebuffer it draws in
+	glGenFramebuffers(1, &fbo_deferred);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo_deferred);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex_sample, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// (Re)allocate the reduced resolution glints for glint_resolution_scale
+void SceneObj::setupGlintLowRes() {
+	if (glint_low_res_scale == glint_resolution_scale)
+		return;
+	glint_low_res_scale = glint_resolution_scale;
+	glDeleteTextures(1, &tex_glint_low_res);
+	glDeleteFramebuffers(1, &fbo_glint_low_res);
+
+	int s = glint_low_res_scale;
+	glGenTextures(1, &tex_glint_low_res);
+	glBindTexture(GL_TEXTURE_2D, tex_glint_low_res);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA16F, (width + s - 1) / s, (height + s - 1) / s);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	glGenFramebuffers(1, &fbo_glint_low_res);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo_glint_low_res);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex_glint_low_res, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Shade the pixels of the G-buffer, the background (sky) is kept.
+// With a glint resolution scale, the glints of the lights are shaded
+// separately at reduced resolution and upsampled.
+void SceneObj::shadeDeferred(int frameIndex) {
+	// The cell count view needs every pixel
+	int scale = cell_count_view == 0 ? glint_resolution_scale : 1;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo_deferred);
+	glDisable(GL_DEPTH_TEST);
+
+	prog_glints_deferred.use();
+	prog_glints_deferred.setUniform("FrameIndex", frameIndex);
+	prog_glints_deferred.setUniform("CacheMode", 0);
+	if (adaptive_cell_budget) {
+		glint::CellBudget budget = cell_budget_controller.Budget();
+		prog_glints_deferred.setUniform("MaxAnisotropy", budget.maxAnisotropy);
+		prog_glints_deferred.setUniform("GlintCellBudget", budget.maxCells);
+	}
+	else {
+		prog_glints_deferred.setUniform("MaxAnisotropy", max_anisotropy);
+		prog_glints_deferred.setUniform("GlintCellBudget", glint::kMaxGlintCells);
+	}
+
+	bindGlintTextures();
+	for (int i = 0; i < 6; i++) {
+		glActiveTexture(GL_TEXTURE13 + i);
+		glBindTexture(GL_TEXTURE_2D, tex_glint_gbuffer[i]);
+	}
+
+	glBindVertexArray(quad_vao);
+	prog_glints_deferred.setUniform("DeferredTerms", scale > 1 ? 1 : 0);
+	prog_glints_deferred.setUniform("GlintScale", scale);
+	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+	if (scale > 1) {
+		setupGlintLowRes();
+		int lw = (width + scale - 1) / scale;
+		int lh = (height + scale - 1) / scale;
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo_glint_low_res);
+		glViewport(0, 0, lw, lh);
+		glClearColor(0., 0., 0., 0.);
+		glClear(GL_COLOR_BUFFER_BIT);
+		prog_glints_deferred.setUniform("DeferredTerms", 2);
+		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+		glViewport(0, 0, width, height);
+
+		// Added to the other terms
+		glBindFramebuffer(GL_FRAMEBUFFER, fbo_deferred);
+		prog_glint_upsample.use();
+		prog_glint_upsample.setUniform("GlintScale", scale);
+		prog_glint_upsample.setUniform("CameraPosition", camera.Position);
+		prog_glint_upsample.setUniform("GlintTex", 0);
+		for (int i = 0; i < 4; i++)
+			prog_glint_upsample.setUniform(("GlintGBufferTex[" + std::to_string(i) + "]").c_str(), 13 + i);
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, tex_glint_low_res);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE);
+		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+		glDisable(GL_BLEND);
+	}
+
+	glEnable(GL_DEPTH_TEST);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo_sample);
+}
+
+void SceneObj::setupGlintCompute() {
+
+	// One chunk of cells per pixel on average, the pixels that don't fit
+	// are evaluated by the resolve pass
+	glint_work_capacity = GLuint(width) * GLuint(height);
+
+	glGenBuffers(5, glint_work_buffers);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, glint_work_buffers[0]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, 4 * sizeof(GLuint), NULL, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, glint_work_buffers[1]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, glint_work_capacity * 2 * sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, glint_work_buffers[2]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, glint_work_capacity * 4 * sizeof(float), NULL, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, glint_work_buffers[3]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, GLuint(width) * GLuint(height) * 2 * sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+
+	// Material 0: user values, material m + 1: mesh m (GlintMaterialBuffer)
+	std::vector<glint::GlintLodBlock> materials(1, user_glint_lod);
+	for (int m = 0; m < m_model.getMeshCount(); m++)
+		materials.push_back(m_model.getGlintLodMeshX(m));
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, glint_work_buffers[4]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, materials.size() * sizeof(glint::GlintLodBlock), materials.data(), GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+// Classify, evaluate and resolve (see glint_tiled.comp.glsl). The glints of
+// the lights are added to tex_sample.
+void SceneObj::dispatchGlintCompute(int frameIndex) {
+
+	// Empty work list, indirect dispatch of no group
+	GLuint counters[] = { 0u, 0u, 1u, 1u };
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, glint_work_buffers[0]);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(counters), counters);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+	for (int i = 0; i < 5; i++)
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, i, glint_work_buffers[i]);
+
+	prog_glints_compute.use();
+	prog_glints_compute.setUniform("WorkItemCapacity", glint_work_capacity);
+	prog_glints_compute.setUniform("FrameIndex", frameIndex);
+	prog_glints_compute.setUniform("UseCellTables", use_cell_tables);
+	prog_glints_compute.setUniform("StochasticLOD", stochastic_lod);
+	prog_glints_compute.setUniform("PairedDictionary", paired_dictionary);
+	prog_glints_compute.setUniform("Filter", filter);
+	prog_glints_compute.setUniform("KernelSize", kernel_size);
+	prog_glints_compute.setUniform("PointLight.L", glm::vec3(point_light_intensity));
+	prog_glints_compute.setUniform("DirLight.L", glm::vec3(dir_light_intensity));
+	if (adaptive_cell_budget) {
+		glint::CellBudget budget = cell_budget_controller.Budget();
+		prog_glints_compute.setUniform("MaxAnisotropy", budget.maxAnisotropy);
+		prog_glints_compute.setUniform("GlintCellBudget", budget.maxCells);
+	}
+	else {
+		prog_glints_compute.setUniform("MaxAnisotropy", max_anisotropy);
+		prog_glints_compute.setUniform("GlintCellBudget", glint::kMaxGlintCells);
+	}
+
+	bindGlintTextures();
+	prog_glints_compute.setUniform("DictionaryTex", 0);
+	prog_glints_compute.setUniform("OccupancyTex", 7);
+	prog_glints_compute.setUniform("BlueNoiseTex", 9);
+	prog_glints_compute.setUniform("PairedDictionaryTex", 10);
+	for (int i = 0; i < 6; i++) {
+		glActiveTexture(GL_TEXTURE13 + i);
+		glBindTexture(GL_TEXTURE_2D, tex_glint_gbuffer[i]);
+		prog_glints_compute.setUniform(("GlintGBufferTex[" + std::to_string(i) + "]").c_str(), 13 + i);
+	}
+	glBindImageTexture(0, tex_sample, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA16F);
+	prog_glints_compute.setUniform("GlintColor", 0);
+
+	GLuint groupsX = (width + GlintTileSize - 1) / GlintTileSize;
+	GLuint groupsY = (height + GlintTileSize - 1) / GlintTileSize;
+
+	prog_glints_compute.setUniform("GlintPass", 0);
+	glDispatchCompute(groupsX, groupsY, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+	prog_glints_compute.setUniform("GlintPass", 1);
+	glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, glint_work_buffers[0]);
+	glDispatchComputeIndirect(sizeof(GLuint)); // EvaluateGroupsX
+	glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	prog_glints_compute.setUniform("GlintPass", 2);
+	glDispatchCompute(groupsX, groupsY, 1);
+
+	// tex_sample is then drawn by prog_quad_fullscreen
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+}
+
+void SceneObj::setupClusteredLights() {
+	cluster_grid = glint::makeClusterGrid(0.1f, 200.f);
+
+	glGenBuffers(2, cluster_buffers);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, cluster_buffers[1]);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, GLsizeiptr(cluster_grid.ClusterCount()) * cluster_grid.ListStride() * sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+// Scatter the lights when their parameters change, then list the lights of
+// each froxel for the view of the frame
+void SceneObj::buildLightClusters() {
+	if (cluster_lights_dirty) {
+		glm::vec3 spread(cluster_light_spread);
+		glm::vec3 center(light_pos);
+		std::vector<glint::ClusterLight> lights = glint::scatterLights(cluster_light_count,
+			center - spread, center + spread, cluster_light_intensity, cluster_light_cutoff);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, cluster_buffers[0]);
+		// Never empty, bound even without light
+		glBufferData(GL_SHADER_STORAGE_BUFFER, std::max<size_t>(1, lights.size()) * sizeof(glint::ClusterLight), lights.empty() ? NULL : lights.data(), GL_STATIC_DRAW);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+		cluster_lights_dirty = false;
+	}
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, cluster_buffers[0]);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, cluster_buffers[1]);
+
+	prog_light_clusters.use();
+	prog_light_clusters.setUniform("View", view);
+	prog_light_clusters.setUniform("InvProjection", glm::inverse(projection));
+	prog_light_clusters.setUniform("ClusterTiles", glm::ivec2(cluster_grid.tilesX, cluster_grid.tilesY));
+	prog_light_clusters.setUniform("ClusterSlices", cluster_grid.slices);
+	prog_light_clusters.setUniform("MaxLightsPerCluster", cluster_grid.maxLightsPerCluster);
+	prog_light_clusters.setUniform("ClusterNear", cluster_grid.zNear);
+	prog_light_clusters.setUniform("ClusterFar", cluster_grid.zFar);
+	prog_light_clusters.setUniform("LightCount", cluster_light_count);
+	glDispatchCompute((cluster_grid.ClusterCount() + 63) / 64, 1, 1);
+
+	// Read by the glint shaders
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
 void SceneObj::setupQuad() {
 
 	glGenVertexArrays(1, &quad_vao);
@@ -612,5 +1929,26 @@ void SceneObj::setupQuad() {
 
 SceneObj::~SceneObj() {
 	glDeleteTextures(1, &envmap_tex);
+	glDeleteTextures(1, &occupancy_tex);
+	glDeleteTextures(1, &blue_noise_tex);
+	glDeleteTextures(1, &paired_dico_tex);
+	glDeleteTextures(1, &cache_page_table_tex);
+	glDeleteTextures(1, &cache_atlas_tex);
+	glDeleteTextures(1, &tex_cache_feedback);
+	glDeleteTextures(1, &tex_cache_feedback_small);
+	glDeleteFramebuffers(1, &fbo_cache_atlas);
+	glDeleteFramebuffers(1, &fbo_cache_feedback);
+	glDeleteBuffers(2, pbo_cache_feedback);
+	glDeleteBuffers(1, &user_glint_ubo);
+	glDeleteTextures(6, tex_glint_gbuffer);
+	glDeleteTextures(2, tex_taa);
+	glDeleteFramebuffers(2, fbo_taa);
+	glDeleteFramebuffers(1, &fbo_deferred);
+	glDeleteTextures(1, &tex_glint_low_res);
+	glDeleteFramebuffers(1, &fbo_glint_low_res);
+	if (computeShaders) {
+		glDeleteBuffers(5, glint_work_buffers);
+		glDeleteBuffers(2, cluster_buffers);
+	}
 }
 
@@ -17,8 +17,15 @@
 #include "camera.h"
 #include "texture.h"
 #include "box.h"
+#include "gputimer.h"
+#include "cellbudget.h"
+#include "radiancecache.h"
+#include "lightclusters.h"
+#include "sampler.h"
+#include "referencecheckpoint.h"
 
 #include <utility>
+#include <vector>
 
 #include <glm/glm.hpp>
 
@@ -26,9 +33,128 @@ class SceneObj : public Scene {
 private:
     void drawScene();
     void compileAndLinkShader();
+    void compileGlintShader();
+    void recompileGlintShaders();
+    void setGlintConstantUniforms();
+    void setGlintUniforms(GLSLProgram& prog);
+    void bindGlintTextures();
 
     // Dictionary of marginal distributions
     GLuint dicoTex;
+    // Paired layout: both marginals of a cell in one fetch
+    GLuint paired_dico_tex;
+    bool   paired_dictionary;
+    int    dictionary_levels;
+    int    dictionary_dists_per_channel;
+    float  dictionary_max_value;
+
+    // Half-precision glint shader (needs Scene::shaderFloat16)
+    bool   use_float16;
+
+    // Precomputed cell tables (occupancy bitmask per relative area).
+    // Area 0 is the user microfacet relative area.
+    GLuint              occupancy_tex;
+    std::vector<float>  occupancy_areas;
+    int                 cell_table_levels;
+    bool                use_cell_tables;
+
+    // Stochastic LOD: one footprint level per pixel, blue noise dithered
+    GLuint  blue_noise_tex;
+    bool    stochastic_lod;
+    int     frame_index;
+
+    // Frame-time driven cell budget and anisotropy clamp of the glint shader
+    GpuTimer                    gpu_timer;
+    float                       gpu_frame_ms;
+    bool                        adaptive_cell_budget;
+    float                       target_frame_ms;
+    glint::CellBudgetController cell_budget_controller;
+
+    // Per-light culling of the glint evaluation, relative to max_intensity
+    float   glint_cull_threshold;
+
+    // Texture-space glint radiance cache (see glint/radiancecache.h)
+    static const int CacheAtlasPages = 32;      // Atlas of 32 x 32 pages
+    static const int CacheFeedbackScale = 8;    // Feedback read back at 1/8
+    void    setupGlintCache();
+    void    shadeGlintCache(const glm::mat4& model);
+    void    readGlintCacheFeedback();
+    void    writeGlintCacheFeedback();
+    glint::RadianceCache glint_cache;
+    bool    use_glint_cache;
+    float   glint_cache_tolerance;
+    int     glint_cache_pages_per_frame;
+    int     glint_cache_shaded_pages;
+    GLuint  cache_page_table_tex;
+    GLuint  cache_atlas_tex;            // RGBA16F, alpha: coverage
+    GLuint  fbo_cache_atlas;
+    GLuint  tex_cache_feedback;         // R32UI, attachment 1 of fbo_sample
+    GLuint  tex_cache_feedback_small;
+    GLuint  fbo_cache_feedback;
+    GLuint  pbo_cache_feedback[2];
+    bool    cache_feedback_pending[2];
+    int     cache_feedback_index;
+    int     cache_feedback_frame;
+
+    // 0: forward shading, 1: deferred shading, 2: forward shading and
+    // tiled compute pass of the glints of the lights
+    int     shading_path;
+
+    // G-buffer written by prog_glints: inputs of the glints of the lights
+    // (tiled compute pass) or surface of the pixels (deferred shading)
+    void    setupGlintGBuffer();
+    GLuint  tex_glint_gbuffer[6];       // RGBA32UI, attachments 2 to 7 of fbo_sample
+
+    // Deferred shading: prog_glints_deferred shades each pixel of the
+    // G-buffer once, on a fullscreen quad
+    void    shadeDeferred(int frameIndex);
+    GLSLProgram prog_glints_deferred;
+    GLuint  fbo_deferred;               // tex_sample only
+
+    // Glints of the lights of the deferred pass shaded at one pixel every
+    // glint_resolution_scale x glint_resolution_scale pixels, then added to
+    // tex_sample by a joint bilateral upsampling (glint_upsample.frag.glsl)
+    void    setupGlintLowRes();
+    int     glint_resolution_scale;     // 1, 2 or 4
+    int     glint_low_res_scale;        // Scale of tex_glint_low_res
+    GLuint  tex_glint_low_res;          // RGBA16F
+    GLuint  fbo_glint_low_res;
+    GLSLProgram prog_glint_upsample;
+
+    // Tiled compute pass of the glints of the lights, from the glint
+    // G-buffer (see glint_tiled.comp.glsl). Needs Scene::computeShaders.
+    static const int GlintTileSize = 8;
+    void    setupGlintCompute();
+    void    compileGlintComputeShader();
+    void    dispatchGlintCompute(int frameIndex);
+    GLSLProgram prog_glints_compute;
+    // Counters and indirect dispatch, work items, partial sums, work of the
+    // pixels, glint constants of the materials (shader storage bindings 0-4)
+    GLuint  glint_work_buffers[5];
+    GLuint  glint_work_capacity;
+
+    // Clustered forward lighting of many point lights, scattered around the
+    // point light (see glint/lightclusters.h). light_clusters.comp.glsl
+    // lists the lights of the froxels once per frame, the glint shader is
+    // compiled with GLINT_CLUSTERED_LIGHTS. Needs Scene::computeShaders.
+    void    setupClusteredLights();
+    void    buildLightClusters();
+    bool    use_clustered_lights;
+    bool    cluster_lights_dirty;       // Scatter and upload the lights again
+    int     cluster_light_count;
+    float   cluster_light_intensity;
+    float   cluster_light_spread;       // Half extent of the box of the lights
+    float   cluster_light_cutoff;       // Irradiance at the radius of influence
+    glint::ClusterGrid cluster_grid;
+    // Lights, light lists of the froxels (shader storage bindings 5 and 6)
+    GLuint  cluster_buffers[2];
+    GLSLProgram prog_light_clusters;
+
+    // Depth prepass, then the glint shader without discard (GL_EQUAL).
+    // The masked variant only draws the meshes with a mask texture.
+    bool    depth_prepass;
+    GLSLProgram prog_depth;
+    GLSLProgram prog_depth_masked;
 
     // Shaders
     GLSLProgram prog_glints;
@@ -47,6 +173,14 @@ private:
     float       point_light_intensity;
     glm::vec2   dir_light_dir;
     float       dir_light_intensity;
+    // Rectangle or disk area light, facing area_light_dir (spherical
+    // coordinates as dir_light_dir). Its glints are a centroid/covariance
+    // approximation (see glint/arealight.h)
+    int         area_light_shape;       // 0 none, 1 rectangle, 2 disk
+    glm::vec3   area_light_pos;
+    glm::vec2   area_light_size;        // Half extents
+    glm::vec2   area_light_dir;
+    float       area_light_radiance;
 
     // Scene
     Camera      camera;
@@ -59,6 +193,9 @@ private:
     float       log_microfacet_density;
     float       microfacet_relative_area;
     float       max_anisotropy;
+    // Glint constants of the user values (UserGlintBlock)
+    glint::GlintLodBlock    user_glint_lod;
+    GLuint                  user_glint_ubo;
     
     // GGAA
     bool    filter;
@@ -75,13 +212,51 @@ private:
     // Record
     bool        format;
     bool        super_sampling;
-    int         super_sampling_count;
+    int         super_sampling_count;   // Samples per pixel of the references
+    // Progressive reference: with super_sampling, each displayed frame adds
+    // reference_samples_per_frame samples of reference_sampler to
+    // tex_super_sampling (running mean), until super_sampling_count samples
+    // per pixel. A change of the view or of a parameter restarts it, a
+    // saved frame only renders the missing samples.
+    // Each sample of the sampler is itself shaded at
+    // reference_shader_samples^2 subpixel positions by the fragment shader:
+    // the sampler has super_sampling_count / reference_shader_samples^2
+    // samples.
+    int                 reference_sequence;     // glint::SampleSequence
+    glint::PixelSampler reference_sampler;
+    int         reference_samples_per_frame;
+    int         reference_shader_samples;
+    int         reference_sample_count;
+    bool        reference_reset;
+    glm::mat4   reference_view;
+    // Adaptive reference: every round of reference_samples_per_frame samples
+    // after reference_min_samples, the pixels whose relative standard error
+    // is above reference_error_threshold are counted per tile. The reference
+    // stops when reference_converged_target of the pixels have converged,
+    // otherwise only the unconverged tiles are shaded, within the scissor
+    // rectangle reference_scissor that bounds them.
+    bool        reference_adaptive;
+    float       reference_error_threshold;
+    float       reference_converged_target;
+    int         reference_min_samples;
+    bool        reference_tiles_valid;
+    glm::ivec4  reference_scissor;          // x, y, width, height
+    float       reference_converged_fraction;
+    // Checkpoints: with reference_checkpoint, the state of the reference is
+    // written to reference_checkpoint_path every
+    // reference_checkpoint_interval samples and when it is complete.
+    // reference_resume loads it back before the next samples.
+    bool        reference_checkpoint;
+    int         reference_checkpoint_interval;
+    std::string reference_checkpoint_path;
+    bool        reference_resume;
     bool        show_imgui;
 
     // Options
     bool    only_specular;
     bool    use_bump;
     int     lean_mode;
+    int     cell_count_view;
 
 
 	float   tPrev;
@@ -92,10 +267,51 @@ private:
     GLuint  rb_super_sampling_depth_buffer; // depth buffer
     GLuint  fbo_super_sampling;
 
+    // Offset in NDC of sample i of an AA x AA grid of the pixel
+    glm::vec2 sampleOffset(int i, int AA) const;
+    // Offset in NDC of the position u in [0, 1)^2 of the pixel
+    glm::vec2 pixelOffset(glm::vec2 u) const;
+
+    // Statistics of the reference samples: Welford running mean and sum of
+    // squared deviations (reference_accumulate.frag.glsl) in ping-pong
+    // textures, and unconverged pixels per ReferenceTileSize tile
+    // (reference_convergence.frag.glsl)
+    static const int ReferenceTileSize = 32;
+    void    setupReferenceStatistics();
+    void    accumulateReference(int n);
+    bool    updateReferenceConvergence(int n);
+    void    saveReferenceCheckpoint(int sample_count);
+    bool    loadReferenceCheckpoint();
+    GLuint  tex_reference_mean[2];      // RGBA32F, mean luminance in alpha
+    GLuint  tex_reference_m2[2];        // RGBA32F, M2 of the luminance in alpha
+    GLuint  fbo_reference[2];
+    int     reference_index;            // Statistics of the last sample
+    GLuint  tex_reference_tiles;        // R32F, one texel per tile
+    GLuint  fbo_reference_tiles;
+    std::vector<float> reference_tile_counts;
+    GLSLProgram prog_reference_accumulate;
+    GLSLProgram prog_reference_convergence;
+
     // Single sample
     GLuint  fbo_sample;
     GLuint  tex_sample; // color buffer for a unique sample
-    GLuint  rb_sample_depth_buffer; // depth buffer
+    GLuint  tex_sample_depth; // depth buffer, read by the TAA
+
+    // Temporal anti-aliasing: one jittered sample per frame (TaaGrid x
+    // TaaGrid positions of the supersampling grid), accumulated in the
+    // history by resolveTAA (taa.frag.glsl) before the post-processing
+    static const int TaaGrid = 4;
+    void    setupTAA();
+    void    resolveTAA(const glm::mat4& viewProjection, const glm::mat4& jitteredViewProjection);
+    bool    use_taa;
+    float   taa_feedback;               // Weight of the current frame
+    int     taa_frame;
+    int     taa_index;                  // Output of the current frame
+    bool    taa_history_valid;
+    glm::mat4 taa_prev_view_projection;
+    GLuint  tex_taa[2];                 // History and output, RGBA16F
+    GLuint  fbo_taa[2];
+    GLSLProgram prog_taa;
 
 
     // Post-processing
@@ -0,0 +1,30 @@
+#version 330
+
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Depth prepass of the meshes, with improved_glint_envmap.vert.glsl. The
+// glint shader then runs on the visible fragments only (GL_EQUAL depth test,
+// without discard). DEPTH_MASKED is defined by SceneObj for the meshes with
+// a mask texture: the only variant with a discard.
+
+#ifdef DEPTH_MASKED
+in vec2 TexCoord;
+
+uniform sampler2D MaskTex;
+uniform vec2 ScaleUV = vec2(1.);
+#endif
+
+void main()
+{
+#ifdef DEPTH_MASKED
+    if(texture(MaskTex, TexCoord * ScaleUV).x < 0.1)
+        discard;
+#endif
+}
@@ -0,0 +1,284 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Tiled glint pass. SceneObj compiles improved_glint_envmap.frag.glsl with
+// GLINT_COMPUTE defined, followed by this file: the glinty BRDF is the one
+// of the fragment shader, evaluated for the pixels of the glint G-buffer.
+//
+// The cost of a pixel is the number of cells of its footprint, from zero to
+// GlintCellBudget + 1 per level. Evaluated in the fragment shader, the
+// pixels of a warp wait for the most expensive one. Here the footprints are
+// cut into chunks of at most GLINT_CHUNK_CELLS cells:
+//  - GlintPass 0, classify: one thread per pixel, 8 x 8 pixels per tile.
+//    The cost bucket of a pixel is its number of chunks, from the bounding
+//    boxes of its ellipses. The chunks of the tile are appended to the work
+//    list with one atomic operation per tile, and the indirect dispatch of
+//    the next pass is updated.
+//  - GlintPass 1, evaluate: one thread per work item (pixel, level, chunk),
+//    the weighted sum of the cells of the chunk is written to PartialSums.
+//  - GlintPass 2, resolve: one thread per pixel, sums the partial sums of
+//    its chunks and adds the glints of the lights to GlintColor.
+
+#define GLINT_TILE_SIZE 8
+#define GLINT_CHUNK_CELLS 16
+// The pixel has no work item (work list full): evaluated by the resolve
+#define GLINT_NO_WORK_ITEM 0xffffffffu
+
+#if NB_GLINT_LIGHTS > 3
+#error "PartialSums holds the sums of three lights at most"
+#endif
+
+layout(local_size_x = GLINT_TILE_SIZE, local_size_y = GLINT_TILE_SIZE) in;
+
+uniform int  GlintPass;
+uniform uint WorkItemCapacity;
+
+uniform usampler2D GlintGBufferTex[6];
+// Color of the lights without glints (tex_sample)
+layout(rgba16f) uniform image2D GlintColor;
+
+layout(std430, binding = 0) buffer GlintWorkCounters {
+  uint WorkItemCount;
+  uint EvaluateGroupsX;     // Indirect dispatch of the evaluate pass
+  uint EvaluateGroupsY;
+  uint EvaluateGroupsZ;
+};
+
+// Pixel index, level (0 or 1) << 16 | chunk
+layout(std430, binding = 1) buffer GlintWorkItems {
+  uvec2 WorkItems[];
+};
+
+// Sums of the lights, sum of the weights in w
+layout(std430, binding = 2) buffer GlintPartialSums {
+  vec4 PartialSums[];
+};
+
+// First work item, chunks of level 0 | chunks of level 1 << 16
+layout(std430, binding = 3) buffer GlintPixelWork {
+  uvec2 PixelWork[];
+};
+
+shared uint tileItemCount;
+shared uint tileFirstItem;
+
+//=============================================================================
+//========================= Pixel of the G-buffer =============================
+//=============================================================================
+struct GlintPixel {
+    vec2  texCoord;
+    vec2  dst0, dst1;
+    vec3  sigmas_rho;
+    vec3  wo;
+    vec3  wi[NB_GLINT_LIGHTS];
+    bool  active[NB_GLINT_LIGHTS];
+    vec2  slope_dx[NB_GLINT_LIGHTS];
+    vec2  slope_dy[NB_GLINT_LIGHTS];
+    vec3  ks;
+    float distanceSquared;
+    // Derived values
+    vec3  wh[NB_GLINT_LIGHTS];
+    vec2  slope_h[NB_GLINT_LIGHTS];
+};
+
+// Decode writeGlintGBuffer and select the material of the pixel.
+// Returns false if no light is active after the masking shadowing test.
+bool loadGlintPixel(ivec2 pixel, out GlintPixel p)
+{
+    uvec4 g0 = texelFetch(GlintGBufferTex[0], pixel, 0);
+    uvec4 g1 = texelFetch(GlintGBufferTex[1], pixel, 0);
+    uvec4 g2 = texelFetch(GlintGBufferTex[2], pixel, 0);
+    uvec4 g3 = texelFetch(GlintGBufferTex[3], pixel, 0);
+    uvec4 g4 = texelFetch(GlintGBufferTex[4], pixel, 0);
+    uvec4 g5 = texelFetch(GlintGBufferTex[5], pixel, 0);
+
+    p.texCoord = uintBitsToFloat(g0.xy);
+    p.dst0 = uintBitsToFloat(g0.zw);
+    p.dst1 = uintBitsToFloat(g1.xy);
+    p.sigmas_rho = vec3(unpackHalf2x16(g1.z), unpackHalf2x16(g1.w & 0xffffu).x);
+    glintMaterial = int(g1.w >> 16);
+
+    p.wo = uintBitsToFloat(g2.xyz);
+    p.wi[0] = uintBitsToFloat(g3.xyz);
+    p.wi[1] = uintBitsToFloat(g4.xyz);
+    p.distanceSquared = uintBitsToFloat(g3.w);
+    p.ks = vec3(unpackHalf2x16(g4.w), unpackHalf2x16(g2.w >> 16).x);
+    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+        p.active[k] = ((g2.w >> uint(k)) & 1u) != 0u;
+
+    p.slope_dx[0] = unpackHalf2x16(g5.x);
+    p.slope_dy[0] = unpackHalf2x16(g5.y);
+    p.slope_dx[1] = unpackHalf2x16(g5.z);
+    p.slope_dy[1] = unpackHalf2x16(g5.w);
+
+    glintHalfVectors(p.wo, p.wi, p.wh, p.slope_h);
+    return glintVisible(p.wo, p.wi, p.wh, p.active);
+}
+
+// Chunks of level j of the footprint
+uint glintChunks(GlintPixel p, GlintFootprint fp, int j)
+{
+    if (j >= fp.levelCount || !fp.cells)
+        return 0u;
+    int cells = min(glintBoundingBoxCells(fp.level[j], p.texCoord,
+                                          fp.dst0, fp.dst1),
+                    GlintCellBudget + 1);
+    return uint(cells + GLINT_CHUNK_CELLS - 1) / uint(GLINT_CHUNK_CELLS);
+}
+
+//=============================================================================
+//============================== Classify =====================================
+//=============================================================================
+void classify(ivec2 pixel, ivec2 size)
+{
+    if (gl_LocalInvocationIndex == 0u)
+        tileItemCount = 0u;
+    barrier();
+
+    uint pixelIndex = uint(pixel.y * size.x + pixel.x);
+    uint chunks0 = 0u;
+    uint chunks1 = 0u;
+    GlintPixel p;
+    if (all(lessThan(pixel, size)) && loadGlintPixel(pixel, p))
+    {
+        GlintFootprint fp = glintFootprint(p.dst0, p.dst1, p.sigmas_rho, pixel);
+        chunks0 = glintChunks(p, fp, 0);
+        chunks1 = glintChunks(p, fp, 1);
+    }
+
+    // Compaction: the work items of the tile are contiguous
+    uint offset = atomicAdd(tileItemCount, chunks0 + chunks1);
+    barrier();
+    if (gl_LocalInvocationIndex == 0u)
+    {
+        tileFirstItem = atomicAdd(WorkItemCount, tileItemCount);
+        uint end = min(tileFirstItem + tileItemCount, WorkItemCapacity);
+        atomicMax(EvaluateGroupsX, (end + uint(GLINT_TILE_SIZE * GLINT_TILE_SIZE) - 1u)
+                                   / uint(GLINT_TILE_SIZE * GLINT_TILE_SIZE));
+    }
+    barrier();
+
+    if (!all(lessThan(pixel, size)))
+        return;
+
+    uint first = tileFirstItem + offset;
+    if (first + chunks0 + chunks1 > WorkItemCapacity)
+    {
+        PixelWork[pixelIndex] = uvec2(GLINT_NO_WORK_ITEM, 0u);
+        return;
+    }
+    for (uint c = 0u; c < chunks0; ++c)
+        WorkItems[first + c] = uvec2(pixelIndex, c);
+    for (uint c = 0u; c < chunks1; ++c)
+        WorkItems[first + chunks0 + c] = uvec2(pixelIndex, 1u << 16 | c);
+    PixelWork[pixelIndex] = uvec2(first, chunks0 | chunks1 << 16);
+}
+
+//=============================================================================
+//============================== Evaluate =====================================
+//=============================================================================
+void evaluate(ivec2 size)
+{
+    uint item = gl_WorkGroupID.x * uint(GLINT_TILE_SIZE * GLINT_TILE_SIZE)
+                + gl_LocalInvocationIndex;
+    if (item >= min(WorkItemCount, WorkItemCapacity))
+        return;
+
+    uvec2 workItem = WorkItems[item];
+    ivec2 pixel = ivec2(workItem.x % uint(size.x), workItem.x / uint(size.x));
+    int j = int(workItem.y >> 16);
+    int chunk = int(workItem.y & 0xffffu);
+
+    GlintPixel p;
+    loadGlintPixel(pixel, p);
+    GlintFootprint fp = glintFootprint(p.dst0, p.dst1, p.sigmas_rho, pixel);
+
+    float sum[NB_GLINT_LIGHTS];
+    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+        sum[k] = 0.;
+    float sumWts = 0.;
+    P22__glint_discrete_LOD_cells(fp.level[j], p.slope_h, p.active, p.texCoord,
+                                  fp.dst0, fp.dst1, p.slope_dx, p.slope_dy,
+                                  p.sigmas_rho, fp.inv_lt, fp.LOD_dist[j],
+                                  fp.occupancyLayer, chunk * GLINT_CHUNK_CELLS,
+                                  min((chunk + 1) * GLINT_CHUNK_CELLS,
+                                      GlintCellBudget + 1),
+                                  sum, sumWts);
+
+    vec4 partial = vec4(0., 0., 0., sumWts);
+    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+        partial[k] = sum[k];
+    PartialSums[item] = partial;
+}
+
+//=============================================================================
+//=============================== Resolve =====================================
+//=============================================================================
+void resolve(ivec2 pixel, ivec2 size)
+{
+    GlintPixel p;
+    if (!all(lessThan(pixel, size)) || !loadGlintPixel(pixel, p))
+        return;
+
+    GlintFootprint fp = glintFootprint(p.dst0, p.dst1, p.sigmas_rho, pixel);
+    uvec2 work = PixelWork[pixel.y * size.x + pixel.x];
+
+    float P22_P[NB_GLINT_LIGHTS];
+    if (work.x == GLINT_NO_WORK_ITEM || !fp.cells)
+    {
+        P22_P_footprint(fp, p.texCoord, p.slope_h, p.active,
+                        p.slope_dx, p.slope_dy, p.sigmas_rho, P22_P);
+    }
+    else
+    {
+        // Same as P22_P_footprint, from the chunks of the levels
+        float P22_P_l[2 * NB_GLINT_LIGHTS];
+        uint item = work.x;
+        for (int j = 0; j < 2; ++j)
+        {
+            uint chunks = j == 0 ? work.y & 0xffffu : work.y >> 16;
+            vec4 partial = vec4(0.);
+            for (uint c = 0u; c < chunks; ++c)
+                partial += PartialSums[item++];
+            for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+                P22_P_l[j * NB_GLINT_LIGHTS + k] = partial[k] / partial.w;
+        }
+
+        for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+            P22_P[k] = fp.levelCount == 1 ? P22_P_l[k]
+                : mix(P22_P_l[k], P22_P_l[NB_GLINT_LIGHTS + k], fp.w);
+    }
+
+    vec3 f[NB_GLINT_LIGHTS];
+    glintBRDF(p.wo, p.wi, p.wh, p.active, P22_P, f);
+
+    // As in main: point light, then directional light
+    vec3 Li[NB_GLINT_LIGHTS];
+    Li[0] = PointLight.L / p.distanceSquared;
+    Li[1] = DirLight.L;
+    vec3 radiance = vec3(0.);
+    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+        radiance += p.ks * f[k] * 0.5 * Li[k];
+
+    vec4 color = imageLoad(GlintColor, pixel);
+    imageStore(GlintColor, pixel, vec4(color.rgb + radiance, color.a));
+}
+
+void main()
+{
+    ivec2 size = imageSize(GlintColor);
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+
+    if (GlintPass == 0)
+        classify(pixel, size);
+    else if (GlintPass == 1)
+        evaluate(size);
+    else
+        resolve(pixel, size);
+}
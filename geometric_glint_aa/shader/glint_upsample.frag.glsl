@@ -0,0 +1,99 @@
+#version 330
+
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Joint bilateral upsampling of the glints of the lights, shaded by the
+// deferred pass at one pixel every GlintScale x GlintScale pixels
+// (DeferredTerms == 2). The result is added to tex_sample, which holds the
+// other terms at full resolution. The weights of the four nearest reduced
+// resolution pixels are guided by the G-buffer: depth, normal and size of
+// the UV footprint, so that the glints don't leak across silhouettes and
+// between surfaces of different scales.
+
+uniform usampler2D GlintGBufferTex[4];  // Words 0 to 3 of the G-buffer
+uniform sampler2D GlintTex;             // Reduced resolution glints
+uniform int GlintScale;
+uniform vec3 CameraPosition;
+
+// Relative depth difference of a weight of 1/e, exponent of the normal weight
+const float DepthSigma = 0.05;
+const float NormalPower = 32.;
+
+#define DEFERRED_COVERED 1u
+
+out vec4 FragColor;
+
+// log2 of the magnitude of a half float, from its bits (no unpacking in
+// GLSL 3.30): exponent plus a linear mantissa
+float halfLog2(uint h)
+{
+    float e = float((h >> 10) & 0x1fu);
+    float m = float(h & 0x3ffu) / 1024.;
+    return e == 0. ? -24. : e - 15. + m;
+}
+
+// log2 of the size of the UV footprint, largest component of dst0 and dst1
+float footprintLog2(uint dst0, uint dst1)
+{
+    return max(max(halfLog2(dst0 & 0xffffu), halfLog2(dst0 >> 16)),
+               max(halfLog2(dst1 & 0xffffu), halfLog2(dst1 >> 16)));
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    uvec4 g3 = texelFetch(GlintGBufferTex[3], pixel, 0);
+    if (((g3.w >> 16) & DEFERRED_COVERED) == 0u)
+        discard;
+
+    vec3 position = uintBitsToFloat(texelFetch(GlintGBufferTex[0], pixel, 0).xyz);
+    vec3 normal = uintBitsToFloat(texelFetch(GlintGBufferTex[2], pixel, 0).xyz);
+    float depth = distance(CameraPosition, position);
+    float footprint = footprintLog2(g3.x, g3.y);
+
+    // Reduced resolution pixel i is shaded at full resolution pixel
+    // i * GlintScale + GlintScale / 2
+    ivec2 lowSize = textureSize(GlintTex, 0);
+    ivec2 size = textureSize(GlintGBufferTex[0], 0);
+    vec2 p = (vec2(pixel) - float(GlintScale / 2)) / float(GlintScale);
+    ivec2 p0 = ivec2(floor(p));
+    vec2 f = p - vec2(p0);
+
+    vec3 sum = vec3(0.);
+    float sumW = 0.;
+    for (int k = 0; k < 4; ++k)
+    {
+        ivec2 o = ivec2(k & 1, k >> 1);
+        ivec2 q = clamp(p0 + o, ivec2(0), lowSize - 1);
+        ivec2 qPixel = min(q * GlintScale + GlintScale / 2, size - 1);
+
+        uvec4 qg3 = texelFetch(GlintGBufferTex[3], qPixel, 0);
+        if (((qg3.w >> 16) & DEFERRED_COVERED) == 0u)
+            continue;
+        vec3 qPosition = uintBitsToFloat(texelFetch(GlintGBufferTex[0], qPixel, 0).xyz);
+        vec3 qNormal = uintBitsToFloat(texelFetch(GlintGBufferTex[2], qPixel, 0).xyz);
+
+        vec2 bilinear = mix(1. - f, f, vec2(o));
+        float w = bilinear.x * bilinear.y + 1e-4;
+        w *= exp(-abs(distance(CameraPosition, qPosition) - depth) 
+                 / (DepthSigma * depth));
+        w *= pow(max(dot(normal, qNormal), 0.), NormalPower);
+        w *= exp2(-abs(footprintLog2(qg3.x, qg3.y) - footprint));
+
+        sum += w * texelFetch(GlintTex, q, 0).rgb;
+        sumW += w;
+    }
+
+    // No neighbour on the same surface (e.g. thin geometry): no glints
+    if (sumW <= 0.)
+        discard;
+    // Added to tex_sample (GL_ONE, GL_ONE), its alpha is kept
+    FragColor = vec4(sum / sumW, 0.);
+}
@@ -9,6 +9,66 @@
 // 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
 // Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
 
+//=============================================================================
+//============================= Half precision ================================
+//=============================================================================
+// GLINT_FLOAT16 is defined by SceneObj (which then compiles the shader as
+// #version 450) when the driver exposes GL_AMD_gpu_shader_half_float or
+// GL_NV_gpu_shader5, the OpenGL extensions with float16_t arithmetic
+// (GL_EXT_shader_explicit_arithmetic_types_float16 is Vulkan GLSL only).
+// The dictionary value products, the EWA weights and the Beckmann
+// evaluation use hfloat, the cell index math stays in float. Without
+// either extension the variant does not compile: it never falls back to
+// float silently.
+#ifdef GLINT_FLOAT16
+#if defined(GL_AMD_gpu_shader_half_float)
+#extension GL_AMD_gpu_shader_half_float : require
+#elif defined(GL_NV_gpu_shader5)
+#extension GL_NV_gpu_shader5 : require
+#else
+#error "GLINT_FLOAT16 needs float16_t arithmetic"
+#endif
+#define hfloat float16_t
+#else
+#define hfloat float
+#endif
+
+// packHalf2x16 of the G-buffers (core in GLSL 4.20), emulated otherwise
+#if __VERSION__ >= 420
+#elif defined(GL_ARB_shading_language_packing)
+#extension GL_ARB_shading_language_packing : enable
+#else
+#define GLINT_EMULATE_PACK_HALF
+#endif
+
+// GLINT_DEPTH_PREPASS is defined by SceneObj when the depth of the meshes is
+// rendered first (depth_prepass.frag.glsl): the masked fragments are already
+// discarded and the depth test can be done before the shader runs.
+#ifdef GLINT_DEPTH_PREPASS
+#if __VERSION__ >= 420
+layout(early_fragment_tests) in;
+#elif defined(GL_ARB_shader_image_load_store)
+#extension GL_ARB_shader_image_load_store : enable
+layout(early_fragment_tests) in;
+#endif
+#endif
+
+//=============================================================================
+//============================= Compute shader ================================
+//=============================================================================
+// GLINT_COMPUTE is defined by SceneObj when this file is the first part of
+// the tiled glint compute shader (glint_tiled.comp.glsl, GLSL 4.30): the
+// fragment stage (inputs, outputs, derivatives, main) is left out and the
+// pixels are read from the glint G-buffer.
+//
+// GLINT_DEFERRED is defined by SceneObj for the deferred shading pass: a
+// fullscreen quad shades every pixel once, from the surface written to the
+// deferred G-buffer by the mesh pass (GlintEvaluation 2).
+#if !defined(GLINT_COMPUTE) && !defined(GLINT_DEFERRED)
+#define GLINT_RASTER
+#endif
+
+#ifdef GLINT_RASTER
 //=============================================================================
 //============================= Vertex information ============================
 //=============================================================================
@@ -16,6 +76,7 @@ in vec2 TexCoord;
 in vec3 VertexPos;
 in vec3 VertexNorm;
 in vec3 VertexTang;
+#endif
 
 //=============================================================================
 //============================= Light information =============================
@@ -30,6 +91,41 @@ uniform struct DirLightInfo {
   vec3 L;         // Intensity
 } DirLight;
 
+uniform struct AreaLightInfo {
+  int Shape;      // 0: none, 1: rectangle, 2: disk
+  vec3 Position;  // Center of the light in world coords.
+  vec3 U;         // Half axes in world coords., the light emits toward
+  vec3 V;         // cross(U, V)
+  vec3 L;         // Radiance
+} AreaLight;
+
+// GLINT_CLUSTERED_LIGHTS is defined by SceneObj (GLSL 4.30) for the many
+// point lights of the clustered forward lighting: the lights of the froxel
+// of the pixel are listed by light_clusters.comp.glsl (see
+// glint/lightclusters.h for the layouts).
+#if defined(GLINT_CLUSTERED_LIGHTS) && !defined(GLINT_COMPUTE)
+struct ClusterLight {
+    vec4 PositionRadius;    // World position, radius of influence
+    vec4 L;                 // Intensity
+};
+
+layout(std430, binding = 5) readonly buffer ClusterLightBuffer {
+    ClusterLight clusterLights[];
+};
+
+// Per froxel: number of lights, then MaxLightsPerCluster indices
+layout(std430, binding = 6) readonly buffer ClusterListBuffer {
+    uint clusterList[];
+};
+
+uniform mat4 ClusterView;
+uniform ivec2 ClusterTiles;
+uniform int ClusterSlices;
+uniform int MaxLightsPerCluster;
+uniform vec2 ClusterSliceScaleBias;  // slice = log(depth) * x - y
+uniform vec2 ClusterTileScale;       // Tiles per pixel
+#endif
+
 uniform bool UseEnvMap;
 uniform float ScaleIntensityEnvMap;
 
@@ -38,10 +134,24 @@ uniform float ScaleIntensityEnvMap;
 //=============================================================================
 uniform struct MaterialInfo {
   float Alpha;                // Material isotropic roughness
-  float LogMicrofacetDensity; // Logarithmic microfacet density
-  float MicrofacetRelativeArea;
 } Material;
 
+// Glint constants precomputed on the CPU (see glint/lodtable.h), for the
+// material of the mesh and for the user values of OverrideMaterials
+#define GLINT_LOD_TABLE_SIZE 32
+
+layout(std140) uniform MaterialGlintBlock {
+  vec4  LODDist[GLINT_LOD_TABLE_SIZE / 4]; // Distribution LOD of the cells of level l
+  float LogMicrofacetDensity;              // Logarithmic microfacet density
+  float MicrofacetRelativeArea;
+} MaterialGlint;
+
+layout(std140) uniform UserGlintBlock {
+  vec4  LODDist[GLINT_LOD_TABLE_SIZE / 4];
+  float LogMicrofacetDensity;
+  float MicrofacetRelativeArea;
+} UserGlint;
+
 
 uniform bool UseBump;
 uniform bool UseDiffuseTex;
@@ -50,13 +160,19 @@ uniform vec3 Kd;
 uniform vec3 Ks;
 
 uniform vec3  UserSigmasRho;
-uniform float UserMicrofacetRelativeArea;
-uniform float UserLogMicrofacetDensity;
 uniform bool  OverrideMaterials;
 
 uniform vec2  ScaleUV = vec2(1.);
 
 uniform float MaxAnisotropy;
+// Maximum number of cells visited per pixel and per level:
+// glint::kMaxGlintCells, lowered by the adaptive cell budget when the frame
+// is too long
+uniform int   GlintCellBudget;
+
+// Lights whose glint radiance is bounded by GlintCullRadiance are not
+// evaluated (see f_P_upper_bound), 0: off
+uniform float GlintCullRadiance;
 
 //=============================================================================
 //========================== Dictionary information ===========================
@@ -66,6 +182,7 @@ uniform struct DictionaryInfo {
   int N;
   int NLevels;
   int Pyramid0Size;
+  float MaxValue;   // Largest value of the marginals
 } Dictionary;
 
 uniform vec3  CameraPosition;
@@ -83,9 +200,36 @@ uniform int   LeanMode;
 // Activate reference
 uniform bool  ComputeReference;
 
+#ifdef GLINT_RASTER
+// Reference: ReferenceSubsamples x ReferenceSubsamples subpixel samples
+// shaded by the fragment, in a cell of ReferenceCellSize pixels around it
+uniform int   ReferenceSubsamples;
+uniform float ReferenceCellSize;
+// Adaptive reference: unconverged pixels per ReferenceTileSize tile of the
+// screen (reference_convergence.frag.glsl), converged tiles are not shaded
+uniform bool      ReferenceAdaptive;
+uniform sampler2D ReferenceTileTex;
+uniform int       ReferenceTileSize;
+#endif
+
 // Only specular
 uniform bool OnlySpecular;
 
+// One level of the footprint per pixel, chosen by blue noise dithering of
+// the LOD interpolation weight. FrameIndex decorrelates the frames (or the
+// samples of a reference) so that accumulation resolves the noise.
+uniform bool  StochasticLOD;
+uniform int   FrameIndex;
+
+// Paired layout of the dictionary: one fetch of PairedDictionaryTex returns
+// the product of both marginals of a cell. The second distribution is the
+// one paired with the first (glint::Dictionary::PairedWith).
+uniform bool  PairedDictionary;
+
+// Number of cells per pixel, 0: off, 1: cells of the ellipse bounding
+// boxes, 2: cells visited by the span traversal
+uniform int CellCountView;
+
 //=============================================================================
 //============================== Textures =====================================
 //=============================================================================
@@ -97,8 +241,93 @@ uniform sampler2D SecondMomentTex;
 uniform sampler2D SpecularTex;
 uniform sampler2D MaskTex;
 uniform samplerCube EnvMap;
+uniform sampler2D BlueNoiseTex;
+// Pair k of level l: channel k % 4 of layer l * Dictionary.N / 4 + k / 4
+uniform sampler2DArray PairedDictionaryTex;
+
+//=============================================================================
+//=========================== Precomputed cell tables =========================
+//=============================================================================
+// The occupancy bitmasks hold the cells [0, CELL_TILE_SIZE)^2 of every level
+// < CellTableLevels (see glint/celltables.h). They are read for the
+// footprints inside these cells, the others hash their cells.
+#define CELL_TILE_SIZE 256
+#define MAX_OCCUPANCY_AREAS 16
+
+uniform bool  UseCellTables;
+uniform int   CellTableLevels;
 
+// One bit per cell, layer = area index * CellTableLevels + level
+uniform usampler2DArray OccupancyTex;
+uniform float OccupancyAreas[MAX_OCCUPANCY_AREAS];
+uniform int   OccupancyAreaCount;
+
+//=============================================================================
+//======================= Texture-space glint cache ===========================
+//=============================================================================
+// Glint specular radiance of the point and directional lights cached in a
+// virtual texture per mesh (see glint/radiancecache.h). 0: off, 1: read the
+// cache and request pages, 2: shade a page of the cache
+#define CACHE_PAGE_SIZE 64
+#define CACHE_VIRTUAL_PAGES 128
+#define CACHE_LEVELS 8
+#define CACHE_ATLAS_PAGES 32
+
+uniform int  CacheMode;
+uniform int  MeshIndex;
+uniform vec4 MeshUVBounds;              // Min and extent of the scaled UVs
+// Slot + 1 of the resident pages, 0 otherwise. Level = mip, layer = mesh
+uniform usampler2DArray CachePageTable;
+uniform sampler2D CacheAtlas;
+
+//=============================================================================
+//============================ Glint G-buffer =================================
+//=============================================================================
+// 0: the glints are evaluated here, 1: FragColor is the radiance without
+// the glints of the lights, the inputs of f_P are written to the glint
+// G-buffer and the tiled compute pass adds the glints (glint_tiled.comp.glsl),
+// 2: nothing is shaded, the surface is written to the deferred G-buffer
+uniform int GlintEvaluation;
+
+#ifndef GLINT_COMPUTE
 layout( location = 0 ) out vec4 FragColor;
+// Page of the cache needed by the pixel (glint::packCachePage), 0: none
+layout( location = 1 ) out uint CacheFeedback;
+
+// 0: TexCoord * ScaleUV, dFdx of it
+// 1: dFdy of it, half sigma x and y, half rho | glint material << 16
+// 2: wo, glint lights (bits 0-1) | half ks.b << 16
+// 3: wi of the point light, squared distance to the point light
+// 4: wi of the directional light, half ks.r and ks.g
+// 5: half dFdx and dFdy of the slopes of the half vectors, light by light
+layout( location = 2 ) out uvec4 GlintGBuffer0;
+layout( location = 3 ) out uvec4 GlintGBuffer1;
+layout( location = 4 ) out uvec4 GlintGBuffer2;
+layout( location = 5 ) out uvec4 GlintGBuffer3;
+layout( location = 6 ) out uvec4 GlintGBuffer4;
+layout( location = 7 ) out uvec4 GlintGBuffer5;
+
+// Deferred G-buffer, same targets (see Surface):
+// 0: position, texCoord.x
+// 1: tangent, texCoord.y
+// 2: normal, log microfacet density
+// 3: half dst0, half dst1, half sigma x and y, half rho | flags << 16
+// 4: half kd.rg, half kd.b and ks.r, half ks.gb, microfacet relative area
+// 5: half dFdx and dFdy of the slopes of the half vectors, light by light
+#define DEFERRED_COVERED 1u     // Flags: the pixel has a surface
+#define DEFERRED_FLIP_ENV 2u    // See Surface::flipEnv
+#endif
+
+#ifdef GLINT_DEFERRED
+uniform usampler2D GlintGBufferTex[6];
+
+// Terms shaded by the deferred pass. 0: all of them, 1: all but the glints
+// of the lights, 2: the glints of the lights only, one pixel every
+// GlintScale x GlintScale pixels (glint_upsample.frag.glsl then adds them
+// to the other terms)
+uniform int DeferredTerms;
+uniform int GlintScale;
+#endif
 
 //=============================================================================
 //=========================== Constants =======================================
@@ -106,6 +335,55 @@ layout( location = 0 ) out vec4 FragColor;
 const float m_pi = 3.141592;       /* MathConstant: PI             */
 const float m_i_sqrt_2 = 0.707106; /* MathConstant: 1/sqrt(2)      */
 
+// Lights evaluated by the glinty BRDF in a single traversal of the
+// footprint: 0 is the point light, 1 the directional light
+#define NB_GLINT_LIGHTS 2
+
+// Cells of the footprints of the pixel (see CellCountView)
+int nbrOfBoundingBoxCells = 0;
+int nbrOfVisitedCells = 0;
+
+#ifdef GLINT_EMULATE_PACK_HALF
+//=============================================================================
+//====================== Half precision packing (GLSL 3.30) ===================
+//=============================================================================
+// Round to nearest, subnormal halves are flushed to zero
+uint glintFloatToHalf(float x)
+{
+    uint f = floatBitsToUint(x);
+    uint sign = (f >> 16) & 0x8000u;
+    int e = int((f >> 23) & 0xffu) - 112;
+    if (e <= 0)
+        return sign;
+    if (e >= 31)
+        return sign | 0x7c00u;
+    // The rounding carry of the mantissa increments the exponent
+    return sign | ((uint(e) << 10) + (((f & 0x7fffffu) + 0x1000u) >> 13));
+}
+
+float glintHalfToFloat(uint h)
+{
+    uint sign = (h & 0x8000u) << 16;
+    uint e = (h >> 10) & 0x1fu;
+    uint m = h & 0x3ffu;
+    if (e == 0u)
+        return (sign != 0u ? -1. : 1.) * float(m) * exp2(-24.);
+    if (e == 31u)
+        return uintBitsToFloat(sign | 0x7f800000u | m << 13);
+    return uintBitsToFloat(sign | (e + 112u) << 23 | m << 13);
+}
+
+uint packHalf2x16(vec2 v)
+{
+    return glintFloatToHalf(v.x) | glintFloatToHalf(v.y) << 16;
+}
+
+vec2 unpackHalf2x16(uint u)
+{
+    return vec2(glintHalfToFloat(u & 0xffffu), glintHalfToFloat(u >> 16));
+}
+#endif
+
 
 //=============================================================================
 //================== Compute LOD from roughness (Env map) =====================
@@ -136,8 +414,10 @@ float non_axis_aligned_anisotropic_beckmann
 
     float z = ((x_sqr/sigma_x_sqr) - ( (2. * rho *x*y) 
                   / (sigma_x * sigma_y)) + (y_sqr/sigma_y_sqr)) ;
-    return exp( - z / (2. * (1. - rho * rho))) 
-        / ( 2. * m_pi * sigma_x * sigma_y * sqrt(1. - rho * rho));
+    // z overflows in half precision at grazing angles: only the
+    // exponential and the normalisation use hfloat
+    return float(exp(hfloat( - z / (2. * (1. - rho * rho)))) 
+        / hfloat( 2. * m_pi * sigma_x * sigma_y * sqrt(1. - rho * rho)));
 }
 
 //=============================================================================
@@ -193,6 +473,70 @@ int pyramidSize(int level)
     return int(pow(2., float(Dictionary.NLevels - 1 - level)));
 }
 
+//=============================================================================
+//====================== Precomputed glint constants ==========================
+//=============================================================================
+#ifdef GLINT_COMPUTE
+// The blocks of all the materials, 0: UserGlintBlock, m + 1: block of mesh m
+struct GlintLodBlock {
+  vec4  LODDist[GLINT_LOD_TABLE_SIZE / 4];
+  float LogMicrofacetDensity;
+  float MicrofacetRelativeArea;
+};
+
+layout(std430, binding = 4) readonly buffer GlintMaterialBuffer {
+  GlintLodBlock GlintMaterials[];
+};
+
+// Material of the pixel (GlintGBuffer1)
+int glintMaterial = 0;
+#endif
+
+#ifdef GLINT_DEFERRED
+// Material of the pixel (deferred G-buffer): its distribution LODs are
+// computed instead of read from the table
+float glintLogMicrofacetDensity = 0.;
+float glintRelativeArea = 1.;
+#endif
+
+float glintMicrofacetRelativeArea()
+{
+#if defined(GLINT_COMPUTE)
+    return GlintMaterials[glintMaterial].MicrofacetRelativeArea;
+#elif defined(GLINT_DEFERRED)
+    return glintRelativeArea;
+#else
+    return OverrideMaterials ? UserGlint.MicrofacetRelativeArea
+                             : MaterialGlint.MicrofacetRelativeArea;
+#endif
+}
+
+// Distribution LOD of the cells of pyramid level l
+float glintLODDist(int l)
+{
+#if defined(GLINT_COMPUTE)
+    if (l < GLINT_LOD_TABLE_SIZE)
+        return GlintMaterials[glintMaterial].LODDist[l >> 2][l & 3];
+    float logMicrofacetDensity = 
+        GlintMaterials[glintMaterial].LogMicrofacetDensity;
+#elif defined(GLINT_DEFERRED)
+    float logMicrofacetDensity = glintLogMicrofacetDensity;
+#else
+    if (l < GLINT_LOD_TABLE_SIZE)
+        return OverrideMaterials ? UserGlint.LODDist[l >> 2][l & 3]
+                                 : MaterialGlint.LODDist[l >> 2][l & 3];
+
+    // Beyond the table (huge footprints)
+    float logMicrofacetDensity = OverrideMaterials ?
+        UserGlint.LogMicrofacetDensity : MaterialGlint.LogMicrofacetDensity;
+#endif
+    // Number of microfacets in a cell at level l
+    float n_l = pow(2., float(2 * l - (2 * (Dictionary.NLevels - 1))));
+    n_l *= exp(logMicrofacetDensity);
+    // Corresponding continuous distribution LOD
+    return log(n_l) / 1.38629; // 2. * log(2) = 1.38629
+}
+
 //=============================================================================
 //=============== Sampling from a normal distribution =========================
 //=============================================================================
@@ -207,10 +551,19 @@ float sampleNormalDistribution(float U, float mu, float sigma)
 //=============== and transformed slope distribution function  ================
 //=============================== Equation 4 ==================================
 //=============================================================================
-float P22_M(vec2 slope_h, int l, int s0, int t0, 
-            vec2 slope_dx, vec2 slope_dy,
-            vec3 sigma_x_y_rho, float l_dist)
+// Evaluated for all the lights at once: the random numbers, the distribution
+// LOD, the random rotation and the linear transformation only depend on the
+// cell. Only the half vector slopes and their derivatives depend on the light.
+// occupied: the cell is known to pass the relative area test (bitmask)
+void P22_M(vec2 slope_h[NB_GLINT_LIGHTS], bool active[NB_GLINT_LIGHTS],
+           int l, int s0, int t0, bool occupied,
+           vec2 slope_dx[NB_GLINT_LIGHTS], vec2 slope_dy[NB_GLINT_LIGHTS],
+           vec3 sigma_x_y_rho, vec3 inv_lt, float l_dist,
+           out float P22[NB_GLINT_LIGHTS])
 {
+    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+        P22[k] = 0.;
+
     // Coherent index
     int twoToTheL = int(pow(2.,float(l)));
     s0 *= twoToTheL;
@@ -219,13 +572,14 @@ float P22_M(vec2 slope_h, int l, int s0, int t0,
     // Seed pseudo random generator
     uint rngSeed = uint(s0 + 1549 * t0);
 
-    float uMicrofacetRelativeArea = hashIQ(rngSeed * 13U);
-    // Discard cells by using microfacet relative area
-    if (OverrideMaterials && 
-        uMicrofacetRelativeArea > UserMicrofacetRelativeArea ||
-        !OverrideMaterials && 
-        uMicrofacetRelativeArea > Material.MicrofacetRelativeArea)
-        return 0.f;
+    // Discard cells by using microfacet relative area (the bitmask holds
+    // the same test for the relative areas of OccupancyAreas)
+    if (!occupied)
+    {
+        float uMicrofacetRelativeArea = hashIQ(rngSeed * 13U);
+        if (uMicrofacetRelativeArea > glintMicrofacetRelativeArea())
+            return;
+    }
 
     float uDensityRandomisation = hashIQ(rngSeed * 2171U);
 
@@ -246,8 +600,11 @@ float P22_M(vec2 slope_h, int l, int s0, int t0,
 
     // If we are too far from the surface, the SDF is a gaussian.
     if (l_dist == Dictionary.NLevels){
-        return non_axis_aligned_anisotropic_beckmann(slope_h.x, slope_h.y,
-                sigma_x, sigma_y, rho);
+        for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+            if (active[k])
+                P22[k] = non_axis_aligned_anisotropic_beckmann(
+                    slope_h[k].x, slope_h[k].y, sigma_x, sigma_y, rho);
+        return;
     }
 
     // Random rotations to remove glint alignment
@@ -261,10 +618,10 @@ float P22_M(vec2 slope_h, int l, int s0, int t0,
     //========= Linearly transformed isotropic Beckmann distribution ==========
     //=========================================================================
 
-    float SIGMA_DICT = Dictionary.Alpha * m_i_sqrt_2;
-    float tmp1 =  SIGMA_DICT / (sigma_x * sqrt(1. - rho * rho));
-    float tmp2 = -SIGMA_DICT * rho / (sigma_y * sqrt(1. - rho * rho));
-    float tmp3 =  SIGMA_DICT / sigma_y;
+    // inv_lt holds the non-zero terms, computed once per pixel by f_P:
+    // SIGMA_DICT / (sigma_x * sqrt(1. - rho * rho)),
+    // -SIGMA_DICT * rho / (sigma_y * sqrt(1. - rho * rho)),
+    // SIGMA_DICT / sigma_y
 
     //=========================================================================
     //============================= Contribution 2 ============================
@@ -275,8 +632,8 @@ float P22_M(vec2 slope_h, int l, int s0, int t0,
     //                   0.          , 1. / sigma_y)
     //=========================================================================
 
-    mat2 invM = mat2(tmp1, 0.,     // first column
-                     tmp2, tmp3 ); // second column
+    mat2 invM = mat2(inv_lt.x, 0.,        // first column
+                     inv_lt.y, inv_lt.z ); // second column
 
     //=========================================================================
     //========================== END Contribution 2 ===========================
@@ -286,22 +643,11 @@ float P22_M(vec2 slope_h, int l, int s0, int t0,
     mat2 invR = mat2(cosTheta, -sinTheta,  // first column
                      sinTheta,  cosTheta); // second column
     invM = invR*invM;
-
-    // Get back to original space
-    // Equation 5
-    vec2 slope_h_o = invM * slope_h;
-
-    // The SDF is an even function
-    vec2 abs_slope_h_o = vec2(abs(slope_h_o.x), abs(slope_h_o.y));
+    float detInvM = determinant(invM);
 
     int distPerChannel = Dictionary.N / 3;
     float alpha_dist_isqrt2_4 = Dictionary.Alpha * m_i_sqrt_2 * 4.f;
 
-    // After 4 standard deviations, the SDF equals zero
-    if (abs_slope_h_o.x > alpha_dist_isqrt2_4 
-        || abs_slope_h_o.y > alpha_dist_isqrt2_4)
-        return 0.f;
-
     float u1 = hashIQ(rngSeed * 16807U);
     float u2 = hashIQ(rngSeed * 48271U);
 
@@ -312,73 +658,105 @@ float P22_M(vec2 slope_h, int l, int s0, int t0,
     int distIdxXOver3 = i / 3;
     int distIdxYOver3 = j / 3;
 
-    float texCoordX = abs_slope_h_o.x / alpha_dist_isqrt2_4;
-    float texCoordY = abs_slope_h_o.y / alpha_dist_isqrt2_4;
-
-    // We also need to scale the derivatives,
-    // as slope_h, to maintained coherence
-    slope_dx = slope_dx / alpha_dist_isqrt2_4;
-    slope_dy = slope_dy / alpha_dist_isqrt2_4;
+    float layerX = l_dist * distPerChannel + distIdxXOver3;
+    float layerY = l_dist * distPerChannel + distIdxYOver3;
 
-    vec3 P_20_o, P_02_o;
-    //=========================================================================
-    //=========================== Contribution 1 ==============================
-    //================================ GGAA ===================================
-    //=========================================================================
-    if(Filter)
-    {      
-        // As for the distribution, we transform the filtering kernel
-        vec2 transformed_slope_dx = invM * slope_dx;
-        vec2 transformed_slope_dy = invM * slope_dy;
-
-        // Scale the kernel by user parameter
-        transformed_slope_dx *= KernelSize;
-        transformed_slope_dy *= KernelSize;
-        
-        P_20_o = textureGrad(DictionaryTex, 
-                             vec2(texCoordX, 
-                                  l_dist * distPerChannel + distIdxXOver3),
-                             transformed_slope_dx.x, 
-                             transformed_slope_dy.x).rgb;
-
-        P_02_o = textureGrad(DictionaryTex,
-                             vec2(texCoordY, 
-                                  l_dist * distPerChannel + distIdxYOver3), 
-                             transformed_slope_dx.y,
-                             transformed_slope_dy.y).rgb;
-    }
-    //=========================================================================
-    //========================= END Contribution 1 ============================
-    //=========================================================================
-    else // Without geometric glint anti-aliasing
+    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
     {
-        P_20_o = textureLod(DictionaryTex,
-                            vec2(texCoordX,
-                                 l_dist * distPerChannel + distIdxXOver3),
-                            0.).rgb;
-        P_02_o = textureLod(DictionaryTex, 
-                            vec2(texCoordY,
-                                 l_dist * distPerChannel + distIdxYOver3), 
-                            0.).rgb;
-    }
+        if (!active[k])
+            continue;
+
+        // Get back to original space
+        // Equation 5
+        vec2 slope_h_o = invM * slope_h[k];
+
+        // The SDF is an even function
+        vec2 abs_slope_h_o = vec2(abs(slope_h_o.x), abs(slope_h_o.y));
+
+        // After 4 standard deviations, the SDF equals zero
+        if (abs_slope_h_o.x > alpha_dist_isqrt2_4 
+            || abs_slope_h_o.y > alpha_dist_isqrt2_4)
+            continue;
+
+        float texCoordX = abs_slope_h_o.x / alpha_dist_isqrt2_4;
+        float texCoordY = abs_slope_h_o.y / alpha_dist_isqrt2_4;
+
+        if (PairedDictionary)
+        {
+            int pair = min(i, Dictionary.N - 1);
+            float layerXY = l_dist * (Dictionary.N / 4) + pair / 4;
+            vec4 P_20_02_o;
+            if (Filter)
+            {
+                vec2 transformed_slope_dx = invM * (slope_dx[k] / alpha_dist_isqrt2_4);
+                vec2 transformed_slope_dy = invM * (slope_dy[k] / alpha_dist_isqrt2_4);
+                P_20_02_o = textureGrad(PairedDictionaryTex,
+                                        vec3(texCoordX, texCoordY, layerXY),
+                                        transformed_slope_dx * KernelSize,
+                                        transformed_slope_dy * KernelSize);
+            }
+            else
+                P_20_02_o = textureLod(PairedDictionaryTex,
+                                       vec3(texCoordX, texCoordY, layerXY), 0.);
 
-    // Equation 15
-    return P_20_o[int(mod(i, 3))] * P_02_o[int(mod(j, 3))] * determinant(invM);
+            // Equation 15, the product is stored in the texture
+            P22[k] = P_20_02_o[pair & 3] * detInvM;
+            continue;
+        }
+
+        vec3 P_20_o, P_02_o;
+        //=====================================================================
+        //========================= Contribution 1 ============================
+        //============================== GGAA =================================
+        //=====================================================================
+        if(Filter)
+        {      
+            // We also need to scale the derivatives,
+            // as slope_h, to maintained coherence
+            // As for the distribution, we transform the filtering kernel
+            vec2 transformed_slope_dx = invM * (slope_dx[k] / alpha_dist_isqrt2_4);
+            vec2 transformed_slope_dy = invM * (slope_dy[k] / alpha_dist_isqrt2_4);
+
+            // Scale the kernel by user parameter
+            transformed_slope_dx *= KernelSize;
+            transformed_slope_dy *= KernelSize;
+            
+            P_20_o = textureGrad(DictionaryTex, 
+                                 vec2(texCoordX, layerX),
+                                 transformed_slope_dx.x, 
+                                 transformed_slope_dy.x).rgb;
+
+            P_02_o = textureGrad(DictionaryTex,
+                                 vec2(texCoordY, layerY), 
+                                 transformed_slope_dx.y,
+                                 transformed_slope_dy.y).rgb;
+        }
+        //=====================================================================
+        //======================= END Contribution 1 ==========================
+        //=====================================================================
+        else // Without geometric glint anti-aliasing
+        {
+            P_20_o = textureLod(DictionaryTex, vec2(texCoordX, layerX), 0.).rgb;
+            P_02_o = textureLod(DictionaryTex, vec2(texCoordY, layerY), 0.).rgb;
+        }
+
+        // Equation 15
+        // detInvM reaches 1e4 for the smallest roughnesses: kept in float
+        P22[k] = float(hfloat(P_20_o[int(mod(i, 3))]) 
+                       * hfloat(P_02_o[int(mod(j, 3))])) * detInvM;
+    }
 }
 
 //=============================================================================
 //===================== P-SDF for a discrete LOD ==============================
 //=============================================================================
 
-// Most of this function is similar to pbrt-v3 EWA function,
-// which itself is similar to Heckbert 1889 algorithm, 
-// http://www.cs.cmu.edu/~ph/texfund/texfund.pdf, Section 3.5.9.
-// Go through cells within the pixel footprint for a givin LOD
-float P22__glint_discrete_LOD(int l, vec2 slope_h, vec2 st, vec2 dst0, 
-                              vec2 dst1, vec2 slope_dx, vec2 slope_dy, 
-                              vec3 sigma_x_y_rho, float l_dist)
+// Ellipse of the footprint in the cells of level l (pbrt-v3 EWA function):
+// r2 = A ss^2 + B ss tt + C tt^2 < 1 with ss, tt the offsets of a cell to
+// st, bounds = (s0, s1, t0, t1) is its bounding box.
+void glintEllipse(int l, inout vec2 st, vec2 dst0, vec2 dst1, 
+                  out vec3 ABC, out ivec4 bounds)
 {
-
     // Convert surface coordinates to appropriate scale for level
     float pyrSize = pyramidSize(l);
     st[0] = st[0] * pyrSize - 0.5f;
@@ -396,92 +774,263 @@ float P22__glint_discrete_LOD(int l, vec2 slope_h, vec2 st, vec2 dst0,
     A *= invF;
     B *= invF;
     C *= invF;
+    ABC = vec3(A, B, C);
 
     // Compute the ellipse's bounding box in texture space
     float det = -B * B + 4 * A * C;
     float invDet = 1 / det;
     float uSqrt = sqrt(det * C), vSqrt = sqrt(A * det);
-    int s0 = int(ceil(st[0] - 2. * invDet * uSqrt));
-    int s1 = int(floor(st[0] + 2. * invDet * uSqrt));
-    int t0 = int(ceil(st[1] - 2. * invDet * vSqrt));
-    int t1 = int(floor(st[1] + 2. * invDet * vSqrt));
+    bounds = ivec4(int(ceil(st[0] - 2. * invDet * uSqrt)),
+                   int(floor(st[0] + 2. * invDet * uSqrt)),
+                   int(ceil(st[1] - 2. * invDet * vSqrt)),
+                   int(floor(st[1] + 2. * invDet * vSqrt)));
+}
 
-    // Scan over ellipse bound and compute quadratic equation
-    float sum = 0.f;
-    float sumWts = 0;
+// Cells of the bounding box of the ellipse of level l: upper bound of the
+// cells visited by P22__glint_discrete_LOD
+int glintBoundingBoxCells(int l, vec2 st, vec2 dst0, vec2 dst1)
+{
+    vec3 ABC;
+    ivec4 bounds;
+    glintEllipse(l, st, dst0, dst1, ABC, bounds);
+    return max(0, bounds.y - bounds.x + 1) * max(0, bounds.w - bounds.z + 1);
+}
+
+// Most of this function is similar to pbrt-v3 EWA function,
+// which itself is similar to Heckbert 1889 algorithm, 
+// http://www.cs.cmu.edu/~ph/texfund/texfund.pdf, Section 3.5.9.
+// Go through cells within the pixel footprint for a givin LOD.
+// The footprint does not depend on the light: the cells are visited once
+// and evaluated for every light.
+// occupancyLayer: first layer of OccupancyTex for the relative area of the
+// material, -1 without bitmask.
+// Only the visited cells firstCell to endCell - 1 (in the order of the
+// traversal) are accumulated in sum and sumWts: the compute pass splits the
+// footprint in chunks of cells.
+void P22__glint_discrete_LOD_cells(int l, vec2 slope_h[NB_GLINT_LIGHTS],
+                                   bool active[NB_GLINT_LIGHTS], vec2 st, 
+                                   vec2 dst0, vec2 dst1, 
+                                   vec2 slope_dx[NB_GLINT_LIGHTS],
+                                   vec2 slope_dy[NB_GLINT_LIGHTS], 
+                                   vec3 sigma_x_y_rho, vec3 inv_lt, 
+                                   float l_dist, int occupancyLayer,
+                                   int firstCell, int endCell,
+                                   inout float sum[NB_GLINT_LIGHTS],
+                                   inout float sumWts)
+{
+    vec3 ABC;
+    ivec4 bounds;
+    glintEllipse(l, st, dst0, dst1, ABC, bounds);
+    float A = ABC.x;
+    float B = ABC.y;
+    float C = ABC.z;
+    int s0 = bounds.x;
+    int s1 = bounds.y;
+    int t0 = bounds.z;
+    int t1 = bounds.w;
+
+    // The bitmask is only read when the footprint is inside its cells:
+    // wrapping the indices would tile the pattern and break the coherence
+    // of the seeds across levels
+    bool useOccupancy = UseCellTables && l < CellTableLevels
+                        && occupancyLayer >= 0 && s0 >= 0 && t0 >= 0
+                        && s1 < CELL_TILE_SIZE && t1 < CELL_TILE_SIZE;
+
+    nbrOfBoundingBoxCells += max(0, s1 - s0 + 1) * max(0, t1 - t0 + 1);
+
+    // Scan the rows of the ellipse bound. On a row, r2 < 1 between the roots
+    // of the quadratic A ss^2 + (B tt) ss + (C tt^2 - 1): only these cells
+    // are visited.
     int nbrOfIter = 0;
     for (int it = t0; it <= t1; ++it)
     {
         float tt = it - st[1];
-        for (int is = s0; is <= s1; ++is)
+        float b = B * tt;
+        float c = C * tt * tt - 1.;
+        float delta = b * b - 4. * A * c;
+        if (delta < 0.)
+            continue;
+        float sqrtDelta = sqrt(delta);
+        int is0 = max(s0, int(ceil(st[0] + (-b - sqrtDelta) / (2. * A))));
+        int is1 = min(s1, int(floor(st[0] + (-b + sqrtDelta) / (2. * A))));
+
+        // The roots are rounded: include the neighbouring cell if it
+        // passes the test of the loop below
+        float ss0 = is0 - 1 - st[0];
+        float ss1 = is1 + 1 - st[0];
+        if (is0 > s0 && A * ss0 * ss0 + B * ss0 * tt + C * tt * tt < 1) --is0;
+        if (is1 < s1 && A * ss1 * ss1 + B * ss1 * tt + C * tt * tt < 1) ++is1;
+
+        // Occupancy of 32 consecutive cells of the row, fetched when the
+        // traversal enters a word: none is cached before is0
+        int occupancyWord = (is0 >> 5) - 1;
+        uint occupancyBits = 0u;
+
+        for (int is = is0; is <= is1; ++is)
         {
             float ss = is - st[0];
             // Compute squared radius 
             // and filter SDF if inside ellipse
             float r2 = A * ss * ss + B * ss * tt + C * tt * tt;
-            if (r2 < 1)
+            // Cells before firstCell are only counted
+            if (r2 < 1 && nbrOfIter++ >= firstCell)
             {
                 // Weighting function used in pbrt-v3 EWA function
                 float alpha = 2;
-                float W_P = exp(-alpha * r2) - exp(-alpha);
-                sum += P22_M(slope_h, l, is, it, 
-                             slope_dx, slope_dy, 
-                             sigma_x_y_rho, l_dist) * W_P;
+                float W_P = float(exp(hfloat(-alpha * r2)) 
+                                  - exp(hfloat(-alpha)));
                 sumWts += W_P;
+
+                bool occupied = true;
+                if (useOccupancy)
+                {
+                    if (is >> 5 != occupancyWord)
+                    {
+                        occupancyWord = is >> 5;
+                        occupancyBits = texelFetch(OccupancyTex,
+                            ivec3(is >> 5, it, occupancyLayer + l), 0).r;
+                    }
+                    // Empty cells only weight the filter
+                    occupied = ((occupancyBits >> uint(is & 31)) & 1u) != 0u;
+                }
+
+                if (occupied)
+                {
+                    float P22_cell[NB_GLINT_LIGHTS];
+                    P22_M(slope_h, active, l, is, it, useOccupancy,
+                          slope_dx, slope_dy, 
+                          sigma_x_y_rho, inv_lt, l_dist, P22_cell);
+                    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+                        sum[k] += P22_cell[k] * W_P;
+                }
             }
-            nbrOfIter++;
-            // Guardrail (Extremely rare case.)
-            if (nbrOfIter > 100)
+            // Guardrail (Extremely rare case without adaptive budget.)
+            if (nbrOfIter >= endCell)
                 break;
         }
-        // Guardrail (Extremely rare case.)
-        if (nbrOfIter > 100)
+        // Guardrail (Extremely rare case without adaptive budget.)
+        if (nbrOfIter >= endCell)
             break;
     }
-    return sum/sumWts;
+    nbrOfVisitedCells += max(0, nbrOfIter - firstCell);
+}
+
+// P-SDF of level l: all the cells of the footprint, at most
+// GlintCellBudget + 1
+void P22__glint_discrete_LOD(int l, vec2 slope_h[NB_GLINT_LIGHTS],
+                             bool active[NB_GLINT_LIGHTS], vec2 st, vec2 dst0, 
+                             vec2 dst1, vec2 slope_dx[NB_GLINT_LIGHTS],
+                             vec2 slope_dy[NB_GLINT_LIGHTS], 
+                             vec3 sigma_x_y_rho, vec3 inv_lt, float l_dist,
+                             int occupancyLayer,
+                             out float P22[NB_GLINT_LIGHTS])
+{
+    float sum[NB_GLINT_LIGHTS];
+    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+        sum[k] = 0.f;
+    float sumWts = 0;
+    P22__glint_discrete_LOD_cells(l, slope_h, active, st, dst0, dst1,
+                                  slope_dx, slope_dy, sigma_x_y_rho, inv_lt,
+                                  l_dist, occupancyLayer, 
+                                  0, GlintCellBudget + 1, sum, sumWts);
+    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+        P22[k] = sum[k]/sumWts;
 }
 
 //=============================================================================
 //======== Evaluation of the procedural physically based glinty BRDF ==========
 //=============================================================================
-vec3 f_P(vec3 wo, vec3 wi, vec3 sigmas_rho)
+// Half vectors of the lights and their slopes
+void glintHalfVectors(vec3 wo, vec3 wi[NB_GLINT_LIGHTS],
+                      out vec3 wh[NB_GLINT_LIGHTS],
+                      out vec2 slope_h[NB_GLINT_LIGHTS])
 {
-    if (wo.z <= 0.)
-        return vec3(0., 0., 0.);
-    if (wi.z <= 0.)
-        return vec3(0., 0., 0.);
-
-    vec3 wh = normalize(wo + wi);
-    if (wh.z <= 0.)
-        return vec3(0., 0., 0.);
-
-    // Local masking shadowing
-    if (dot(wo, wh) <= 0. || dot(wi, wh) <= 0.)
-        return vec3(0.,0.,0.);
-
-    // Compute texture derivatives
-    vec2 texCoord = TexCoord * ScaleUV;
-    vec2 dst0 = dFdx(texCoord);
-    vec2 dst1 = dFdy(texCoord);
+    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+    {
+        wh[k] = normalize(wo + wi[k]);
 
-    // Normal to slope
-    vec2 slope_h = vec2(-wh.x / wh.z, -wh.y / wh.z);
+        // Normal to slope
+        slope_h[k] = vec2(-wh[k].x / wh[k].z, -wh[k].y / wh[k].z);
+    }
+}
 
-    vec2 slope_dx;
-    vec2 slope_dy;
-    if(UseHemisDerivatives){
-        // Derivatives in the projected hemispherical domain
-        vec2 projected_half_vector = vec2(wh.x, wh.y);
-        slope_dx = dFdx(projected_half_vector);
-        slope_dy = dFdy(projected_half_vector);
+// Local masking shadowing, returns true if a light is still active
+bool glintVisible(vec3 wo, vec3 wi[NB_GLINT_LIGHTS], vec3 wh[NB_GLINT_LIGHTS],
+                  inout bool active[NB_GLINT_LIGHTS])
+{
+    bool any_active = false;
+    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+    {
+        active[k] = active[k] && wo.z > 0. && wi[k].z > 0. && wh[k].z > 0.
+                    && dot(wo, wh[k]) > 0. && dot(wi[k], wh[k]) > 0.;
+        any_active = any_active || active[k];
     }
-    else{
-        slope_dx = dFdx(slope_h);
-        slope_dy = dFdy(slope_h);
+    return any_active;
+}
+
+#ifdef GLINT_RASTER
+// Screen space derivatives of the slopes and of the texture coordinates.
+// Must be called in uniform control flow.
+void glintDerivatives(vec3 wh[NB_GLINT_LIGHTS], vec2 slope_h[NB_GLINT_LIGHTS],
+                      out vec2 slope_dx[NB_GLINT_LIGHTS],
+                      out vec2 slope_dy[NB_GLINT_LIGHTS],
+                      out vec2 dst0, out vec2 dst1)
+{
+    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+    {
+        if(UseHemisDerivatives){
+            // Derivatives in the projected hemispherical domain
+            vec2 projected_half_vector = vec2(wh[k].x, wh[k].y);
+            slope_dx[k] = dFdx(projected_half_vector);
+            slope_dy[k] = dFdy(projected_half_vector);
+        }
+        else{
+            slope_dx[k] = dFdx(slope_h[k]);
+            slope_dy[k] = dFdy(slope_h[k]);
+        }
     }
 
-    vec3 D_P = vec3(0.);
-    float P22_P = 0.;
+    // Compute texture derivatives
+    vec2 texCoord = TexCoord * ScaleUV;
+    dst0 = dFdx(texCoord);
+    dst1 = dFdy(texCoord);
+}
+#endif
+
+// Footprint of a pixel in the cells: the ellipse, its LODs and what is
+// shared by all the lights and all the cells
+struct GlintFootprint {
+    vec2  dst0, dst1;       // Axes of the ellipse, eccentricity clamped
+    int   levelCount;       // 0: no footprint, 1: stochastic LOD, 2: both
+    int   level[2];         // Pyramid levels il and il + 1 (or the chosen one)
+    float LOD_dist[2];      // Their continuous distribution LODs
+    float w;                // Interpolation weight of level[1]
+    bool  cells;            // false: Beckmann distribution at both levels
+    int   occupancyLayer;   // See P22__glint_discrete_LOD
+    vec3  inv_lt;           // Equation 18
+};
+
+// pixel: blue noise of the stochastic LOD
+GlintFootprint glintFootprint(vec2 dst0, vec2 dst1, vec3 sigmas_rho,
+                              ivec2 pixel)
+{
+    GlintFootprint fp;
+    fp.levelCount = 0;
+    fp.level[0] = 0;
+    fp.level[1] = 0;
+    fp.LOD_dist[0] = 0.;
+    fp.LOD_dist[1] = 0.;
+    fp.w = 0.;
+    fp.cells = false;
+    fp.occupancyLayer = -1;
+
+    // Inverse linear transformation of the dictionary distributions
+    // (Equation 18), the same for all the cells of the pixel
+    float SIGMA_DICT = Dictionary.Alpha * m_i_sqrt_2;
+    float sqrt_1_rho_sqr = sqrt(1. - sigmas_rho.z * sigmas_rho.z);
+    fp.inv_lt = vec3( SIGMA_DICT / (sigmas_rho.x * sqrt_1_rho_sqr),
+                     -SIGMA_DICT * sigmas_rho.z / (sigmas_rho.y * sqrt_1_rho_sqr),
+                      SIGMA_DICT / sigmas_rho.y);
 
     //=========================================================================
     // Similar to pbrt-v3 MIPMap::Lookup function, 
@@ -512,87 +1061,168 @@ vec3 f_P(vec3 wo, vec3 wi, vec3 sigmas_rho)
         minorLength *= scale;
     }
     //=========================================================================
+    fp.dst0 = dst0;
+    fp.dst1 = dst1;
 
     // Without footprint -> no reflection
-    if (minorLength == 0) D_P = vec3(0.,0.,0.);
-    else
-    {
-        // Choose LOD
-        float l =
-            max(0., Dictionary.NLevels - 1. + log2(minorLength));
-        int il = int(floor(l));
+    if (minorLength == 0)
+        return fp;
 
-        float w = l - float(il);
+    // Choose LOD
+    float l =
+        max(0., Dictionary.NLevels - 1. + log2(minorLength));
+    int il = int(floor(l));
 
-        // Number of microfacets in a cell at level il
-        float n_il = pow(2., float(2 * il - (2 * (Dictionary.NLevels - 1))));
-        if(!OverrideMaterials)
-            n_il *= exp(Material.LogMicrofacetDensity);
-        else
-            n_il *= exp(UserLogMicrofacetDensity);
-        // Corresponding continuous distribution LOD
-        float LOD_dist_il = log(n_il) / 1.38629; // 2. * log(2) = 1.38629
-
-        // Number of microfacets in a cell at level il + 1
-        float n_ilp1 = 
-            pow(2., float(2 * (il + 1) - (2 * (Dictionary.NLevels - 1))));
-        if(!OverrideMaterials)
-            n_ilp1 *= exp(Material.LogMicrofacetDensity);
-        else
-            n_ilp1 *= exp(UserLogMicrofacetDensity);
-        // Corresponding continuous distribution LOD
-        float LOD_dist_ilp1 = log(n_ilp1) / 1.38629; // 2. * log(2) = 1.38629
+    float w = l - float(il);
+
+    // Corresponding continuous distribution LODs
+    float LOD_dist_il = glintLODDist(il);
+    float LOD_dist_ilp1 = glintLODDist(il + 1);
+
+    float microfacetRelativeArea = glintMicrofacetRelativeArea();
+    bool opti = microfacetRelativeArea > 0.99;
+
+    // Occupancy bitmask of the relative area
+    for (int i = 0; i < OccupancyAreaCount; ++i)
+        if (OccupancyAreas[i] == microfacetRelativeArea)
+        {
+            fp.occupancyLayer = i * CellTableLevels;
+            break;
+        }
 
-        float P22_P_il = non_axis_aligned_anisotropic_beckmann
-            (slope_h.x, slope_h.y, sigmas_rho.x, sigmas_rho.y, sigmas_rho.z);
-        float P22_P_ilp1 = P22_P_il;
+    fp.cells = int(round(LOD_dist_il)) < Dictionary.NLevels || !opti;
 
-        float microfacetRelativeArea = Material.MicrofacetRelativeArea;
-        if(OverrideMaterials) microfacetRelativeArea = 
-            UserMicrofacetRelativeArea;
-        bool opti = microfacetRelativeArea > 0.99;
+    if (StochasticLOD)
+    {
+        // Level il+1 with probability w: the expected value is the
+        // interpolation of the two levels
+        ivec2 noiseSize = textureSize(BlueNoiseTex, 0);
+        float u = texelFetch(BlueNoiseTex, pixel % noiseSize, 0).r;
+        // Golden ratio offset between frames
+        u = fract(u + float(FrameIndex) * 0.618034);
+
+        bool upper = u < w;
+        fp.levelCount = 1;
+        fp.level[0] = upper ? il+1 : il;
+        fp.LOD_dist[0] = upper ? LOD_dist_ilp1 : LOD_dist_il;
+    }
+    else
+    {
+        fp.levelCount = 2;
+        fp.level[0] = il;
+        fp.level[1] = il+1;
+        fp.LOD_dist[0] = LOD_dist_il;
+        fp.LOD_dist[1] = LOD_dist_ilp1;
+        fp.w = w;
+    }
+    return fp;
+}
+
+// P-SDF of the Beckmann distribution (farthest distribution LOD)
+void glintBeckmann(vec2 slope_h[NB_GLINT_LIGHTS], vec3 sigmas_rho,
+                   out float P22[NB_GLINT_LIGHTS])
+{
+    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+        P22[k] = non_axis_aligned_anisotropic_beckmann
+            (slope_h[k].x, slope_h[k].y,
+             sigmas_rho.x, sigmas_rho.y, sigmas_rho.z);
+}
+
+// Glinty BRDF from the P-SDFs of the pixel, inactive lights are black
+void glintBRDF(vec3 wo, vec3 wi[NB_GLINT_LIGHTS], vec3 wh[NB_GLINT_LIGHTS],
+               bool active[NB_GLINT_LIGHTS], float P22_P[NB_GLINT_LIGHTS],
+               out vec3 f[NB_GLINT_LIGHTS])
+{
+    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+    {
+        f[k] = vec3(0., 0., 0.);
+        if (!active[k])
+            continue;
 
-        if(int(round(LOD_dist_il)) < Dictionary.NLevels || !opti)
-            P22_P_il = P22__glint_discrete_LOD
-                (il, slope_h, texCoord, dst0, dst1, 
-                 slope_dx, slope_dy, sigmas_rho, LOD_dist_il);
+        vec3 D_P = vec3(P22_P[k] / (wh[k].z * wh[k].z * wh[k].z * wh[k].z));
 
-        if(int(round(LOD_dist_il)) < Dictionary.NLevels || !opti)
-            P22_P_ilp1 = P22__glint_discrete_LOD
-                (il+1, slope_h, texCoord, dst0, dst1, 
-                 slope_dx, slope_dy, sigmas_rho, LOD_dist_ilp1);
+        // V-cavity masking shadowing
+        float G1wowh = min(1., 2. * wh[k].z * wo.z / dot(wo, wh[k]));
+        float G1wiwh = min(1., 2. * wh[k].z * wi[k].z / dot(wi[k], wh[k]));
+        float G = G1wowh * G1wiwh;
 
-        P22_P = mix(P22_P_il, P22_P_ilp1, w);
+        // Fresnel is set to one for simplicity
+        // but feel free to use "real" Fresnel term
+        vec3 F = vec3(1.);
 
-        D_P = vec3(P22_P / (wh.z * wh.z * wh.z * wh.z));
+        // (wi dot wg) is cancelled by
+        // the cosine weight in the rendering equation
+        f[k] = (F * G * D_P) / (4. * wo.z);
     }
+}
 
-    // V-cavity masking shadowing
-    float G1wowh = min(1., 2. * wh.z * wo.z / dot(wo, wh));
-    float G1wiwh = min(1., 2. * wh.z * wi.z / dot(wi, wh));
-    float G = G1wowh * G1wiwh;
+// P-SDF of the footprint for all the lights: the levels, evaluated with
+// the cells or the Beckmann distribution, and their interpolation
+void P22_P_footprint(GlintFootprint fp, vec2 st, 
+                     vec2 slope_h[NB_GLINT_LIGHTS], bool active[NB_GLINT_LIGHTS],
+                     vec2 slope_dx[NB_GLINT_LIGHTS], 
+                     vec2 slope_dy[NB_GLINT_LIGHTS], vec3 sigmas_rho,
+                     out float P22_P[NB_GLINT_LIGHTS])
+{
+    float P22_P_l[2 * NB_GLINT_LIGHTS];
+    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+    {
+        P22_P[k] = 0.;
+        P22_P_l[k] = 0.;
+        P22_P_l[NB_GLINT_LIGHTS + k] = 0.;
+    }
 
-    // Fresnel is set to one for simplicity
-    // but feel free to use "real" Fresnel term
-    vec3 F = vec3(1.);
+    for (int j = 0; j < fp.levelCount; ++j)
+    {
+        float P22_level[NB_GLINT_LIGHTS];
+        if (fp.cells)
+            P22__glint_discrete_LOD
+                (fp.level[j], slope_h, active, st, fp.dst0, fp.dst1, 
+                 slope_dx, slope_dy, sigmas_rho, fp.inv_lt, fp.LOD_dist[j],
+                 fp.occupancyLayer, P22_level);
+        else
+            glintBeckmann(slope_h, sigmas_rho, P22_level);
+        for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+            P22_P_l[j * NB_GLINT_LIGHTS + k] = P22_level[k];
+    }
 
-    // (wi dot wg) is cancelled by
-    // the cosine weight in the rendering equation
-    return (F * G * D_P) / (4. * wo.z);
+    if (fp.levelCount == 1)
+        for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+            P22_P[k] = P22_P_l[k];
+    else if (fp.levelCount == 2)
+        for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+            P22_P[k] = mix(P22_P_l[k], P22_P_l[NB_GLINT_LIGHTS + k], fp.w);
 }
 
+#ifndef GLINT_COMPUTE
 //=============================================================================
-//====================== Evaluate rendering equation ==========================
+//=============================== Surface =====================================
 //=============================================================================
-void main()
+// Everything the shading of a pixel needs from the mesh: rasterized and
+// textured (rasterSurface) or read from the deferred G-buffer
+struct Surface {
+    vec3  position;         // World space
+    vec3  tangent;          // Shading frame (Gram-Schmidt), world space
+    vec3  normal;
+    bool  flipEnv;          // The env map lookup is below the vertex normal
+    vec2  texCoord;         // TexCoord * ScaleUV
+    vec2  dst0, dst1;       // Its screen space derivatives
+    // Screen space derivatives of the slopes of the half vectors
+    vec2  slope_dx[NB_GLINT_LIGHTS];
+    vec2  slope_dy[NB_GLINT_LIGHTS];
+    vec3  sigmas_rho;       // Filtered roughness (LEAN mapping)
+    vec3  kd, ks;
+};
+
+// Directions of the viewer and of the lights in the shading frame of the
+// surface, and direction of the specular lookup of the env map
+void surfaceDirections(Surface s, out vec3 wo, out vec3 wi_pl, 
+                       out vec3 wi_dir, out vec3 wiWorld_env)
 {
-    if(texture(MaskTex, TexCoord * ScaleUV).x < 0.1)
-        discard;
-
-    vec3 woWorld = normalize(CameraPosition - VertexPos);
+    vec3 woWorld = normalize(CameraPosition - s.position);
 
     // Point light direction
-    vec3 wiWorld_pl  = normalize(PointLight.Position.xyz - VertexPos);
+    vec3 wiWorld_pl  = normalize(PointLight.Position.xyz - s.position);
 
     // Directional light direction
     float cosThetaDir = cos(DirLight.ThetaPhi.x);
@@ -603,13 +1233,215 @@ void main()
                             cosThetaDir,
                             sinPhiDir * sinThetaDir);
 
-    vec3 binormal = cross(VertexNorm, VertexTang);
+    vec3 binormalShWorld = cross(s.normal, s.tangent);
+
+    // Matrix for transformation to shading space
+    mat3 toShading = mat3(
+        s.tangent.x, binormalShWorld.x, s.normal.x,
+        s.tangent.y, binormalShWorld.y, s.normal.y,
+        s.tangent.z, binormalShWorld.z, s.normal.z ) ;
+
+    wiWorld_env  = normalize(reflect(-woWorld,s.normal));
+    if (s.flipEnv)
+        wiWorld_env = -wiWorld_env;
+
+    // Transform light direction and view direction to tangent space
+    wi_pl  = toShading * wiWorld_pl;
+    wi_pl = normalize(wi_pl);
+    wi_dir  = toShading * wiWorld_dir;
+    wi_dir = normalize(wi_dir);
+    //if(wi_dir.z <= 0.) wi_dir *= -1.;
+    wo = toShading * woWorld;
+    wo = normalize(wo);
+}
+
+// Glinty BRDF for NB_GLINT_LIGHTS incident directions. The ellipse, the LOD
+// and the traversal of the cells are shared by all the lights. Lights with
+// active[k] == false are not evaluated. The screen space derivatives are the
+// ones of the surface.
+void f_P(Surface s, vec3 wo, vec3 wi[NB_GLINT_LIGHTS], 
+         bool active[NB_GLINT_LIGHTS], out vec3 f[NB_GLINT_LIGHTS])
+{
+    vec3 wh[NB_GLINT_LIGHTS];
+    vec2 slope_h[NB_GLINT_LIGHTS];
+
+    glintHalfVectors(wo, wi, wh, slope_h);
+
+    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+        f[k] = vec3(0., 0., 0.);
+
+    if (!glintVisible(wo, wi, wh, active))
+        return;
+
+    GlintFootprint fp = glintFootprint(s.dst0, s.dst1, s.sigmas_rho, 
+                                       ivec2(gl_FragCoord.xy));
+
+    float P22_P[NB_GLINT_LIGHTS];
+    P22_P_footprint(fp, s.texCoord, slope_h, active, 
+                    s.slope_dx, s.slope_dy, s.sigmas_rho, P22_P);
+
+    glintBRDF(wo, wi, wh, active, P22_P, f);
+}
+
+#ifdef GLINT_RASTER
+//=============================================================================
+//======================= Texture-space glint cache ===========================
+//=============================================================================
+// Cached glint radiance of the pixel, from the finest resident level at or
+// above the level of its footprint (one texel per pixel). Requests the page
+// of the footprint level.
+vec3 glintCacheLookup(Surface s)
+{
+    // Texels of level 0 of the virtual texture of the mesh
+    float virtualSize = float(CACHE_VIRTUAL_PAGES * CACHE_PAGE_SIZE);
+    vec2 toTexels = virtualSize / MeshUVBounds.zw;
+    vec2 uvT = (s.texCoord - MeshUVBounds.xy) * toTexels;
+    float footprint = max(length(s.dst0 * toTexels), 
+                          length(s.dst1 * toTexels));
+    int requested = clamp(int(ceil(log2(max(footprint, 1e-8)))), 
+                          0, CACHE_LEVELS - 1);
+
+    for (int l = requested; l < CACHE_LEVELS; ++l)
+    {
+        vec2 uvL = uvT / float(1 << l);
+        ivec2 page = clamp(ivec2(uvL / float(CACHE_PAGE_SIZE)), ivec2(0),
+                           ivec2((CACHE_VIRTUAL_PAGES >> l) - 1));
+        if (l == requested)
+            CacheFeedback = 1u << 31 | uint(MeshIndex) << 17 
+                            | uint(l) << 14 | uint(page.y) << 7 | uint(page.x);
+
+        uint entry = texelFetch(CachePageTable, ivec3(page, MeshIndex), l).r;
+        if (entry == 0u)
+            continue;
+
+        // Bilinear filtering without leaving the page
+        int slot = int(entry) - 1;
+        ivec2 atlasPage = ivec2(slot % CACHE_ATLAS_PAGES, 
+                                slot / CACHE_ATLAS_PAGES);
+        vec2 local = clamp(uvL - vec2(page * CACHE_PAGE_SIZE), vec2(0.5),
+                           vec2(float(CACHE_PAGE_SIZE) - 0.5));
+        vec2 atlasCoord = (vec2(atlasPage * CACHE_PAGE_SIZE) + local) 
+                          / float(CACHE_ATLAS_PAGES * CACHE_PAGE_SIZE);
+        vec4 cached = textureLod(CacheAtlas, atlasCoord, 0.);
+
+        // Texels outside the UV charts have a null coverage (alpha)
+        return cached.a > 0. ? cached.rgb / cached.a : vec3(0.);
+    }
+    return vec3(0.);
+}
+#endif
+
+//=============================================================================
+//=============== Upper bound of the glinty BRDF for one light ================
+//=============================================================================
+// Conservative bound of f_P, without evaluating any cell. A cell evaluates
+// either the Beckmann distribution (farthest distribution LOD) or Equation
+// 15, which is at most Dictionary.MaxValue^2 * det(invM), and zero when the
+// transformed slope is farther than 4 standard deviations along one axis.
+// Whatever the random rotation of the cell, this is the case beyond
+// sqrt(2) * 4 * SIGMA_DICT = 4 * Dictionary.Alpha.
+float f_P_upper_bound(vec3 wo, vec3 wi, vec3 sigmas_rho)
+{
+    vec3 wh = normalize(wo + wi);
+    vec2 slope_h = vec2(-wh.x / wh.z, -wh.y / wh.z);
+
+    float P22 = non_axis_aligned_anisotropic_beckmann
+        (slope_h.x, slope_h.y, sigmas_rho.x, sigmas_rho.y, sigmas_rho.z);
+
+    // Equation 18, without the random rotation of the cells
+    float SIGMA_DICT = Dictionary.Alpha * m_i_sqrt_2;
+    float sqrt_1_rho_sqr = sqrt(1. - sigmas_rho.z * sigmas_rho.z);
+    vec3 inv_lt = vec3( SIGMA_DICT / (sigmas_rho.x * sqrt_1_rho_sqr),
+                       -SIGMA_DICT * sigmas_rho.z / (sigmas_rho.y * sqrt_1_rho_sqr),
+                        SIGMA_DICT / sigmas_rho.y);
+    vec2 slope_h_o = vec2(inv_lt.x * slope_h.x + inv_lt.y * slope_h.y,
+                          inv_lt.z * slope_h.y);
+
+    if (length(slope_h_o) <= 4. * Dictionary.Alpha)
+        P22 = max(P22, Dictionary.MaxValue * Dictionary.MaxValue 
+                       * inv_lt.x * inv_lt.z);
+
+    float G1wowh = min(1., 2. * wh.z * wo.z / dot(wo, wh));
+    float G1wiwh = min(1., 2. * wh.z * wi.z / dot(wi, wh));
+
+    return G1wowh * G1wiwh * P22 / (wh.z * wh.z * wh.z * wh.z * 4. * wo.z);
+}
+
+#ifdef GLINT_RASTER
+//=============================================================================
+//=========================== Glint G-buffer ==================================
+//=============================================================================
+// Inputs of f_P for the compute pass (see the layout of GlintGBuffer0..5).
+// The point light is light 0, the directional light light 1.
+void writeGlintGBuffer(Surface s, vec3 wo, vec3 wi[NB_GLINT_LIGHTS], 
+                       bool active[NB_GLINT_LIGHTS], float distanceSquared)
+{
+    uint lights = 0u;
+    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+        if (active[k])
+            lights |= 1u << k;
+    // The user values are material 0
+    uint material = OverrideMaterials ? 0u : uint(MeshIndex + 1);
+
+    GlintGBuffer0 = uvec4(floatBitsToUint(s.texCoord), 
+                          floatBitsToUint(s.dst0));
+    GlintGBuffer1 = uvec4(floatBitsToUint(s.dst1), 
+                          packHalf2x16(s.sigmas_rho.xy),
+                          packHalf2x16(vec2(s.sigmas_rho.z, 0.)) | material << 16);
+    GlintGBuffer2 = uvec4(floatBitsToUint(wo), 
+                          lights | packHalf2x16(vec2(s.ks.b, 0.)) << 16);
+    GlintGBuffer3 = uvec4(floatBitsToUint(wi[0]), 
+                          floatBitsToUint(distanceSquared));
+    GlintGBuffer4 = uvec4(floatBitsToUint(wi[1]), packHalf2x16(s.ks.rg));
+    GlintGBuffer5 = uvec4(packHalf2x16(s.slope_dx[0]), packHalf2x16(s.slope_dy[0]),
+                          packHalf2x16(s.slope_dx[1]), packHalf2x16(s.slope_dy[1]));
+}
+
+// Surface for the deferred shading pass (see the deferred G-buffer layout)
+void writeDeferredGBuffer(Surface s)
+{
+    float logMicrofacetDensity = OverrideMaterials ? 
+        UserGlint.LogMicrofacetDensity : MaterialGlint.LogMicrofacetDensity;
+    uint flags = DEFERRED_COVERED | (s.flipEnv ? DEFERRED_FLIP_ENV : 0u);
+
+    GlintGBuffer0 = uvec4(floatBitsToUint(s.position), 
+                          floatBitsToUint(s.texCoord.x));
+    GlintGBuffer1 = uvec4(floatBitsToUint(s.tangent), 
+                          floatBitsToUint(s.texCoord.y));
+    GlintGBuffer2 = uvec4(floatBitsToUint(s.normal), 
+                          floatBitsToUint(logMicrofacetDensity));
+    GlintGBuffer3 = uvec4(packHalf2x16(s.dst0), packHalf2x16(s.dst1),
+                          packHalf2x16(s.sigmas_rho.xy),
+                          packHalf2x16(vec2(s.sigmas_rho.z, 0.)) | flags << 16);
+    GlintGBuffer4 = uvec4(packHalf2x16(s.kd.rg), 
+                          packHalf2x16(vec2(s.kd.b, s.ks.r)),
+                          packHalf2x16(s.ks.gb),
+                          floatBitsToUint(glintMicrofacetRelativeArea()));
+    GlintGBuffer5 = uvec4(packHalf2x16(s.slope_dx[0]), packHalf2x16(s.slope_dy[0]),
+                          packHalf2x16(s.slope_dx[1]), packHalf2x16(s.slope_dy[1]));
+}
+
+//=============================================================================
+//========================== Rasterized surface ===============================
+//=============================================================================
+// Shading frame, normal map filtering, reflectances and screen space
+// derivatives of the fragment. Must be called in uniform control flow.
+Surface rasterSurface(vec2 texCoord, vec3 vertexPos, vec3 vertexNorm,
+                      vec3 vertexTang)
+{
+    Surface s;
+    s.position = vertexPos;
+    s.texCoord = texCoord * ScaleUV;
+
+    vec3 woWorld = normalize(CameraPosition - vertexPos);
+
+    vec3 binormal = cross(vertexNorm, vertexTang);
 
     // Matrix for transformation to tangent space
     mat3 toLocal = mat3(
-        VertexTang.x, binormal.x, VertexNorm.x,
-        VertexTang.y, binormal.y, VertexNorm.y,
-        VertexTang.z, binormal.z, VertexNorm.z ) ;
+        vertexTang.x, binormal.x, vertexNorm.x,
+        vertexTang.y, binormal.y, vertexNorm.y,
+        vertexTang.z, binormal.z, vertexNorm.z ) ;
 
     mat3 toWorld = inverse(toLocal);
 
@@ -618,12 +1450,12 @@ void main()
 
     if(UseBump){
         if(ComputeReference){
-            first_order_moment = textureLod(SlopeTex,TexCoord * ScaleUV, 0.).xy;
-            second_order_moment = textureLod(SecondMomentTex,TexCoord * ScaleUV, 0.).xyz;
+            first_order_moment = textureLod(SlopeTex,texCoord * ScaleUV, 0.).xy;
+            second_order_moment = textureLod(SecondMomentTex,texCoord * ScaleUV, 0.).xyz;
         }
         else{
-            first_order_moment = texture(SlopeTex,TexCoord * ScaleUV).xy;
-            second_order_moment = texture(SecondMomentTex,TexCoord * ScaleUV).xyz;
+            first_order_moment = texture(SlopeTex,texCoord * ScaleUV).xy;
+            second_order_moment = texture(SecondMomentTex,texCoord * ScaleUV).xyz;
         }
     } else {
         first_order_moment = vec2(0.);
@@ -641,27 +1473,14 @@ void main()
 
     // Gram-Schmidt process (orthogolize shading frame)
     vec3 tangShWorld = 
-        normalize(VertexTang - (dot(normalWorld,VertexTang) /
+        normalize(vertexTang - (dot(normalWorld,vertexTang) /
                   dot(normalWorld,normalWorld)) * normalWorld);
 
-    vec3 binormalShWorld = cross(normalWorld, tangShWorld);
-
-    // Matrix for transformation to shading space
-    mat3 toShading = mat3(
-        tangShWorld.x, binormalShWorld.x, normalWorld.x,
-        tangShWorld.y, binormalShWorld.y, normalWorld.y,
-        tangShWorld.z, binormalShWorld.z, normalWorld.z ) ;
+    s.tangent = tangShWorld;
+    s.normal = normalWorld;
 
     vec3 wiWorld_env  = normalize(reflect(-woWorld,normalWorld));
-
-    // Transform light direction and view direction to tangent space
-    vec3 wi_pl  = toShading * wiWorld_pl;
-    wi_pl = normalize(wi_pl);
-    vec3 wi_dir  = toShading * wiWorld_dir;
-    wi_dir = normalize(wi_dir);
-    //if(wi_dir.z <= 0.) wi_dir *= -1.;
-    vec3 wo = toShading * woWorld;
-    wo = normalize(wo);
+    s.flipEnv = dot(vertexNorm,wiWorld_env) < 0.;
 
     //=========================================================================
     //====================== Retrieve material information ====================
@@ -737,26 +1556,428 @@ void main()
     sigma_x = clamp(sigma_x, 0.01, 1.);
     sigma_y = clamp(sigma_y, 0.01, 1.);
     rho = clamp(rho, -0.99, 0.99);
+    s.sigmas_rho = vec3(sigma_x, sigma_y, rho);
 
     //=========================================================================
     //============== Retrieve diffuse and specular coefficients ===============
     //=========================================================================
 
     // Retrieve diffuse coeff
-    vec3 kd;
     if(UseDiffuseTex)
-        kd = texture(DiffuseTex, TexCoord * ScaleUV).rgb;
+        s.kd = texture(DiffuseTex, texCoord * ScaleUV).rgb;
     else
-        kd = Kd;
+        s.kd = Kd;
     // From perceptual to linear space (inverse gamma function)
-    kd = pow( kd, vec3(2.2) );
+    s.kd = pow( s.kd, vec3(2.2) );
 
     // Retrieve specular coeff
-    vec3 ks;
     if(UseSpecularTex)
-        ks = texture(SpecularTex, TexCoord * ScaleUV).xyz;
+        s.ks = texture(SpecularTex, texCoord * ScaleUV).xyz;
     else 
-        ks = Ks;
+        s.ks = Ks;
+
+    //=========================================================================
+    //=================== Derivatives of the glinty BRDF ======================
+    //=========================================================================
+    vec3 wo, wi_pl, wi_dir;
+    surfaceDirections(s, wo, wi_pl, wi_dir, wiWorld_env);
+
+    vec3 wi_glint[NB_GLINT_LIGHTS] = vec3[NB_GLINT_LIGHTS](wi_pl, wi_dir);
+    vec3 wh[NB_GLINT_LIGHTS];
+    vec2 slope_h[NB_GLINT_LIGHTS];
+    glintHalfVectors(wo, wi_glint, wh, slope_h);
+    glintDerivatives(wh, slope_h, s.slope_dx, s.slope_dy, s.dst0, s.dst1);
+    return s;
+}
+#endif // GLINT_RASTER
+
+#ifdef GLINT_DEFERRED
+// Surface of the pixel, false on the background
+bool readDeferredGBuffer(ivec2 pixel, out Surface s)
+{
+    uvec4 g0 = texelFetch(GlintGBufferTex[0], pixel, 0);
+    uvec4 g1 = texelFetch(GlintGBufferTex[1], pixel, 0);
+    uvec4 g2 = texelFetch(GlintGBufferTex[2], pixel, 0);
+    uvec4 g3 = texelFetch(GlintGBufferTex[3], pixel, 0);
+    uvec4 g4 = texelFetch(GlintGBufferTex[4], pixel, 0);
+    uvec4 g5 = texelFetch(GlintGBufferTex[5], pixel, 0);
+
+    uint flags = g3.w >> 16;
+    s.position = uintBitsToFloat(g0.xyz);
+    s.tangent = uintBitsToFloat(g1.xyz);
+    s.normal = uintBitsToFloat(g2.xyz);
+    s.flipEnv = (flags & DEFERRED_FLIP_ENV) != 0u;
+    s.texCoord = uintBitsToFloat(uvec2(g0.w, g1.w));
+    s.dst0 = unpackHalf2x16(g3.x);
+    s.dst1 = unpackHalf2x16(g3.y);
+    s.sigmas_rho = vec3(unpackHalf2x16(g3.z), unpackHalf2x16(g3.w & 0xffffu).x);
+    vec2 kd_b_ks_r = unpackHalf2x16(g4.y);
+    s.kd = vec3(unpackHalf2x16(g4.x), kd_b_ks_r.x);
+    s.ks = vec3(kd_b_ks_r.y, unpackHalf2x16(g4.z));
+    s.slope_dx[0] = unpackHalf2x16(g5.x);
+    s.slope_dy[0] = unpackHalf2x16(g5.y);
+    s.slope_dx[1] = unpackHalf2x16(g5.z);
+    s.slope_dy[1] = unpackHalf2x16(g5.w);
+
+    glintLogMicrofacetDensity = uintBitsToFloat(g2.w);
+    glintRelativeArea = uintBitsToFloat(g4.w);
+    return (flags & DEFERRED_COVERED) != 0u;
+}
+#endif
+
+#ifdef GLINT_CLUSTERED_LIGHTS
+//=============================================================================
+//========================= Clustered point lights ============================
+//=============================================================================
+// Diffuse and glint radiance of the lights of the froxel of the pixel. The
+// lights go by pairs through f_P: one traversal of the footprint for two
+// lights. A per-pixel list of lights is not in uniform control flow, the
+// screen space derivatives of their half vector slopes are the ones of the
+// point light: for small sources the variation of the slopes over the
+// pixel comes mostly from wo and the normal map.
+void shadeClusteredLights(Surface s, vec3 wo, 
+                          out vec3 radiance_diffuse, out vec3 radiance_specular)
+{
+    radiance_diffuse = vec3(0.);
+    radiance_specular = vec3(0.);
+    if (wo.z <= 0.)
+        return;
+
+    vec3 binormal = cross(s.normal, s.tangent);
+    mat3 toShading = mat3(
+        s.tangent.x, binormal.x, s.normal.x,
+        s.tangent.y, binormal.y, s.normal.y,
+        s.tangent.z, binormal.z, s.normal.z);
+
+    ivec2 tile = min(ivec2(gl_FragCoord.xy * ClusterTileScale), ClusterTiles - 1);
+    float depth = -(ClusterView * vec4(s.position, 1.)).z;
+    int slice = int(floor(log(max(depth, 1e-6)) * ClusterSliceScaleBias.x 
+                          - ClusterSliceScaleBias.y));
+    slice = clamp(slice, 0, ClusterSlices - 1);
+    int base = (tile.x + ClusterTiles.x * (tile.y + ClusterTiles.y * slice))
+             * (1 + MaxLightsPerCluster);
+    int count = int(clusterList[base]);
+
+    Surface sc = s;
+    for (int k = 1; k < NB_GLINT_LIGHTS; ++k)
+    {
+        sc.slope_dx[k] = s.slope_dx[0];
+        sc.slope_dy[k] = s.slope_dy[0];
+    }
+    float ks_max = max(s.ks.x, max(s.ks.y, s.ks.z));
+
+    for (int first = 0; first < count; first += NB_GLINT_LIGHTS)
+    {
+        vec3 wi[NB_GLINT_LIGHTS];
+        vec3 Li[NB_GLINT_LIGHTS];
+        bool active[NB_GLINT_LIGHTS];
+        bool any_active = false;
+        for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+        {
+            wi[k] = vec3(0., 0., 1.);
+            Li[k] = vec3(0.);
+            active[k] = false;
+            if (first + k >= count)
+                continue;
+
+            ClusterLight light = clusterLights[clusterList[base + 1 + first + k]];
+            vec3 d = light.PositionRadius.xyz - s.position;
+            float distanceSquared = dot(d, d);
+            if (distanceSquared >= light.PositionRadius.w * light.PositionRadius.w)
+                continue;
+            wi[k] = normalize(toShading * d);
+            if (wi[k].z <= 0.)
+                continue;
+            Li[k] = light.L.rgb / distanceSquared;
+
+            radiance_diffuse += (s.kd / m_pi) * wi[k].z * 0.5 * Li[k];
+
+            active[k] = ks_max > 0.;
+            if (active[k] && GlintCullRadiance > 0.)
+            {
+                float Li_max = max(Li[k].x, max(Li[k].y, Li[k].z));
+                active[k] = ks_max * 0.5 * Li_max 
+                    * f_P_upper_bound(wo, wi[k], s.sigmas_rho) >= GlintCullRadiance;
+            }
+            any_active = any_active || active[k];
+        }
+
+        if (!any_active)
+            continue;
+        vec3 f[NB_GLINT_LIGHTS];
+        f_P(sc, wo, wi, active, f);
+        for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+            if (active[k])
+                radiance_specular += s.ks * f[k] * 0.5 * Li[k];
+    }
+}
+#endif
+
+//=============================================================================
+//============================== Area light ===================================
+//=============================================================================
+// The rectangle is its 4 corners, the disk a regular octagon. Clipped to
+// the horizon, the polygon has at most one more vertex.
+#define AREA_LIGHT_MAX_VERTICES 8
+#define AREA_LIGHT_CLIPPED_VERTICES (AREA_LIGHT_MAX_VERTICES + 1)
+
+// Part of the convex polygon v of unit directions above the horizon, as in
+// glint::clipToHorizon. Returns its vertex count, 0 below the horizon.
+int clipToHorizon(vec3 v[AREA_LIGHT_CLIPPED_VERTICES], int n,
+                  out vec3 clipped[AREA_LIGHT_CLIPPED_VERTICES])
+{
+    int m = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        vec3 a = v[i];
+        vec3 b = v[(i + 1) % n];
+        if (a.z > 0.)
+            clipped[m++] = a;
+        // The great arc from a to b is the normalized segment
+        if ((a.z > 0.) != (b.z > 0.))
+            clipped[m++] = normalize(mix(a, b, a.z / (a.z - b.z)));
+    }
+    return m < 3 ? 0 : m;
+}
+
+// Solid angle of the convex polygon of unit directions, as a fan of
+// spherical triangles (Van Oosterom and Strackee 1983)
+float polygonSolidAngle(vec3 v[AREA_LIGHT_CLIPPED_VERTICES], int n)
+{
+    float solidAngle = 0.;
+    for (int i = 1; i + 1 < n; ++i)
+    {
+        float numerator = abs(dot(v[0], cross(v[i], v[i + 1])));
+        float denominator = 1. + dot(v[0], v[i]) + dot(v[i], v[i + 1])
+                          + dot(v[i + 1], v[0]);
+        solidAngle += 2. * atan(numerator, denominator);
+    }
+    return solidAngle;
+}
+
+// Ellipse of a 2x2 covariance (xx, xy, yy), as two axes d0 and d1 with
+// C = d0 d0^T + d1 d1^T
+void covarianceAxes(vec3 C, out vec2 d0, out vec2 d1)
+{
+    float m = 0.5 * (C.x + C.z);
+    float r = sqrt(max(m * m - (C.x * C.z - C.y * C.y), 0.));
+    float l0 = m + r;
+    float l1 = max(m - r, 0.);
+    vec2 e0 = abs(C.y) > 1e-12 ? normalize(vec2(C.y, l0 - C.x))
+            : (C.x >= C.z ? vec2(1., 0.) : vec2(0., 1.));
+    d0 = sqrt(l0) * e0;
+    d1 = sqrt(l1) * vec2(-e0.y, e0.x);
+}
+
+// Diffuse and glint radiance of the area light (see glint/arealight.h).
+// The polygon of the light is first clipped to the horizon. The diffuse
+// part is the edge integral of the clamped cosine over the clipped polygon
+// (a linearly transformed cosine with the identity transform).
+//
+// The glint part is a centroid/covariance approximation, at the cost of one
+// point light: the half vectors of the vertices of the clipped polygon are
+// projected in slope space, where the area, the centroid and the covariance
+// of the polygon are its first moments (Green's theorem). The BRDF is
+// evaluated at the centroid, with the dictionary lookups filtered over the
+// covariance added to the pixel footprint, and weighted by the solid angle
+// of the polygon. It is not an integral of the cells over the light:
+// test_arealight measures its error against many point lights. The screen
+// space derivatives are the ones of the point light.
+void shadeAreaLightCentroid(Surface s, vec3 wo,
+                            out vec3 radiance_diffuse,
+                            out vec3 radiance_specular)
+{
+    radiance_diffuse = vec3(0.);
+    radiance_specular = vec3(0.);
+
+    vec3 toLight = AreaLight.Position - s.position;
+    vec3 normal_l = normalize(cross(AreaLight.U, AreaLight.V));
+    if (wo.z <= 0. || dot(normal_l, toLight) >= 0.)
+        return;
+
+    vec3 binormal = cross(s.normal, s.tangent);
+    mat3 toShading = mat3(
+        s.tangent.x, binormal.x, s.normal.x,
+        s.tangent.y, binormal.y, s.normal.y,
+        s.tangent.z, binormal.z, s.normal.z);
+
+    int n0 = AreaLight.Shape == 1 ? 4 : AREA_LIGHT_MAX_VERTICES;
+    vec3 v0[AREA_LIGHT_CLIPPED_VERTICES];
+    for (int i = 0; i < AREA_LIGHT_MAX_VERTICES; ++i)
+    {
+        float phi = AreaLight.Shape == 1 ? m_pi * (0.25 + 0.5 * float(i))
+                                         : 2. * m_pi * float(i) / float(n0);
+        // The corners of the rectangle are at +-U +-V, the octagon has the
+        // area of the disk: pi = 2 sqrt(2) scale^2
+        float scale = AreaLight.Shape == 1 ? sqrt(2.) : 1.0539;
+        vec3 p = toLight + scale * (cos(phi) * AreaLight.U + sin(phi) * AreaLight.V);
+        v0[i] = normalize(toShading * p);
+    }
+
+    // Part of the light above the horizon
+    vec3 v[AREA_LIGHT_CLIPPED_VERTICES];
+    int n = clipToHorizon(v0, n0, v);
+    if (n == 0)
+        return;
+
+    // Form factor of the polygon
+    float formFactor = 0.;
+    for (int i = 0; i < n; ++i)
+    {
+        vec3 a = v[i];
+        vec3 b = v[(i + 1) % n];
+        vec3 c = cross(a, b);
+        float len = length(c);
+        if (len > 1e-7)
+            formFactor += atan(len, dot(a, b)) * c.z / len;
+    }
+    formFactor = abs(formFactor) / (2. * m_pi);
+
+    radiance_diffuse = s.kd * formFactor * 0.5 * AreaLight.L;
+
+    if (s.ks.x == 0. && s.ks.y == 0. && s.ks.z == 0.)
+        return;
+
+    // Moments of the polygon of the half vectors in slope space
+    float A = 0.;
+    vec2 M1 = vec2(0.);
+    vec3 M2 = vec3(0.);
+    vec2 p0 = vec2(0.);
+    for (int i = 0; i <= n; ++i)
+    {
+        vec3 h = normalize(wo + v[i % n]);
+        vec2 p1 = -h.xy / max(h.z, 1e-4);
+        if (i > 0)
+        {
+            float c = p0.x * p1.y - p1.x * p0.y;
+            A += c;
+            M1 += (p0 + p1) * c;
+            M2 += vec3(p0.x * p0.x + p0.x * p1.x + p1.x * p1.x,
+                       2. * p0.x * p0.y + p0.x * p1.y + p1.x * p0.y + 2. * p1.x * p1.y,
+                       p0.y * p0.y + p0.y * p1.y + p1.y * p1.y) * c;
+        }
+        p0 = p1;
+    }
+
+    // Light seen edge-on in slope space: a point light at its center
+    vec2 slope_c;
+    vec3 C = vec3(0.);
+    if (abs(A) > 1e-8)
+    {
+        A *= 0.5;
+        slope_c = M1 / (6. * A);
+        C = M2 * vec3(1. / 12., 1. / 24., 1. / 12.) / A 
+            - vec3(slope_c.x * slope_c.x, slope_c.x * slope_c.y, slope_c.y * slope_c.y);
+    }
+    else
+    {
+        vec3 center = vec3(0.);
+        for (int i = 0; i < n; ++i)
+            center += v[i];
+        vec3 h = normalize(wo + normalize(center));
+        slope_c = -h.xy / h.z;
+    }
+
+    // Incident direction of the centroid
+    vec3 wh = normalize(vec3(-slope_c, 1.));
+    vec3 wi[NB_GLINT_LIGHTS];
+    bool active[NB_GLINT_LIGHTS];
+    for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+    {
+        wi[k] = 2. * dot(wo, wh) * wh - wo;
+        active[k] = k == 0;
+    }
+
+    // A box of width w has a variance of w^2 / 12
+    Surface sa = s;
+    vec2 d0 = s.slope_dx[0];
+    vec2 d1 = s.slope_dy[0];
+    C.xz = max(C.xz, vec2(0.));
+    vec3 C_filter = vec3(d0.x * d0.x + d1.x * d1.x, d0.x * d0.y + d1.x * d1.y,
+                         d0.y * d0.y + d1.y * d1.y) + 12. * C;
+    covarianceAxes(C_filter, sa.slope_dx[0], sa.slope_dy[0]);
+
+    vec3 f[NB_GLINT_LIGHTS];
+    f_P(sa, wo, wi, active, f);
+
+    radiance_specular = s.ks * f[0] * 0.5 * AreaLight.L
+                      * polygonSolidAngle(v, n);
+}
+
+//=============================================================================
+//====================== Evaluate rendering equation ==========================
+//=============================================================================
+vec4 shade(Surface s)
+{
+    vec3 wo, wi_pl, wi_dir, wiWorld_env;
+    surfaceDirections(s, wo, wi_pl, wi_dir, wiWorld_env);
+
+    vec3 normalWorld = s.normal;
+    float sigma_x = s.sigmas_rho.x;
+    float sigma_y = s.sigmas_rho.y;
+    vec3 kd = s.kd;
+    vec3 ks = s.ks;
+
+    //=========================================================================
+    //================= Glinty BRDF, all lights in one traversal ==============
+    //=========================================================================
+    float distanceSquared = distance(s.position, PointLight.Position.xyz);
+    distanceSquared *= distanceSquared;
+    vec3 Li = PointLight.L / distanceSquared;
+    vec3 Li_dir = DirLight.L;
+
+    vec3 wi_glint[NB_GLINT_LIGHTS] = vec3[NB_GLINT_LIGHTS](wi_pl, wi_dir);
+    bool glint_lights[NB_GLINT_LIGHTS] = bool[NB_GLINT_LIGHTS](
+        !(wo.z <= 0. || wi_pl.z <= 0. || (ks.x == 0. && ks.y == 0. && ks.z == 0.)
+          || dot(Li,Li) == 0.f),
+        wi_dir.z > 0.f && wo.z > 0.f && (ks.x != 0. || ks.y != 0. && ks.z != 0.)
+        && dot(Li_dir,Li_dir) != 0.f);
+
+    // The glints of the lights come from the cache
+    vec3 radiance_specular_cache = vec3(0.);
+#ifdef GLINT_RASTER
+    if (CacheMode == 1)
+    {
+        radiance_specular_cache = glintCacheLookup(s);
+        for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+            glint_lights[k] = false;
+    }
+#endif
+
+    // Skip the lights that can't contribute perceptibly
+    if (GlintCullRadiance > 0.)
+    {
+        vec3 Li_glint[NB_GLINT_LIGHTS] = vec3[NB_GLINT_LIGHTS](Li, Li_dir);
+        float ks_max = max(ks.x, max(ks.y, ks.z));
+        for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+        {
+            if (!glint_lights[k])
+                continue;
+            float Li_max = max(Li_glint[k].x, max(Li_glint[k].y, Li_glint[k].z));
+            float bound = ks_max * 0.5 * Li_max 
+                * f_P_upper_bound(wo, wi_glint[k], s.sigmas_rho);
+            if (bound < GlintCullRadiance)
+                glint_lights[k] = false;
+        }
+    }
+
+#ifdef GLINT_RASTER
+    // The glints of the lights are added by the compute pass
+    if (GlintEvaluation == 1)
+    {
+        writeGlintGBuffer(s, wo, wi_glint, glint_lights, distanceSquared);
+        for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+            glint_lights[k] = false;
+    }
+#else
+    // The glints of the lights are shaded at a reduced resolution
+    if (DeferredTerms == 1)
+        for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+            glint_lights[k] = false;
+#endif
+
+    vec3 f_glint[NB_GLINT_LIGHTS];
+    f_P(s, wo, wi_glint, glint_lights, f_glint);
 
     //=========================================================================
     //============================= Point light ===============================
@@ -765,22 +1986,15 @@ void main()
     vec3 radiance_diffuse_pl = vec3(0);
     vec3 radiance_pl = vec3(0);
     
-    float distanceSquared = distance(VertexPos, PointLight.Position.xyz);
-    distanceSquared *= distanceSquared;
-    vec3 Li = PointLight.L / distanceSquared;
-    
     // Diffuse part
     radiance_diffuse_pl = (kd / m_pi) * wi_pl.z;
     if(wo.z <= 0. || wi_pl.z <= 0.)
         radiance_diffuse_pl = vec3(0.);
 
     // Specular part
-    if(wo.z <= 0. || wi_pl.z <= 0. || (ks.x == 0. && ks.y == 0. && ks.z == 0.)
-        || dot(Li,Li) == 0.f)
-        radiance_specular_pl = vec3(0.);
-    else
+    if(glint_lights[0])
         // Compute specular radiance
-        radiance_specular_pl = ks * f_P(wo, wi_pl, vec3(sigma_x, sigma_y, rho));
+        radiance_specular_pl = ks * f_glint[0];
 
     radiance_pl = (radiance_diffuse_pl + radiance_specular_pl) * 0.5 * Li;
 
@@ -791,17 +2005,15 @@ void main()
     vec3 radiance_diffuse_dir = vec3(0);
     vec3 radiance_dir = vec3(0);
     
-    vec3 Li_dir = DirLight.L;
-    
     // Diffuse part
     radiance_diffuse_dir = (kd / m_pi) * wi_dir.z;
     if(wo.z <= 0. || wi_dir.z <= 0.)
         radiance_diffuse_dir = vec3(0.);
 
     // Specular part
-    if(wi_dir.z > 0.f && wo.z > 0.f && (ks.x != 0. || ks.y != 0. && ks.z != 0.)){
+    if(glint_lights[1]){
         // Compute specular radiance
-        radiance_specular_dir = ks * f_P(wo, wi_dir, vec3(sigma_x, sigma_y, rho));
+        radiance_specular_dir = ks * f_glint[1];
     }
 
     radiance_dir = (radiance_diffuse_dir + radiance_specular_dir) * 0.5 * Li_dir;
@@ -817,9 +2029,6 @@ void main()
     if(UseEnvMap){
         float lod = lod_from_roughness(vec2(sigma_x, sigma_y));
 
-        if(dot(VertexNorm,wiWorld_env) < 0.)
-            wiWorld_env = -wiWorld_env;
-
         radiance_specular_env = textureLod(EnvMap, wiWorld_env, lod).xyz;
         radiance_diffuse_env = textureLod(EnvMap, normalWorld, 6.).xyz;
         radiance_env = (kd * radiance_diffuse_env + ks * radiance_specular_env)
@@ -827,14 +2036,167 @@ void main()
 
     } else
         radiance_env = vec3(0.);
+
+    //=========================================================================
+    //========================= Clustered point lights ========================
+    //=========================================================================
+    vec3 radiance_diffuse_clustered = vec3(0.);
+    vec3 radiance_specular_clustered = vec3(0.);
+#ifdef GLINT_CLUSTERED_LIGHTS
+    // Not in the pages of the glint cache nor in the reduced resolution
+    // glints of the deferred pass
+    bool clustered = CacheMode != 2;
+#ifdef GLINT_DEFERRED
+    clustered = clustered && DeferredTerms != 2;
+#endif
+    if (clustered)
+        shadeClusteredLights(s, wo, radiance_diffuse_clustered, 
+                             radiance_specular_clustered);
+#endif
+
+    //=========================================================================
+    //============================== Area light ===============================
+    //=========================================================================
+    vec3 radiance_diffuse_area = vec3(0.);
+    vec3 radiance_specular_area = vec3(0.);
+    // Not in the pages of the glint cache nor in the reduced resolution
+    // glints of the deferred pass
+    bool area = AreaLight.Shape != 0 && CacheMode != 2;
+#ifdef GLINT_DEFERRED
+    area = area && DeferredTerms != 2;
+#endif
+    if (area)
+        shadeAreaLightCentroid(s, wo, radiance_diffuse_area,
+                               radiance_specular_area);
     
     //=========================================================================
     //==================== Addition all incomming radiance ====================
     //=========================================================================
     
     // !Gamma correction and tone mapping is done during the post processing.!
-    FragColor = vec4(radiance_env + radiance_dir + radiance_pl, 1);
+    vec4 color = vec4(radiance_env + radiance_dir + radiance_pl 
+                      + radiance_specular_cache + radiance_diffuse_clustered
+                      + radiance_specular_clustered + radiance_diffuse_area
+                      + radiance_specular_area, 1);
     if(OnlySpecular)
-        FragColor = vec4(radiance_specular_dir * 0.5 * Li_dir 
-                         + radiance_specular_pl * 0.5 * Li, 1);
+        color = vec4(radiance_specular_dir * 0.5 * Li_dir 
+                     + radiance_specular_pl * 0.5 * Li 
+                     + radiance_specular_cache + radiance_specular_clustered
+                     + radiance_specular_area, 1);
+    // Heat map of the number of cells, 128 cells and more is white
+    if(CellCountView != 0){
+        int nbrOfCells = CellCountView == 1 ? nbrOfBoundingBoxCells
+                                            : nbrOfVisitedCells;
+        float heat = min(float(nbrOfCells) / 128., 1.);
+        color = vec4(heat, heat * heat, heat * heat * heat, 1);
+    }
+    // Page of the glint cache: glints of the lights only, alpha = coverage
+    if(CacheMode == 2)
+        color = vec4(radiance_specular_dir * 0.5 * Li_dir 
+                     + radiance_specular_pl * 0.5 * Li, 1);
+#ifdef GLINT_DEFERRED
+    if(DeferredTerms == 2)
+        color = vec4(radiance_specular_dir * 0.5 * Li_dir 
+                     + radiance_specular_pl * 0.5 * Li, 1);
+#endif
+    return color;
+}
+
+#ifdef GLINT_RASTER
+// Reference shaded at ReferenceSubsamples^2 stratified subpixel positions.
+// The interpolated attributes are moved to each subsample to first order
+// in the barycentrics, with their screen space derivatives, and the
+// shading frame, normal map and glint derivatives are derived again there.
+// The footprint stays the one of the pixel, as with the jittered passes of
+// the reference. Silhouettes are only resolved by the passes. The loop
+// count is uniform, so the derivatives of rasterSurface stay defined.
+vec4 shadeSubsamples()
+{
+    vec2 texCoord_dx = dFdx(TexCoord);
+    vec2 texCoord_dy = dFdy(TexCoord);
+    vec3 pos_dx  = dFdx(VertexPos);
+    vec3 pos_dy  = dFdy(VertexPos);
+    vec3 norm_dx = dFdx(VertexNorm);
+    vec3 norm_dy = dFdy(VertexNorm);
+    vec3 tang_dx = dFdx(VertexTang);
+    vec3 tang_dy = dFdy(VertexTang);
+
+    float n = float(ReferenceSubsamples);
+    vec4 color = vec4(0.);
+    for (int j = 0; j < ReferenceSubsamples; ++j)
+        for (int i = 0; i < ReferenceSubsamples; ++i)
+        {
+            vec2 o = ((vec2(i, j) + 0.5) / n - 0.5) * ReferenceCellSize;
+            Surface s = rasterSurface(
+                TexCoord   + o.x * texCoord_dx + o.y * texCoord_dy,
+                VertexPos  + o.x * pos_dx      + o.y * pos_dy,
+                VertexNorm + o.x * norm_dx     + o.y * norm_dy,
+                VertexTang + o.x * tang_dx     + o.y * tang_dy);
+            color += shade(s);
+        }
+    return color / (n * n);
+}
+
+void main()
+{
+    CacheFeedback = 0u;
+
+#ifndef GLINT_DEPTH_PREPASS
+    if(texture(MaskTex, TexCoord * ScaleUV).x < 0.1)
+        discard;
+#endif
+
+    // Whole tiles, hence whole quads: the derivatives stay defined
+    if (ReferenceAdaptive && texelFetch(ReferenceTileTex,
+            ivec2(gl_FragCoord.xy) / ReferenceTileSize, 0).x == 0.)
+        discard;
+
+    // Deferred shading: the pixel is shaded once, by the fullscreen pass
+    if (GlintEvaluation == 2)
+    {
+        Surface s = rasterSurface(TexCoord, VertexPos, VertexNorm, VertexTang);
+        writeDeferredGBuffer(s);
+        FragColor = vec4(0.);
+        return;
+    }
+
+    // Uniform branches: the derivatives of rasterSurface stay defined
+    if (ReferenceSubsamples > 1)
+    {
+        FragColor = shadeSubsamples();
+    }
+    else
+    {
+        Surface s = rasterSurface(TexCoord, VertexPos, VertexNorm, VertexTang);
+        FragColor = shade(s);
+    }
+}
+#else
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    // The reduced resolution pixel is shaded at its central pixel, with
+    // the footprint of the GlintScale x GlintScale pixels
+    if (DeferredTerms == 2)
+        pixel = min(pixel * GlintScale + GlintScale / 2, 
+                    textureSize(GlintGBufferTex[0], 0) - 1);
+
+    Surface s;
+    if (!readDeferredGBuffer(pixel, s))
+        discard;
+
+    if (DeferredTerms == 2)
+    {
+        s.dst0 *= float(GlintScale);
+        s.dst1 *= float(GlintScale);
+        for (int k = 0; k < NB_GLINT_LIGHTS; ++k)
+        {
+            s.slope_dx[k] *= float(GlintScale);
+            s.slope_dy[k] *= float(GlintScale);
+        }
+    }
+
+    FragColor = shade(s);
 }
+#endif
+#endif // GLINT_COMPUTE
@@ -27,6 +27,16 @@ out vec3 VertexTang;
 uniform mat4 ModelMatrix;
 uniform mat4 MVP;
 
+// Same depth as the depth prepass (also drawn with this shader): the glint
+// pass is depth tested with GL_EQUAL
+invariant gl_Position;
+
+// Texture-space shading of the glint radiance cache (CacheMode 2): the mesh
+// is rasterized in its UV space, into one page of the cache atlas
+uniform int  CacheMode;
+uniform vec4 CachePageTransform;   // Scaled UV * xy + zw = clip space
+uniform vec2 ScaleUV = vec2(1.);
+
 void main() {
 
     // Transform normal and tangent to world space
@@ -40,4 +50,7 @@ void main() {
     VertexPos = (ModelMatrix * vec4(VertexPosition, 1.)).xyz;
 
     gl_Position = MVP * vec4(VertexPosition,1.0);
+    if (CacheMode == 2)
+        gl_Position = vec4(VertexTexCoord * ScaleUV * CachePageTransform.xy 
+                           + CachePageTransform.zw, 0., 1.);
 }
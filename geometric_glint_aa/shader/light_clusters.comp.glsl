@@ -0,0 +1,94 @@
+#version 430
+
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Light lists of the froxels of the clustered forward lighting
+// (glint/lightclusters.h). One invocation per froxel: the view space box of
+// the froxel is tested against the sphere of influence of every light, the
+// lights being loaded in view space by the work group, 64 at a time.
+
+layout(local_size_x = 64) in;
+
+struct ClusterLight {
+    vec4 PositionRadius;    // World position, radius of influence
+    vec4 L;                 // Intensity
+};
+
+layout(std430, binding = 5) readonly buffer ClusterLightBuffer {
+    ClusterLight clusterLights[];
+};
+
+// Per froxel: number of lights, then MaxLightsPerCluster indices
+layout(std430, binding = 6) writeonly buffer ClusterListBuffer {
+    uint clusterList[];
+};
+
+uniform mat4 View;
+uniform mat4 InvProjection;
+uniform ivec2 ClusterTiles;
+uniform int ClusterSlices;
+uniform int MaxLightsPerCluster;
+uniform float ClusterNear;
+uniform float ClusterFar;
+uniform int LightCount;
+
+shared vec4 sharedLights[64];   // View space position, radius
+
+void main()
+{
+    int clusterCount = ClusterTiles.x * ClusterTiles.y * ClusterSlices;
+    int c = int(gl_GlobalInvocationID.x);
+    bool active = c < clusterCount;
+
+    // View space bounding box of the froxel: the corners of the tile on
+    // the near plane, scaled to the two depths of the slice
+    ivec3 id = ivec3(c % ClusterTiles.x, (c / ClusterTiles.x) % ClusterTiles.y,
+                     c / (ClusterTiles.x * ClusterTiles.y));
+    float z0 = ClusterNear * pow(ClusterFar / ClusterNear, float(id.z) / float(ClusterSlices));
+    float z1 = ClusterNear * pow(ClusterFar / ClusterNear, float(id.z + 1) / float(ClusterSlices));
+    vec3 boxMin = vec3(1e30);
+    vec3 boxMax = vec3(-1e30);
+    for (int k = 0; k < 4; ++k)
+    {
+        vec2 ndc = vec2(id.xy + ivec2(k & 1, k >> 1)) / vec2(ClusterTiles) * 2. - 1.;
+        vec4 p = InvProjection * vec4(ndc, -1., 1.);
+        vec3 ray = p.xyz / p.w;
+        ray /= -ray.z;
+        boxMin = min(boxMin, min(ray * z0, ray * z1));
+        boxMax = max(boxMax, max(ray * z0, ray * z1));
+    }
+
+    int count = 0;
+    int base = c * (1 + MaxLightsPerCluster);
+    for (int first = 0; first < LightCount; first += 64)
+    {
+        int i = first + int(gl_LocalInvocationIndex);
+        if (i < LightCount)
+        {
+            vec4 light = clusterLights[i].PositionRadius;
+            sharedLights[gl_LocalInvocationIndex] = 
+                vec4((View * vec4(light.xyz, 1.)).xyz, light.w);
+        }
+        barrier();
+
+        int n = min(64, LightCount - first);
+        for (int j = 0; active && j < n && count < MaxLightsPerCluster; ++j)
+        {
+            vec4 light = sharedLights[j];
+            vec3 d = clamp(light.xyz, boxMin, boxMax) - light.xyz;
+            if (dot(d, d) <= light.w * light.w)
+                clusterList[base + 1 + count++] = uint(first + j);
+        }
+        barrier();
+    }
+
+    if (active)
+        clusterList[base] = uint(count);
+}
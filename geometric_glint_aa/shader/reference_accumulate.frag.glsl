@@ -0,0 +1,63 @@
+#version 330
+
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Welford accumulation of the samples of a reference
+// (SceneObj::accumulateReference): running mean and sum of squared
+// deviations M2 of every pixel, in ping-pong textures. The alpha channels
+// hold the luminance, whose variance decides the convergence. The tiles
+// found converged by reference_convergence.frag.glsl are not shaded any
+// more: their statistics are copied as they are.
+
+uniform sampler2D Tex;          // Sample SampleIndex, linear radiance
+uniform sampler2D MeanTex;      // Mean of the SampleIndex previous samples
+uniform sampler2D M2Tex;        // Their sum of squared deviations
+uniform sampler2D TileTex;      // Unconverged pixels per tile
+
+uniform int  SampleIndex;
+uniform bool Adaptive;          // TileTex is valid
+uniform int  TileSize;
+
+layout(location = 0) out vec4 Mean;
+layout(location = 1) out vec4 M2;
+
+float luminance(vec3 c)
+{
+    return dot(c, vec3(0.212671, 0.715160, 0.072169));
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    vec4 mean = texelFetch(MeanTex, pixel, 0);
+    vec4 m2 = texelFetch(M2Tex, pixel, 0);
+
+    if (Adaptive && texelFetch(TileTex, pixel / TileSize, 0).x == 0.)
+    {
+        Mean = mean;
+        M2 = m2;
+        return;
+    }
+
+    vec3 radiance = texelFetch(Tex, pixel, 0).rgb;
+    vec4 x = vec4(radiance, luminance(radiance));
+
+    if (SampleIndex == 0)
+    {
+        Mean = x;
+        M2 = vec4(0.);
+        return;
+    }
+
+    vec4 delta = x - mean;
+    mean += delta / float(SampleIndex + 1);
+    Mean = mean;
+    M2 = m2 + delta * (x - mean);
+}
@@ -0,0 +1,48 @@
+#version 330
+
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Convergence of an adaptive reference (SceneObj::updateReferenceConvergence):
+// one fragment per TileSize x TileSize tile of the screen, which counts the
+// pixels of the tile whose relative standard error of the mean luminance
+// is still above Threshold. The standard error of a dark pixel is compared
+// to MinLuminance instead, otherwise the noise of the shadows would never
+// converge in relative terms.
+
+uniform sampler2D MeanTex;
+uniform sampler2D M2Tex;
+
+uniform int   SampleCount;      // Samples in MeanTex and M2Tex
+uniform int   TileSize;
+uniform float Threshold;
+uniform float MinLuminance;
+
+out vec4 FragColor;
+
+void main()
+{
+    ivec2 size = textureSize(MeanTex, 0);
+    ivec2 origin = ivec2(gl_FragCoord.xy) * TileSize;
+    ivec2 end = min(origin + TileSize, size);
+    float n = float(SampleCount);
+
+    float unconverged = 0.;
+    for (int y = origin.y; y < end.y; ++y)
+        for (int x = origin.x; x < end.x; ++x)
+        {
+            float mean = texelFetch(MeanTex, ivec2(x, y), 0).a;
+            float m2 = texelFetch(M2Tex, ivec2(x, y), 0).a;
+            // Variance of the mean, unbiased estimate of the variance
+            float error = sqrt(max(m2, 0.) / (n * (n - 1.)));
+            if (error > Threshold * max(mean, MinLuminance))
+                unconverged += 1.;
+        }
+    FragColor = vec4(unconverged, 0., 0., 1.);
+}
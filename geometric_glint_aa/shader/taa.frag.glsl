@@ -0,0 +1,113 @@
+#version 330
+
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Temporal anti-aliasing of the jittered frames (SceneObj::resolveTAA). The
+// history is reprojected with the camera matrices of the current and of the
+// previous frame (static scene: the motion of a pixel is the motion of the
+// camera), clipped to the neighbourhood of the current frame and blended
+// with it.
+
+uniform sampler2D Tex;          // Current frame, linear radiance
+uniform sampler2D HistoryTex;   // Previous output, linear radiance
+uniform sampler2D DepthTex;     // Depth of the current frame
+
+uniform mat4 InvViewProjection; // Jittered, of the current frame
+uniform mat4 PrevViewProjection;// Without jitter, of the previous frame
+uniform bool HistoryValid;
+uniform float Feedback;         // Weight of the current frame
+
+out vec4 FragColor;
+
+// Glint-aware color space: the radiance is compressed by its luminance
+// before the clipping and the blending. A glint is orders of magnitude
+// brighter than its neighbours: in linear space a single sparkle would
+// stretch the clipping box of its neighbourhood and its flickering would
+// dominate the average. YCoCg decorrelates the luminance of the box.
+float luminance(vec3 c)
+{
+    return dot(c, vec3(0.212671, 0.715160, 0.072169));
+}
+
+vec3 toGlintSpace(vec3 c)
+{
+    c /= 1. + luminance(c);
+    return vec3(dot(c, vec3(0.25, 0.5, 0.25)),
+                dot(c, vec3(0.5, 0., -0.5)),
+                dot(c, vec3(-0.25, 0.5, -0.25)));
+}
+
+vec3 fromGlintSpace(vec3 ycocg)
+{
+    vec3 c = vec3(ycocg.x + ycocg.y - ycocg.z,
+                  ycocg.x + ycocg.z,
+                  ycocg.x - ycocg.y - ycocg.z);
+    return c / max(1. - luminance(c), 1e-4);
+}
+
+// Clip the history toward the center of the box (not a per-channel clamp,
+// which shifts the hue)
+vec3 clipToBox(vec3 history, vec3 boxMin, vec3 boxMax)
+{
+    vec3 center = 0.5 * (boxMax + boxMin);
+    vec3 extent = 0.5 * (boxMax - boxMin) + 1e-6;
+    vec3 v = history - center;
+    vec3 a = abs(v / extent);
+    float m = max(a.x, max(a.y, a.z));
+    return m > 1. ? center + v / m : history;
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    ivec2 size = textureSize(Tex, 0);
+    vec3 current = toGlintSpace(texelFetch(Tex, pixel, 0).rgb);
+
+    if (!HistoryValid)
+    {
+        FragColor = vec4(fromGlintSpace(current), 1.);
+        return;
+    }
+
+    // Mean and standard deviation of the 3 x 3 neighbourhood
+    vec3 m1 = vec3(0.);
+    vec3 m2 = vec3(0.);
+    for (int y = -1; y <= 1; ++y)
+        for (int x = -1; x <= 1; ++x)
+        {
+            ivec2 q = clamp(pixel + ivec2(x, y), ivec2(0), size - 1);
+            vec3 c = toGlintSpace(texelFetch(Tex, q, 0).rgb);
+            m1 += c;
+            m2 += c * c;
+        }
+    m1 /= 9.;
+    vec3 sigma = sqrt(max(m2 / 9. - m1 * m1, 0.));
+
+    // Position of the pixel in the previous frame. The sky (depth of 1)
+    // is on the far plane, only the rotation of the camera moves it.
+    vec2 uv = (vec2(pixel) + 0.5) / vec2(size);
+    float depth = texelFetch(DepthTex, pixel, 0).r;
+    vec4 position = InvViewProjection * vec4(vec3(uv, depth) * 2. - 1., 1.);
+    vec4 prev = PrevViewProjection * vec4(position.xyz / position.w, 1.);
+    vec2 prevUV = prev.xy / prev.w * 0.5 + 0.5;
+
+    float alpha = Feedback;
+    vec3 history = current;
+    if (prev.w > 0. && all(greaterThanEqual(prevUV, vec2(0.))) 
+        && all(lessThanEqual(prevUV, vec2(1.))))
+    {
+        history = toGlintSpace(texture(HistoryTex, prevUV).rgb);
+        history = clipToBox(history, m1 - 1.25 * sigma, m1 + 1.25 * sigma);
+    }
+    else
+        alpha = 1.;
+
+    FragColor = vec4(fromGlintSpace(mix(history, current, alpha)), 1.);
+}
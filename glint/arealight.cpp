@@ -0,0 +1,140 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+
+#include "arealight.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace glint {
+
+int clipToHorizon(const glm::vec3* v, int n, glm::vec3* clipped)
+{
+    int m = 0;
+    for (int i = 0; i < n; i++) {
+        const glm::vec3& a = v[i];
+        const glm::vec3& b = v[(i + 1) % n];
+        if (a.z > 0.f)
+            clipped[m++] = a;
+        // The great arc from a to b is the normalized segment
+        if ((a.z > 0.f) != (b.z > 0.f)) {
+            float t = a.z / (a.z - b.z);
+            clipped[m++] = glm::normalize(a + t * (b - a));
+        }
+    }
+    return m < 3 ? 0 : m;
+}
+
+float polygonFormFactor(const glm::vec3* v, int n)
+{
+    const float m_pi = 3.141592f;
+
+    float formFactor = 0.f;
+    for (int i = 0; i < n; i++) {
+        glm::vec3 a = v[i];
+        glm::vec3 b = v[(i + 1) % n];
+        glm::vec3 c = glm::cross(a, b);
+        float len = glm::length(c);
+        if (len > 1e-7f)
+            formFactor += std::atan2(len, glm::dot(a, b)) * c.z / len;
+    }
+    return std::abs(formFactor) / (2.f * m_pi);
+}
+
+float polygonSolidAngle(const glm::vec3* v, int n)
+{
+    // Fan of spherical triangles (Van Oosterom and Strackee 1983)
+    float solidAngle = 0.f;
+    for (int i = 1; i + 1 < n; i++) {
+        glm::vec3 a = v[0];
+        glm::vec3 b = v[i];
+        glm::vec3 c = v[i + 1];
+        float numerator = std::abs(glm::dot(a, glm::cross(b, c)));
+        float denominator = 1.f + glm::dot(a, b) + glm::dot(b, c) + glm::dot(c, a);
+        solidAngle += 2.f * std::atan2(numerator, denominator);
+    }
+    return solidAngle;
+}
+
+// Ellipse of a 2x2 covariance (xx, xy, yy), as two axes d0 and d1 with
+// C = d0 d0^T + d1 d1^T
+static void covarianceAxes(glm::vec3 C, glm::vec2& d0, glm::vec2& d1)
+{
+    float m = 0.5f * (C.x + C.z);
+    float r = std::sqrt(std::max(m * m - (C.x * C.z - C.y * C.y), 0.f));
+    float l0 = m + r;
+    float l1 = std::max(m - r, 0.f);
+    glm::vec2 e0 = std::abs(C.y) > 1e-12f ? glm::normalize(glm::vec2(C.y, l0 - C.x))
+                 : (C.x >= C.z ? glm::vec2(1.f, 0.f) : glm::vec2(0.f, 1.f));
+    d0 = std::sqrt(l0) * e0;
+    d1 = std::sqrt(l1) * glm::vec2(-e0.y, e0.x);
+}
+
+glm::vec3 areaLightGlint(const Dictionary& dict, const GlintParams& params,
+                         const GlintQuery& query, const glm::vec3* v, int n)
+{
+    const glm::vec3& wo = query.wo;
+    if (wo.z <= 0.f || n < 3)
+        return glm::vec3(0.f);
+
+    // Moments of the polygon of the half vectors in slope space
+    float A = 0.f;
+    glm::vec2 M1(0.f);
+    glm::vec3 M2(0.f);
+    glm::vec2 p0(0.f);
+    for (int i = 0; i <= n; i++) {
+        glm::vec3 h = glm::normalize(wo + v[i % n]);
+        glm::vec2 p1 = glm::vec2(-h.x, -h.y) / std::max(h.z, 1e-4f);
+        if (i > 0) {
+            float c = p0.x * p1.y - p1.x * p0.y;
+            A += c;
+            M1 += (p0 + p1) * c;
+            M2 += glm::vec3(p0.x * p0.x + p0.x * p1.x + p1.x * p1.x,
+                            2.f * p0.x * p0.y + p0.x * p1.y + p1.x * p0.y + 2.f * p1.x * p1.y,
+                            p0.y * p0.y + p0.y * p1.y + p1.y * p1.y) * c;
+        }
+        p0 = p1;
+    }
+
+    // Light seen edge-on in slope space: a point light at its center
+    glm::vec2 slope_c;
+    glm::vec3 C(0.f);
+    if (std::abs(A) > 1e-8f) {
+        A *= 0.5f;
+        slope_c = M1 / (6.f * A);
+        C = M2 * glm::vec3(1.f / 12.f, 1.f / 24.f, 1.f / 12.f) / A
+            - glm::vec3(slope_c.x * slope_c.x, slope_c.x * slope_c.y, slope_c.y * slope_c.y);
+    }
+    else {
+        glm::vec3 center(0.f);
+        for (int i = 0; i < n; i++)
+            center += v[i];
+        glm::vec3 h = glm::normalize(wo + glm::normalize(center));
+        slope_c = glm::vec2(-h.x, -h.y) / h.z;
+    }
+
+    // Incident direction of the centroid
+    glm::vec3 wh = glm::normalize(glm::vec3(-slope_c.x, -slope_c.y, 1.f));
+    GlintQuery centroid = query;
+    centroid.wi = 2.f * glm::dot(wo, wh) * wh - wo;
+
+    // A box of width w has a variance of w^2 / 12
+    glm::vec2 d0 = query.dslopedx;
+    glm::vec2 d1 = query.dslopedy;
+    C.x = std::max(C.x, 0.f);
+    C.z = std::max(C.z, 0.f);
+    glm::vec3 C_filter = glm::vec3(d0.x * d0.x + d1.x * d1.x, d0.x * d0.y + d1.x * d1.y,
+                                   d0.y * d0.y + d1.y * d1.y) + 12.f * C;
+    covarianceAxes(C_filter, centroid.dslopedx, centroid.dslopedy);
+
+    return f_P(dict, params, centroid) * polygonSolidAngle(v, n);
+}
+
+} // namespace glint
@@ -0,0 +1,50 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+
+// Area light of the glint shader (shadeAreaLight of
+// improved_glint_envmap.frag.glsl). The light is a convex polygon of
+// directions in the shading frame, clipped to the horizon. The diffuse term
+// is its exact form factor. The glint term is an approximation: one
+// evaluation of f_P at the slope-space centroid of the half vectors of the
+// vertices, with the dictionary lookups filtered over their covariance,
+// times the solid angle of the light.
+
+#pragma once
+
+#include "dictionary.h"
+#include "glintbrdf.h"
+
+#include <glm/glm.hpp>
+
+namespace glint {
+
+// The rectangle is its 4 corners, the disk a regular octagon
+// (AREA_LIGHT_MAX_VERTICES)
+const int kAreaLightMaxVertices = 8;
+
+// Part of the convex polygon v[0, n) of unit directions above the horizon
+// (z >= 0), as unit directions. clipped holds at least n + 1 vertices.
+// Returns the vertex count of the clipped polygon, 0 below the horizon.
+int clipToHorizon(const glm::vec3* v, int n, glm::vec3* clipped);
+
+// Integral of cos(theta) / pi over the polygon of unit directions above
+// the horizon (edge integral)
+float polygonFormFactor(const glm::vec3* v, int n);
+
+// Solid angle of the convex polygon of unit directions
+float polygonSolidAngle(const glm::vec3* v, int n);
+
+// Centroid/covariance approximation of the integral of f_P over the
+// polygon of unit directions above the horizon, for the pixel of query
+// (query.wi is not used)
+glm::vec3 areaLightGlint(const Dictionary& dict, const GlintParams& params,
+                         const GlintQuery& query, const glm::vec3* v, int n);
+
+} // namespace glint
@@ -0,0 +1,141 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+
+#include "bluenoise.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace glint {
+
+namespace {
+
+// Gaussian energy of the set pixels, on the torus
+class EnergyField {
+public:
+    EnergyField(int size) :
+        m_size(size),
+        m_energy(size_t(size) * size, 0.f),
+        m_kernel(size_t(size) * size)
+    {
+        // sigma = 1.5, as in the paper
+        for (int y = 0; y < size; y++)
+            for (int x = 0; x < size; x++) {
+                int dx = std::min(x, size - x);
+                int dy = std::min(y, size - y);
+                m_kernel[y * size + x] = std::exp(-float(dx * dx + dy * dy) / (2.f * 1.5f * 1.5f));
+            }
+    }
+
+    void splat(int p, float sign)
+    {
+        int px = p % m_size, py = p / m_size;
+        for (int y = 0; y < m_size; y++) {
+            const float* k = &m_kernel[((y - py) & (m_size - 1)) * m_size];
+            float* e = &m_energy[y * m_size];
+            for (int x = 0; x < m_size; x++)
+                e[x] += sign * k[(x - px) & (m_size - 1)];
+        }
+    }
+
+    // Set pixel of highest energy (tightest cluster)
+    int tightestCluster(const std::vector<uint8_t>& set) const
+    {
+        int best = 0;
+        float bestEnergy = -HUGE_VALF;
+        for (int p = 0; p < int(set.size()); p++)
+            if (set[p] && m_energy[p] > bestEnergy) {
+                best = p;
+                bestEnergy = m_energy[p];
+            }
+        return best;
+    }
+
+    // Unset pixel of lowest energy (largest void)
+    int largestVoid(const std::vector<uint8_t>& set) const
+    {
+        int best = 0;
+        float bestEnergy = HUGE_VALF;
+        for (int p = 0; p < int(set.size()); p++)
+            if (!set[p] && m_energy[p] < bestEnergy) {
+                best = p;
+                bestEnergy = m_energy[p];
+            }
+        return best;
+    }
+
+private:
+    int                m_size;
+    std::vector<float> m_energy;
+    std::vector<float> m_kernel;
+};
+
+} // namespace
+
+std::vector<float> blueNoise(int size, uint32_t seed)
+{
+    int n = size * size;
+    std::vector<uint8_t> set(n, 0);
+    EnergyField field(size);
+
+    // Initial binary pattern: 10% of random pixels...
+    std::mt19937 rng(seed);
+    int ones = std::max(1, n / 10);
+    for (int count = 0; count < ones;) {
+        int p = int(rng() % uint32_t(n));
+        if (!set[p]) {
+            set[p] = 1;
+            field.splat(p, 1.f);
+            count++;
+        }
+    }
+
+    // ... made homogeneous by moving the tightest cluster to the largest void
+    for (int iter = 0; iter < n; iter++) {
+        int cluster = field.tightestCluster(set);
+        set[cluster] = 0;
+        field.splat(cluster, -1.f);
+        int hole = field.largestVoid(set);
+        set[hole] = 1;
+        field.splat(hole, 1.f);
+        if (hole == cluster)
+            break;
+    }
+
+    std::vector<int> rank(n, 0);
+
+    // Phase 1: rank the initial pattern by removing its tightest clusters
+    {
+        std::vector<uint8_t> prototype = set;
+        EnergyField prototypeField = field;
+        for (int r = ones - 1; r >= 0; r--) {
+            int cluster = prototypeField.tightestCluster(prototype);
+            prototype[cluster] = 0;
+            prototypeField.splat(cluster, -1.f);
+            rank[cluster] = r;
+        }
+    }
+
+    // Phase 2 and 3: fill the largest voids
+    for (int r = ones; r < n; r++) {
+        int hole = field.largestVoid(set);
+        set[hole] = 1;
+        field.splat(hole, 1.f);
+        rank[hole] = r;
+    }
+
+    std::vector<float> values(n);
+    for (int p = 0; p < n; p++)
+        values[p] = (float(rank[p]) + 0.5f) / float(n);
+    return values;
+}
+
+} // namespace glint
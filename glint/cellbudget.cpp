@@ -0,0 +1,79 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+
+#include "cellbudget.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace glint {
+
+// Recover when the frame is below this fraction of the target
+static const float kRecoverMargin = 0.85f;
+// Largest decrease in one frame
+static const float kMaxDecrease = 0.5f;
+// Increase per frame, as a fraction of the unconstrained budget
+static const float kIncrease = 0.05f;
+// Frames in flight when a measure is read (GpuTimer keeps 4 queries)
+static const int kLatency = 4;
+
+CellBudgetController::CellBudgetController(float targetMs, int minCells, int maxCells,
+                                           float maxAnisotropy) :
+    m_targetMs(targetMs),
+    m_minCells(minCells),
+    m_maxCells(maxCells),
+    m_maxAnisotropy(maxAnisotropy),
+    m_cells(float(maxCells)),
+    m_settleFrames(0)
+{}
+
+void CellBudgetController::reset()
+{
+    m_cells = float(m_maxCells);
+    m_settleFrames = 0;
+}
+
+CellBudget CellBudgetController::update(float gpuMs)
+{
+    // The measure is the one of a frame rendered before the last change
+    if (m_settleFrames > 0) {
+        m_settleFrames--;
+        return Budget();
+    }
+
+    int previousCells = Budget().maxCells;
+    if (gpuMs > m_targetMs) {
+        // The cost is roughly linear in the number of visited cells
+        m_cells *= std::max(kMaxDecrease, m_targetMs / gpuMs);
+    }
+    else if (gpuMs < kRecoverMargin * m_targetMs) {
+        m_cells += kIncrease * float(m_maxCells);
+    }
+    m_cells = std::min(std::max(m_cells, float(m_minCells)), float(m_maxCells));
+
+    CellBudget budget = Budget();
+    if (budget.maxCells != previousCells)
+        m_settleFrames = kLatency;
+    return budget;
+}
+
+CellBudget CellBudgetController::Budget() const
+{
+    CellBudget budget;
+    budget.maxCells = int(std::lround(m_cells));
+
+    // Elongated footprints cover the most cells: the eccentricity is
+    // clamped in proportion to the budget, down to isotropic footprints
+    float t = float(budget.maxCells - m_minCells) / float(std::max(1, m_maxCells - m_minCells));
+    budget.maxAnisotropy = 1.f + (m_maxAnisotropy - 1.f) * t;
+    return budget;
+}
+
+} // namespace glint
@@ -0,0 +1,64 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+
+// Frame-time driven budget of the glint shader: the number of cells a pixel
+// may visit per footprint level (GlintCellBudget, replaces the fixed
+// guardrail of P22__glint_discrete_LOD) and the clamp of the footprint
+// eccentricity (MaxAnisotropy). The GPU time of the frame comes from timer
+// queries, so the controller sees it a few frames late: it reacts
+// multiplicatively when the frame is too long and recovers slowly below a
+// margin of the target. After a change of budget it waits for the frames
+// rendered with the new one, which avoids oscillations.
+
+#pragma once
+
+namespace glint {
+
+// Cells visited per pixel and per level without time constraint, i.e. the
+// guardrail of P22__glint_discrete_LOD (GlintCellBudget of the shaders)
+const int kMaxGlintCells = 100;
+
+struct CellBudget {
+    int   maxCells;         // Cells visited per pixel and per level
+    float maxAnisotropy;    // Eccentricity clamp of the footprint
+};
+
+class CellBudgetController {
+public:
+    // maxCells and maxAnisotropy are the values without time constraint
+    CellBudgetController(float targetMs = 16.6f, int minCells = 8, int maxCells = kMaxGlintCells,
+                         float maxAnisotropy = 4.f);
+
+    void  SetTargetMs(float targetMs) { m_targetMs = targetMs; }
+    void  SetMaxAnisotropy(float maxAnisotropy) { m_maxAnisotropy = maxAnisotropy; }
+    float TargetMs() const { return m_targetMs; }
+
+    // Back to the unconstrained budget
+    void  reset();
+
+    // New budget from the last measured GPU time of a frame
+    CellBudget update(float gpuMs);
+
+    CellBudget Budget() const;
+
+private:
+    float m_targetMs;
+    int   m_minCells;
+    int   m_maxCells;
+    float m_maxAnisotropy;
+
+    // Continuous number of cells, rounded by Budget()
+    float m_cells;
+
+    // Measures still to skip since the last change of budget
+    int   m_settleFrames;
+};
+
+} // namespace glint
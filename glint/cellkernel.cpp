@@ -0,0 +1,203 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+#include "cellkernel_impl.h"
+
+#include <cmath>
+
+#if defined(GLINT_SIMD) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace glint {
+
+//=============================================================================
+//========================= Scalar lanes (W = 1) ==============================
+//=============================================================================
+namespace scalar {
+
+struct M { bool v; };
+
+struct I {
+    int v;
+    I() : v(0) {}
+    explicit I(int x) : v(x) {}
+    static I load(const int* p) { return I(*p); }
+};
+
+struct F {
+    float v;
+    F() : v(0.f) {}
+    explicit F(float x) : v(x) {}
+    static F load(const float* p) { return F(*p); }
+};
+
+// Integer arithmetic wraps around, as the unsigned arithmetic of P22_M
+inline I operator+(I a, I b) { return I(int(uint32_t(a.v) + uint32_t(b.v))); }
+inline I operator-(I a, I b) { return I(int(uint32_t(a.v) - uint32_t(b.v))); }
+inline I operator*(I a, I b) { return I(int(uint32_t(a.v) * uint32_t(b.v))); }
+inline I operator^(I a, I b) { return I(a.v ^ b.v); }
+inline I operator&(I a, I b) { return I(a.v & b.v); }
+inline M operator!=(I a, I b) { return M{ a.v != b.v }; }
+inline I shiftLeft(I a, int n) { return I(int(uint32_t(a.v) << n)); }
+inline I shiftRightLogical(I a, int n) { return I(int(uint32_t(a.v) >> n)); }
+inline I shiftRightLogical(I a, I n) { return I(int(uint32_t(a.v) >> n.v)); }
+inline I shiftRightArith(I a, int n) { return I(a.v >> n); }
+inline I min(I a, I b) { return b.v < a.v ? b : a; }
+inline I max(I a, I b) { return a.v < b.v ? b : a; }
+
+inline F operator+(F a, F b) { return F(a.v + b.v); }
+inline F operator-(F a, F b) { return F(a.v - b.v); }
+inline F operator*(F a, F b) { return F(a.v * b.v); }
+inline F operator/(F a, F b) { return F(a.v / b.v); }
+inline F operator-(F a) { return F(-a.v); }
+inline F abs(F a) { return F(fabsf(a.v)); }
+inline F floor(F a) { return F(floorf(a.v)); }
+inline F max(F a, F b) { return a.v < b.v ? b : a; }
+inline F toFloat(I a) { return F(float(a.v)); }
+inline I truncToInt(F a) { return I(int(a.v)); }
+
+inline M notGreater(F a, F b) { return M{ !(a.v > b.v) }; }
+inline M operator&(M a, M b) { return M{ a.v && b.v }; }
+inline F select(M m, F a, F b) { return m.v ? a : b; }
+
+inline void store(float* p, F a) { *p = a.v; }
+inline void store(int* p, I a) { *p = a.v; }
+inline void storeMask(int* p, M m) { *p = m.v ? -1 : 0; }
+
+inline F gather(const float* base, I index) { return F(base[index.v]); }
+inline I gatherInt(const int* base, I index) { return I(base[index.v]); }
+
+} // namespace scalar
+
+void evaluateCellsScalar(const CellFootprint& footprint, const CellBatch& batch, float* p22)
+{
+    evaluateCellBatch<scalar::F, scalar::I, scalar::M, 1>(footprint, batch, p22);
+}
+
+//=============================================================================
+//=================== Values that only depend on the footprint ================
+//=============================================================================
+CellFootprint::CellFootprint(const Dictionary& dict, const GlintParams& params,
+                             glm::vec2 slope_h, int l, glm::vec2 slope_dx, glm::vec2 slope_dy,
+                             glm::vec3 sigma_x_y_rho, float l_dist)
+{
+    // Same constants and expressions as P22_M
+    const float m_i_sqrt_2 = 0.707106f;
+
+    texels = dict.GetData();
+    mipOffsets = dict.GetMipOffsets();
+    width = dict.GetWidth();
+    mipLevelCount = dict.GetMipLevelCount();
+    layerCount = dict.GetLayerCount();
+    nLevels = dict.NLevels();
+    N = dict.N();
+    distPerChannel = dict.N() / 3;
+
+    twoToTheL = int(std::pow(2.f, float(l)));
+    this->l_dist = l_dist;
+    microfacetRelativeArea = params.microfacetRelativeArea;
+    filter = params.filter;
+    kernelSize = params.kernelSize;
+
+    float sigma_x = sigma_x_y_rho.x;
+    float sigma_y = sigma_x_y_rho.y;
+    float rho     = sigma_x_y_rho.z;
+
+    float SIGMA_DICT = dict.Alpha() * m_i_sqrt_2;
+    tmp1 =  SIGMA_DICT / (sigma_x * std::sqrt(1.f - rho * rho));
+    tmp2 = -SIGMA_DICT * rho / (sigma_y * std::sqrt(1.f - rho * rho));
+    tmp3 =  SIGMA_DICT / sigma_y;
+
+    alpha_dist_isqrt2_4 = dict.Alpha() * m_i_sqrt_2 * 4.f;
+    this->slope_h[0] = slope_h.x;
+    this->slope_h[1] = slope_h.y;
+    this->slope_dx[0] = slope_dx.x / alpha_dist_isqrt2_4;
+    this->slope_dx[1] = slope_dx.y / alpha_dist_isqrt2_4;
+    this->slope_dy[0] = slope_dy.x / alpha_dist_isqrt2_4;
+    this->slope_dy[1] = slope_dy.y / alpha_dist_isqrt2_4;
+
+    beckmann = non_axis_aligned_anisotropic_beckmann(slope_h.x, slope_h.y,
+                                                     sigma_x, sigma_y, rho);
+}
+
+//=============================================================================
+//========================= Runtime kernel selection ==========================
+//=============================================================================
+static bool cpuSupports(CellKernel kernel)
+{
+    if (kernel == CellKernel::Scalar)
+        return true;
+#if defined(GLINT_SIMD) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (kernel == CellKernel::AVX2)
+        return __builtin_cpu_supports("avx2");
+    return __builtin_cpu_supports("avx512f");
+#elif defined(GLINT_SIMD) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    if (!osxsave)
+        return false;
+    unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    if (kernel == CellKernel::AVX2)
+        return (xcr0 & 0x6) == 0x6 && (info[1] & (1 << 5)) != 0;
+    return (xcr0 & 0xe6) == 0xe6 && (info[1] & (1 << 16)) != 0;
+#else
+    return false;
+#endif
+}
+
+CellKernel bestCellKernel()
+{
+    static const CellKernel best =
+        cpuSupports(CellKernel::AVX512) ? CellKernel::AVX512 :
+        cpuSupports(CellKernel::AVX2)   ? CellKernel::AVX2 :
+                                          CellKernel::Scalar;
+    return best;
+}
+
+static CellKernel& currentCellKernel()
+{
+    static CellKernel kernel = bestCellKernel();
+    return kernel;
+}
+
+void setCellKernel(CellKernel kernel)
+{
+    currentCellKernel() = cpuSupports(kernel) ? kernel : CellKernel::Scalar;
+}
+
+CellKernel getCellKernel()
+{
+    return currentCellKernel();
+}
+
+const char* cellKernelName(CellKernel kernel)
+{
+    switch (kernel) {
+    case CellKernel::AVX2:   return "AVX2";
+    case CellKernel::AVX512: return "AVX-512";
+    default:                 return "Scalar";
+    }
+}
+
+void evaluateCells(const CellFootprint& footprint, const CellBatch& batch, float* p22)
+{
+    switch (currentCellKernel()) {
+#ifdef GLINT_SIMD
+    case CellKernel::AVX2:   evaluateCellsAVX2(footprint, batch, p22); break;
+    case CellKernel::AVX512: evaluateCellsAVX512(footprint, batch, p22); break;
+#endif
+    default:                 evaluateCellsScalar(footprint, batch, p22); break;
+    }
+}
+
+} // namespace glint
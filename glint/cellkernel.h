@@ -0,0 +1,89 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Vectorised evaluation of P22_M over the cells of a footprint.
+// Cells are gathered in structure-of-arrays batches and evaluated 1 (scalar),
+// 8 (AVX2) or 16 (AVX-512) at a time. Every kernel runs the same sequence of
+// IEEE operations as P22_M, so all of them return exactly the same values.
+
+#pragma once
+
+#include "dictionary.h"
+#include "glintbrdf.h"
+
+namespace glint {
+
+enum class CellKernel {
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+// Best kernel supported by the build and by the CPU
+CellKernel bestCellKernel();
+
+// Kernel used by P22__glint_discrete_LOD, bestCellKernel() by default.
+// Kernels that are not supported fall back to the scalar one.
+void       setCellKernel(CellKernel kernel);
+CellKernel getCellKernel();
+
+const char* cellKernelName(CellKernel kernel);
+
+// Maximum number of cells of a batch (multiple of every vector width)
+const int kCellBatchSize = 64;
+
+// Structure-of-arrays batch of cells of one LOD level.
+// Indices past count are read (padding lanes) but never used.
+struct CellBatch {
+    alignas(64) int   s[kCellBatchSize];      // cell indices at level l
+    alignas(64) int   t[kCellBatchSize];
+    alignas(64) float weight[kCellBatchSize]; // EWA weight
+    int count;
+
+    CellBatch() : s(), t(), weight(), count(0) {}
+};
+
+// Values of P22_M that only depend on the footprint
+struct CellFootprint {
+    const float* texels;        // Dictionary::GetData()
+    const int*   mipOffsets;    // Dictionary::GetMipOffsets()
+    int   width;                // power of two
+    int   mipLevelCount;
+    int   layerCount;
+    int   nLevels;
+    int   N;
+    int   distPerChannel;
+
+    int   twoToTheL;
+    float l_dist;
+    float microfacetRelativeArea;
+    bool  filter;
+    float kernelSize;
+
+    float slope_h[2];
+    float slope_dx[2];          // already divided by alpha_dist_isqrt2_4
+    float slope_dy[2];
+    float tmp1, tmp2, tmp3;     // invM before the random rotation
+    float alpha_dist_isqrt2_4;
+    float beckmann;             // P22 when the sampled LOD is NLevels
+
+    CellFootprint(const Dictionary& dict, const GlintParams& params,
+                  glm::vec2 slope_h, int l, glm::vec2 slope_dx, glm::vec2 slope_dy,
+                  glm::vec3 sigma_x_y_rho, float l_dist);
+};
+
+// p22[k] = P22_M(cell k of the batch), with the kernel selected by setCellKernel
+void evaluateCells(const CellFootprint& footprint, const CellBatch& batch, float* p22);
+
+// Kernels, defined in cellkernel*.cpp
+void evaluateCellsScalar(const CellFootprint& footprint, const CellBatch& batch, float* p22);
+void evaluateCellsAVX2(const CellFootprint& footprint, const CellBatch& batch, float* p22);
+void evaluateCellsAVX512(const CellFootprint& footprint, const CellBatch& batch, float* p22);
+
+} // namespace glint
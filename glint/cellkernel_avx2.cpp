@@ -0,0 +1,85 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// 8 lanes kernel, compiled with -mavx2 (/arch:AVX2).
+// FMA contraction must stay disabled (-ffp-contract=off) to match P22_M.
+
+#include "cellkernel_impl.h"
+
+#include <immintrin.h>
+
+namespace glint {
+namespace avx2 {
+
+struct M { __m256 v; };
+
+struct I {
+    __m256i v;
+    I() : v(_mm256_setzero_si256()) {}
+    explicit I(__m256i x) : v(x) {}
+    explicit I(int x) : v(_mm256_set1_epi32(x)) {}
+    static I load(const int* p) { return I(_mm256_load_si256(reinterpret_cast<const __m256i*>(p))); }
+};
+
+struct F {
+    __m256 v;
+    F() : v(_mm256_setzero_ps()) {}
+    explicit F(__m256 x) : v(x) {}
+    explicit F(float x) : v(_mm256_set1_ps(x)) {}
+    static F load(const float* p) { return F(_mm256_load_ps(p)); }
+};
+
+inline I operator+(I a, I b) { return I(_mm256_add_epi32(a.v, b.v)); }
+inline I operator-(I a, I b) { return I(_mm256_sub_epi32(a.v, b.v)); }
+inline I operator*(I a, I b) { return I(_mm256_mullo_epi32(a.v, b.v)); }
+inline I operator^(I a, I b) { return I(_mm256_xor_si256(a.v, b.v)); }
+inline I operator&(I a, I b) { return I(_mm256_and_si256(a.v, b.v)); }
+inline M operator!=(I a, I b)
+{
+    __m256i eq = _mm256_cmpeq_epi32(a.v, b.v);
+    return M{ _mm256_castsi256_ps(_mm256_xor_si256(eq, _mm256_set1_epi32(-1))) };
+}
+inline I shiftLeft(I a, int n) { return I(_mm256_sll_epi32(a.v, _mm_cvtsi32_si128(n))); }
+inline I shiftRightLogical(I a, int n) { return I(_mm256_srl_epi32(a.v, _mm_cvtsi32_si128(n))); }
+inline I shiftRightLogical(I a, I n) { return I(_mm256_srlv_epi32(a.v, n.v)); }
+inline I shiftRightArith(I a, int n) { return I(_mm256_sra_epi32(a.v, _mm_cvtsi32_si128(n))); }
+inline I min(I a, I b) { return I(_mm256_min_epi32(a.v, b.v)); }
+inline I max(I a, I b) { return I(_mm256_max_epi32(a.v, b.v)); }
+
+inline F operator+(F a, F b) { return F(_mm256_add_ps(a.v, b.v)); }
+inline F operator-(F a, F b) { return F(_mm256_sub_ps(a.v, b.v)); }
+inline F operator*(F a, F b) { return F(_mm256_mul_ps(a.v, b.v)); }
+inline F operator/(F a, F b) { return F(_mm256_div_ps(a.v, b.v)); }
+inline F operator-(F a) { return F(_mm256_xor_ps(a.v, _mm256_set1_ps(-0.f))); }
+inline F abs(F a) { return F(_mm256_andnot_ps(_mm256_set1_ps(-0.f), a.v)); }
+inline F floor(F a) { return F(_mm256_floor_ps(a.v)); }
+// (a < b) ? b : a, as std::max
+inline F max(F a, F b) { return F(_mm256_blendv_ps(a.v, b.v, _mm256_cmp_ps(a.v, b.v, _CMP_LT_OQ))); }
+inline F toFloat(I a) { return F(_mm256_cvtepi32_ps(a.v)); }
+inline I truncToInt(F a) { return I(_mm256_cvttps_epi32(a.v)); }
+
+inline M notGreater(F a, F b) { return M{ _mm256_cmp_ps(a.v, b.v, _CMP_NGT_UQ) }; }
+inline M operator&(M a, M b) { return M{ _mm256_and_ps(a.v, b.v) }; }
+inline F select(M m, F a, F b) { return F(_mm256_blendv_ps(b.v, a.v, m.v)); }
+
+inline void store(float* p, F a) { _mm256_store_ps(p, a.v); }
+inline void store(int* p, I a) { _mm256_store_si256(reinterpret_cast<__m256i*>(p), a.v); }
+inline void storeMask(int* p, M m) { _mm256_store_si256(reinterpret_cast<__m256i*>(p), _mm256_castps_si256(m.v)); }
+
+inline F gather(const float* base, I index) { return F(_mm256_i32gather_ps(base, index.v, 4)); }
+inline I gatherInt(const int* base, I index) { return I(_mm256_i32gather_epi32(base, index.v, 4)); }
+
+} // namespace avx2
+
+void evaluateCellsAVX2(const CellFootprint& footprint, const CellBatch& batch, float* p22)
+{
+    evaluateCellBatch<avx2::F, avx2::I, avx2::M, 8>(footprint, batch, p22);
+}
+
+} // namespace glint
@@ -0,0 +1,89 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// 16 lanes kernel, compiled with -mavx512f (/arch:AVX512).
+// FMA contraction must stay disabled (-ffp-contract=off) to match P22_M.
+
+#include "cellkernel_impl.h"
+
+#include <immintrin.h>
+
+namespace glint {
+namespace avx512 {
+
+struct M { __mmask16 v; };
+
+struct I {
+    __m512i v;
+    I() : v(_mm512_setzero_si512()) {}
+    explicit I(__m512i x) : v(x) {}
+    explicit I(int x) : v(_mm512_set1_epi32(x)) {}
+    static I load(const int* p) { return I(_mm512_load_si512(p)); }
+};
+
+struct F {
+    __m512 v;
+    F() : v(_mm512_setzero_ps()) {}
+    explicit F(__m512 x) : v(x) {}
+    explicit F(float x) : v(_mm512_set1_ps(x)) {}
+    static F load(const float* p) { return F(_mm512_load_ps(p)); }
+};
+
+inline I operator+(I a, I b) { return I(_mm512_add_epi32(a.v, b.v)); }
+inline I operator-(I a, I b) { return I(_mm512_sub_epi32(a.v, b.v)); }
+inline I operator*(I a, I b) { return I(_mm512_mullo_epi32(a.v, b.v)); }
+inline I operator^(I a, I b) { return I(_mm512_xor_si512(a.v, b.v)); }
+inline I operator&(I a, I b) { return I(_mm512_and_si512(a.v, b.v)); }
+inline M operator!=(I a, I b) { return M{ _mm512_cmpneq_epi32_mask(a.v, b.v) }; }
+inline I shiftLeft(I a, int n) { return I(_mm512_sll_epi32(a.v, _mm_cvtsi32_si128(n))); }
+inline I shiftRightLogical(I a, int n) { return I(_mm512_srl_epi32(a.v, _mm_cvtsi32_si128(n))); }
+inline I shiftRightLogical(I a, I n) { return I(_mm512_srlv_epi32(a.v, n.v)); }
+inline I shiftRightArith(I a, int n) { return I(_mm512_sra_epi32(a.v, _mm_cvtsi32_si128(n))); }
+inline I min(I a, I b) { return I(_mm512_min_epi32(a.v, b.v)); }
+inline I max(I a, I b) { return I(_mm512_max_epi32(a.v, b.v)); }
+
+inline F operator+(F a, F b) { return F(_mm512_add_ps(a.v, b.v)); }
+inline F operator-(F a, F b) { return F(_mm512_sub_ps(a.v, b.v)); }
+inline F operator*(F a, F b) { return F(_mm512_mul_ps(a.v, b.v)); }
+inline F operator/(F a, F b) { return F(_mm512_div_ps(a.v, b.v)); }
+inline F operator-(F a)
+{
+    return F(_mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a.v),
+                                                  _mm512_set1_epi32(int(0x80000000u)))));
+}
+inline F abs(F a)
+{
+    return F(_mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(a.v),
+                                                  _mm512_set1_epi32(0x7fffffff))));
+}
+inline F floor(F a) { return F(_mm512_roundscale_ps(a.v, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC)); }
+// (a < b) ? b : a, as std::max
+inline F max(F a, F b) { return F(_mm512_mask_blend_ps(_mm512_cmp_ps_mask(a.v, b.v, _CMP_LT_OQ), a.v, b.v)); }
+inline F toFloat(I a) { return F(_mm512_cvtepi32_ps(a.v)); }
+inline I truncToInt(F a) { return I(_mm512_cvttps_epi32(a.v)); }
+
+inline M notGreater(F a, F b) { return M{ _mm512_cmp_ps_mask(a.v, b.v, _CMP_NGT_UQ) }; }
+inline M operator&(M a, M b) { return M{ __mmask16(a.v & b.v) }; }
+inline F select(M m, F a, F b) { return F(_mm512_mask_blend_ps(m.v, b.v, a.v)); }
+
+inline void store(float* p, F a) { _mm512_store_ps(p, a.v); }
+inline void store(int* p, I a) { _mm512_store_si512(p, a.v); }
+inline void storeMask(int* p, M m) { _mm512_store_si512(p, _mm512_maskz_set1_epi32(m.v, -1)); }
+
+inline F gather(const float* base, I index) { return F(_mm512_i32gather_ps(index.v, base, 4)); }
+inline I gatherInt(const int* base, I index) { return I(_mm512_i32gather_epi32(index.v, base, 4)); }
+
+} // namespace avx512
+
+void evaluateCellsAVX512(const CellFootprint& footprint, const CellBatch& batch, float* p22)
+{
+    evaluateCellBatch<avx512::F, avx512::I, avx512::M, 16>(footprint, batch, p22);
+}
+
+} // namespace glint
@@ -0,0 +1,239 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Cell kernel shared by the scalar, AVX2 and AVX-512 translation units.
+// Each unit includes this file and instantiates evaluateCellBatch with its
+// lane types (F: float, I: 32 bits integer, M: mask, W: lane count) and the
+// overloads below, found by argument dependent lookup:
+//   F::load, I::load, store, storeMask, abs, floor, max, min, toFloat, truncToInt,
+//   notGreater, select, shiftLeft, shiftRightArith, shiftRightLogical,
+//   gather, gatherInt
+// and the arithmetic, comparison and bitwise operators.
+//
+// Only the transcendental functions (log of erfinv, cos, sin, log2 of the
+// texture LOD) and the rounding of the sampled LOD stay per lane, and they
+// call the very same functions as P22_M.
+//
+// The units are compiled with different instruction sets: everything here
+// lives in an unnamed namespace and calls libm directly, so that the linker
+// never merges an AVX copy of an inline function into the scalar kernel.
+
+#pragma once
+
+#include "cellkernel.h"
+
+#include <math.h>
+
+namespace glint {
+namespace {
+
+inline int minInt(int a, int b) { return b < a ? b : a; }
+inline int maxInt(int a, int b) { return a < b ? b : a; }
+
+template <class F, class I>
+inline F laneHashIQ(I n)
+{
+    // integer hash copied from Hugo Elias
+    n = shiftLeft(n, 13) ^ n;
+    n = n * (n * n * I(15731) + I(789221)) + I(1376312589);
+    return toFloat(n & I(0x7fffffff)) / F(float(0x7fffffff));
+}
+
+// GL_MIRRORED_REPEAT for a power of two size
+template <class I>
+inline I mirroredRepeat(I i, I size)
+{
+    I a = (i & (size + size - I(1))) - size;
+    I mirror = a ^ shiftRightArith(a, 31);
+    return (size - I(1)) - mirror;
+}
+
+// One channel of a linearly filtered texel, see Dictionary::sampleLinear
+template <class F, class I>
+inline F sampleLinear(const CellFootprint& fp, I mip, I layer, I channel, F s)
+{
+    I w = shiftRightLogical(I(fp.width), mip);
+    F u = s * toFloat(w) - F(0.5f);
+    F fi0 = floor(u);
+    F a = u - fi0;
+    I i0 = mirroredRepeat(truncToInt(fi0), w);
+    I i1 = mirroredRepeat(truncToInt(fi0) + I(1), w);
+
+    I row = gatherInt(fp.mipOffsets, mip) + layer * w * I(3) + channel;
+    F t0 = gather(fp.texels, row + i0 * I(3));
+    F t1 = gather(fp.texels, row + i1 * I(3));
+    return t0 * (F(1.f) - a) + t1 * a;
+}
+
+// Mip levels and blend factor of textureGrad, see Dictionary::textureGrad
+inline void textureLod(const CellFootprint& fp, float rho, int& d1, int& d2, float& frac)
+{
+    float lambda = log2f(rho);
+    d1 = d2 = 0;
+    frac = 0.f;
+    if (!(lambda > 0.f))
+        return;
+    int q = fp.mipLevelCount - 1;
+    if (float(q) < lambda)
+        lambda = float(q);
+    d1 = int(floorf(lambda));
+    d2 = minInt(d1 + 1, q);
+    frac = lambda - floorf(lambda);
+}
+
+template <class F, class I, class M, int W>
+void evaluateCellBatch(const CellFootprint& fp, const CellBatch& batch, float* p22)
+{
+    const float m_pi = 3.141592f;
+    const int n = batch.count;
+
+    // Per cell
+    alignas(64) int   seeds[kCellBatchSize];
+    alignas(64) float uDensity[kCellBatchSize];
+    alignas(64) float theta[kCellBatchSize];
+    alignas(64) int   alive[kCellBatchSize];
+
+    // Per cell that needs a dictionary lookup
+    alignas(64) int   index[kCellBatchSize];
+    alignas(64) int   cSeed[kCellBatchSize] = {};
+    alignas(64) int   cLevel[kCellBatchSize] = {};
+    alignas(64) float cCos[kCellBatchSize] = {};
+    alignas(64) float cSin[kCellBatchSize] = {};
+
+    // Stage 1: hash seeding and relative area culling
+    for (int k = 0; k < n; k += W) {
+        I s0 = I::load(batch.s + k) * I(fp.twoToTheL);
+        I t0 = I::load(batch.t + k) * I(fp.twoToTheL);
+        I rngSeed = s0 + I(1549) * t0;
+
+        F uMicrofacetRelativeArea = laneHashIQ<F>(rngSeed * I(13));
+        M inside = notGreater(uMicrofacetRelativeArea, F(fp.microfacetRelativeArea));
+
+        store(seeds + k, rngSeed);
+        store(uDensity + k, laneHashIQ<F>(rngSeed * I(2171)));
+        store(theta + k, F(2.0f * m_pi) * laneHashIQ<F>(rngSeed));
+        storeMask(alive + k, inside);
+    }
+
+    // Stage 2 (per lane): distribution LOD and rotation angle.
+    // The cells that survive are compacted.
+    int m = 0;
+    for (int k = 0; k < n; k++) {
+        if (!alive[k]) {
+            p22[k] = 0.f;
+            continue;
+        }
+        float l_dist = sampleNormalDistribution(uDensity[k], fp.l_dist, 2.f);
+        int level = minInt(maxInt(int(roundf(l_dist)), 0), fp.nLevels);
+        // If we are too far from the surface, the SDF is a gaussian.
+        if (level == fp.nLevels) {
+            p22[k] = fp.beckmann;
+            continue;
+        }
+        index[m] = k;
+        cSeed[m] = seeds[k];
+        cLevel[m] = level;
+        cCos[m] = cosf(theta[k]);
+        cSin[m] = sinf(theta[k]);
+        m++;
+    }
+    if (m == 0)
+        return;
+
+    alignas(64) int   layerX[kCellBatchSize], layerY[kCellBatchSize];
+    alignas(64) int   channelX[kCellBatchSize], channelY[kCellBatchSize];
+    alignas(64) float texCoordX[kCellBatchSize], texCoordY[kCellBatchSize];
+    alignas(64) float rhoX[kCellBatchSize], rhoY[kCellBatchSize];
+    alignas(64) float determinant[kCellBatchSize];
+    alignas(64) int   inRange[kCellBatchSize];
+
+    // Stage 3: random rotation, invM transform and 4 sigma culling
+    const F zero(0.f);
+    const F a4(fp.alpha_dist_isqrt2_4);
+    const F width(float(fp.width));
+    for (int k = 0; k < m; k += W) {
+        F cosTheta = F::load(cCos + k);
+        F sinTheta = F::load(cSin + k);
+
+        // invM = invR * invM, same products as glm::mat2 operator*
+        F m00 = cosTheta * F(fp.tmp1) + sinTheta * zero;
+        F m01 = (-sinTheta) * F(fp.tmp1) + cosTheta * zero;
+        F m10 = cosTheta * F(fp.tmp2) + sinTheta * F(fp.tmp3);
+        F m11 = (-sinTheta) * F(fp.tmp2) + cosTheta * F(fp.tmp3);
+
+        F abs_x = abs(m00 * F(fp.slope_h[0]) + m10 * F(fp.slope_h[1]));
+        F abs_y = abs(m01 * F(fp.slope_h[0]) + m11 * F(fp.slope_h[1]));
+        M inside = notGreater(abs_x, a4) & notGreater(abs_y, a4);
+
+        I rngSeed = I::load(cSeed + k);
+        I i = truncToInt(laneHashIQ<F>(rngSeed * I(16807)) * F(float(fp.N)));
+        I j = truncToInt(laneHashIQ<F>(rngSeed * I(48271)) * F(float(fp.N)));
+        // i / 3 for i < 2^16
+        I iOver3 = shiftRightLogical(i * I(43691), 17);
+        I jOver3 = shiftRightLogical(j * I(43691), 17);
+
+        I level = I::load(cLevel + k) * I(fp.distPerChannel);
+        I lastLayer(fp.layerCount - 1);
+        store(layerX + k, min(max(level + iOver3, I(0)), lastLayer));
+        store(layerY + k, min(max(level + jOver3, I(0)), lastLayer));
+        store(channelX + k, i - iOver3 * I(3));
+        store(channelY + k, j - jOver3 * I(3));
+
+        store(texCoordX + k, select(inside, abs_x / a4, zero));
+        store(texCoordY + k, select(inside, abs_y / a4, zero));
+        store(determinant + k, m00 * m11 - m10 * m01);
+        storeMask(inRange + k, inside);
+
+        if (fp.filter) {
+            F ks(fp.kernelSize);
+            F dx_x = (m00 * F(fp.slope_dx[0]) + m10 * F(fp.slope_dx[1])) * ks;
+            F dx_y = (m01 * F(fp.slope_dx[0]) + m11 * F(fp.slope_dx[1])) * ks;
+            F dy_x = (m00 * F(fp.slope_dy[0]) + m10 * F(fp.slope_dy[1])) * ks;
+            F dy_y = (m01 * F(fp.slope_dy[0]) + m11 * F(fp.slope_dy[1])) * ks;
+            store(rhoX + k, max(abs(dx_x) * width, abs(dy_x) * width));
+            store(rhoY + k, max(abs(dx_y) * width, abs(dy_y) * width));
+        }
+    }
+
+    // Stage 4 (per lane): mip levels of the two lookups.
+    // Without filtering, both are GL_LINEAR lookups in the level 0.
+    alignas(64) int   mipX1[kCellBatchSize] = {}, mipX2[kCellBatchSize] = {};
+    alignas(64) int   mipY1[kCellBatchSize] = {}, mipY2[kCellBatchSize] = {};
+    alignas(64) float fracX[kCellBatchSize] = {}, fracY[kCellBatchSize] = {};
+    if (fp.filter) {
+        for (int k = 0; k < m; k++) {
+            textureLod(fp, rhoX[k], mipX1[k], mipX2[k], fracX[k]);
+            textureLod(fp, rhoY[k], mipY1[k], mipY2[k], fracY[k]);
+        }
+    }
+
+    // Stage 5: dictionary lookups, Equation 15
+    alignas(64) float result[kCellBatchSize];
+    for (int k = 0; k < m; k += W) {
+        I lx = I::load(layerX + k), ly = I::load(layerY + k);
+        I cx = I::load(channelX + k), cy = I::load(channelY + k);
+        F sx = F::load(texCoordX + k), sy = F::load(texCoordY + k);
+
+        F fx = F::load(fracX + k);
+        F P_20_o = sampleLinear(fp, I::load(mipX1 + k), lx, cx, sx) * (F(1.f) - fx)
+                 + sampleLinear(fp, I::load(mipX2 + k), lx, cx, sx) * fx;
+        F fy = F::load(fracY + k);
+        F P_02_o = sampleLinear(fp, I::load(mipY1 + k), ly, cy, sy) * (F(1.f) - fy)
+                 + sampleLinear(fp, I::load(mipY2 + k), ly, cy, sy) * fy;
+
+        M inside = I::load(inRange + k) != I(0);
+        store(result + k, select(inside, P_20_o * P_02_o * F::load(determinant + k), zero));
+    }
+
+    for (int k = 0; k < m; k++)
+        p22[index[k]] = result[k];
+}
+
+} // namespace
+} // namespace glint
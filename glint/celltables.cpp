@@ -0,0 +1,40 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+#include "celltables.h"
+#include "glintbrdf.h"
+
+#include <cmath>
+
+namespace glint {
+
+uint32_t cellSeed(int l, int s, int t)
+{
+    // Coherent index
+    int twoToTheL = int(std::pow(2.f, float(l)));
+    return uint32_t(s) * uint32_t(twoToTheL) + 1549U * (uint32_t(t) * uint32_t(twoToTheL));
+}
+
+std::vector<uint32_t> occupancyBitmask(float microfacetRelativeArea, int levelCount)
+{
+    std::vector<uint32_t> words(size_t(levelCount) * kOccupancyWordsPerLevel, 0U);
+    for (int l = 0; l < levelCount; l++) {
+        uint32_t* level = &words[size_t(l) * kOccupancyWordsPerLevel];
+        for (int t = 0; t < kCellTileSize; t++) {
+            for (int s = 0; s < kCellTileSize; s++) {
+                float uMicrofacetRelativeArea = hashIQ(cellSeed(l, s, t) * 13U);
+                if (uMicrofacetRelativeArea <= microfacetRelativeArea)
+                    level[(t * kCellTileSize + s) / 32] |= 1U << (s % 32);
+            }
+        }
+    }
+    return words;
+}
+
+} // namespace glint
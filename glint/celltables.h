@@ -0,0 +1,42 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Precomputed per-cell tables of the glint shader.
+//
+// The cells of a pyramid level are unbounded (2^15 x 2^15 at level 0): the
+// tables hold the cells [0, kCellTileSize)^2 of every level, i.e. whole
+// levels from 256 x 256 cells up. They store exactly what P22_M computes
+// from the hash of these cells, and the shader only reads them for the
+// footprints inside these cells. The other footprints hash their cells:
+// indices are never wrapped, so the pattern does not repeat and the seeds
+// stay coherent across levels.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace glint {
+
+// Must match CELL_TILE_SIZE of improved_glint_envmap.frag.glsl
+const int kCellTileSize = 256;
+
+// Words of the occupancy bitmask of one level
+const int kOccupancyWordsPerLevel = kCellTileSize * kCellTileSize / 32;
+
+// Seed of the cell (s, t) at level l, as in P22_M (any s and t)
+uint32_t cellSeed(int l, int s, int t);
+
+// One bit per cell of the tile, set when the cell is not discarded by the
+// microfacet relative area: hashIQ(seed * 13) <= microfacetRelativeArea.
+// Level l, row t: words [l * kOccupancyWordsPerLevel + t * kCellTileSize / 32, ...),
+// the bit s % 32 of the word s / 32 is the cell (s, t).
+std::vector<uint32_t> occupancyBitmask(float microfacetRelativeArea, int levelCount);
+
+} // namespace glint
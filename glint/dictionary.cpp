@@ -0,0 +1,235 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+#define TINYEXR_IMPLEMENTATION
+
+#include "dictionary.h"
+#include "tinyexr.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+namespace glint {
+
+float roundToHalf(float x)
+{
+	uint32_t f;
+	std::memcpy(&f, &x, sizeof(f));
+	uint32_t sign = f & 0x80000000u;
+	uint32_t absf = f & 0x7fffffffu;
+
+	// Inf and NaN
+	if (absf >= 0x7f800000u)
+		return x;
+
+	// Half subnormals, quantum of 2^-24
+	if (absf < 0x38800000u) {
+		float q = std::nearbyint(std::fabs(x) * 16777216.f) / 16777216.f;
+		return sign ? -q : q;
+	}
+
+	// Keep 10 bits of mantissa, round to nearest even
+	absf += 0x00000fffu + ((absf >> 13) & 1u);
+	absf &= ~0x00001fffu;
+
+	// Overflow (> 65504)
+	if (absf > 0x477fe000u)
+		absf = 0x7f800000u;
+
+	f = sign | absf;
+	std::memcpy(&x, &f, sizeof(f));
+	return x;
+}
+
+// GL_MIRRORED_REPEAT applied to a texel index
+static int mirroredRepeat(int i, int size)
+{
+	int m = i % (2 * size);
+	if (m < 0) m += 2 * size;
+	int a = m - size;
+	int mirror = a >= 0 ? a : -(1 + a);
+	return (size - 1) - mirror;
+}
+
+Dictionary::Dictionary() :
+	m_alpha(0.5f),	// dict_16_192_64_0p5_0p02
+	m_nlevels(0),
+	m_ndists(0),
+	m_width(0)
+{}
+
+bool Dictionary::load(const std::string& baseName, int nlevels, int ndists)
+{
+	m_nlevels = nlevels;
+	m_ndists = ndists;
+	m_texels.clear();
+	m_mipOffsets.clear();
+
+	int layerCount = nlevels * ndists;
+	std::vector<float> level0;
+
+	for (int l = 0; l < nlevels; ++l) {
+		std::string index_level = std::to_string(l);
+		index_level = std::string(4 - std::min<size_t>(4, index_level.size()), '0') + index_level;
+
+		for (int i = 0; i < ndists; i++) {
+			std::string index_dist = std::to_string(i);
+			index_dist = std::string(4 - std::min<size_t>(4, index_dist.size()), '0') + index_dist;
+
+			std::string texName = baseName + "_" + index_dist + "_" + index_level + ".exr";
+			float* data;
+			int width, height;
+			if (!exrio::LoadEXRRGBA(&data, &width, &height, texName.c_str(), nullptr)) {
+				std::cerr << "Unable to load dictionary file: " << texName << std::endl;
+				return false;
+			}
+
+			if (l == 0 && i == 0) {
+				m_width = width;
+				level0.resize(size_t(layerCount) * m_width * 3);
+			}
+
+			// RGBA -> RGB16F
+			float* dst = &level0[(size_t(l) * ndists + i) * m_width * 3];
+			for (int x = 0; x < m_width; x++)
+				for (int c = 0; c < 3; c++)
+					dst[x * 3 + c] = roundToHalf(data[x * 4 + c]);
+
+			free(data);
+		}
+	}
+
+	// Same number of levels as the texture (glTexStorage2D)
+	int mipLevelCount = 1 + (int)log2f(float(m_width));
+	m_texels = std::move(level0);
+	m_mipOffsets.push_back(0);
+
+	// Box filtered mip chain, as done by glGenerateMipmap
+	for (int m = 1; m < mipLevelCount; m++) {
+		int w = std::max(1, m_width >> m);
+		int wPrev = std::max(1, m_width >> (m - 1));
+		int offset = int(m_texels.size());
+		m_texels.resize(m_texels.size() + size_t(layerCount) * w * 3);
+		m_mipOffsets.push_back(offset);
+		for (int layer = 0; layer < layerCount; layer++) {
+			const float* src = &m_texels[m_mipOffsets[m - 1] + size_t(layer) * wPrev * 3];
+			float* dst = &m_texels[offset + size_t(layer) * w * 3];
+			for (int x = 0; x < w; x++)
+				for (int c = 0; c < 3; c++)
+					dst[x * 3 + c] = roundToHalf(
+						(src[(2 * x) * 3 + c] + src[(2 * x + 1) * 3 + c]) * 0.5f);
+		}
+	}
+
+	// Pairs of the paired layout: fixed random permutation (Fisher-Yates)
+	int n = N();
+	m_pairs.resize(n);
+	for (int k = 0; k < n; k++)
+		m_pairs[k] = k;
+	std::mt19937 rng(1549u);
+	for (int k = n - 1; k > 0; k--)
+		std::swap(m_pairs[k], m_pairs[rng() % uint32_t(k + 1)]);
+
+	return true;
+}
+
+void Dictionary::GetPairedTexels(int mip, int level, std::vector<float>& rgba) const
+{
+	int w = std::max(1, m_width >> mip);
+	int pairsPerLevel = N();
+	rgba.assign(size_t(pairsPerLevel / 4) * w * w * 4, 0.f);
+
+	// Marginal of distribution i at the level
+	auto marginal = [&](int i, int x) {
+		return GetTexels(mip, level * m_ndists + i / 3)[x * 3 + i % 3];
+	};
+
+	for (int k = 0; k < pairsPerLevel; k++) {
+		int j = m_pairs[k];
+		float* layer = &rgba[size_t(k / 4) * w * w * 4];
+		for (int y = 0; y < w; y++)
+			for (int x = 0; x < w; x++)
+				layer[(y * w + x) * 4 + k % 4] = marginal(k, x) * marginal(j, y);
+	}
+}
+
+float Dictionary::MaxValue() const
+{
+	if (m_texels.empty())
+		return 0.f;
+	return *std::max_element(m_texels.begin(), m_texels.end());
+}
+
+const float* Dictionary::GetTexels(int mip, int layer) const
+{
+	int w = std::max(1, m_width >> mip);
+	return &m_texels[m_mipOffsets[mip] + size_t(layer) * w * 3];
+}
+
+int Dictionary::selectLayer(float layer) const
+{
+	// Layer selection of array textures: floor(t + 0.5), clamped
+	int l = int(std::floor(layer + 0.5f));
+	return std::min(std::max(l, 0), GetLayerCount() - 1);
+}
+
+glm::vec3 Dictionary::sampleLinear(int mip, int layer, float s) const
+{
+	int w = std::max(1, m_width >> mip);
+	const float* texels = GetTexels(mip, layer);
+
+	float u = s * float(w) - 0.5f;
+	float fi0 = std::floor(u);
+	float a = u - fi0;
+	int i0 = mirroredRepeat(int(fi0), w);
+	int i1 = mirroredRepeat(int(fi0) + 1, w);
+
+	glm::vec3 t0(texels[i0 * 3], texels[i0 * 3 + 1], texels[i0 * 3 + 2]);
+	glm::vec3 t1(texels[i1 * 3], texels[i1 * 3 + 1], texels[i1 * 3 + 2]);
+	return t0 * (1.f - a) + t1 * a;
+}
+
+glm::vec3 Dictionary::textureLod0(float s, float layer) const
+{
+	// lambda = 0 -> magnification filter (GL_LINEAR)
+	return sampleLinear(0, selectLayer(layer), s);
+}
+
+glm::vec3 Dictionary::textureGrad(float s, float layer, float dPdx, float dPdy) const
+{
+	int l = selectLayer(layer);
+
+	// Scale factor and level of detail of a 1D texture
+	float rho = std::max(std::abs(dPdx) * float(m_width), std::abs(dPdy) * float(m_width));
+	float lambda = std::log2(rho);
+
+	// Magnification (GL_LINEAR)
+	if (!(lambda > 0.f))
+		return sampleLinear(0, l, s);
+
+	// Minification (GL_LINEAR_MIPMAP_LINEAR)
+	int q = GetMipLevelCount() - 1;
+	lambda = std::min(lambda, float(q));
+	int d1 = int(std::floor(lambda));
+	int d2 = std::min(d1 + 1, q);
+	float frac = lambda - std::floor(lambda);
+
+	glm::vec3 t1 = sampleLinear(d1, l, s);
+	if (d1 == d2)
+		return t1;
+	glm::vec3 t2 = sampleLinear(d2, l, s);
+	return t1 * (1.f - frac) + t2 * frac;
+}
+
+} // namespace glint
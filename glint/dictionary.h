@@ -0,0 +1,94 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace glint {
+
+// CPU copy of the multiscale dictionary of marginal distributions.
+// Texture::createMultiscaleMarginalDistributions uploads its level 0
+// (RGB16F, one layer per distribution triplet and per level) and lets
+// glGenerateMipmap build the chain; the CPU chain is the box filter that
+// glGenerateMipmap is expected to apply. textureLod0 and textureGrad
+// reproduce the sampling of the sampler1DArray used by the glint shader.
+class Dictionary {
+public:
+    Dictionary();
+
+    // Load <baseName>_<dist>_<level>.exr, layer index = level * ndists + dist.
+    bool load(const std::string& baseName, int nlevels, int ndists);
+
+    // Roughness of the dictionary distributions
+    void  SetAlpha(float alpha) { m_alpha = alpha; }
+
+    float Alpha() const { return m_alpha; }
+    int   N() const { return m_ndists * 3; }
+    int   NLevels() const { return m_nlevels; }
+    int   Pyramid0Size() const { return 1 << (m_nlevels - 1); }
+
+    int   GetWidth() const { return m_width; }
+    int   GetLayerCount() const { return m_nlevels * m_ndists; }
+    int   GetMipLevelCount() const { return int(m_mipOffsets.size()); }
+
+    // Largest value of the marginals, at any mip level
+    float MaxValue() const;
+
+    // RGB texels of one layer at a mip level.
+    const float* GetTexels(int mip, int layer) const;
+
+    // All the mip levels, one after the other, and the offset (in floats)
+    // of each level. Used by the cell kernels to gather texels.
+    const float* GetData() const { return m_texels.data(); }
+    const int*   GetMipOffsets() const { return m_mipOffsets.data(); }
+
+    // Paired layout (PairedDictionaryTex): pair k of a level is the
+    // separable product P_k(x) P_PairedWith(k)(y) of two marginals, stored
+    // as a width x width texture, so that one fetch returns both marginals.
+    // Four pairs per RGBA texel, layer = level * N() / 4 + k / 4.
+    int   PairedWith(int k) const { return m_pairs[k]; }
+    int   GetPairedLayerCount() const { return m_nlevels * N() / 4; }
+
+    // RGBA texels of the N() / 4 paired layers of a level at a mip level,
+    // layer after layer. The product of the box filtered marginals is the
+    // box filtered product: every mip level is exact.
+    void  GetPairedTexels(int mip, int level, std::vector<float>& rgba) const;
+
+    // GLSL textureLod(DictionaryTex, vec2(s, layer), 0.).rgb
+    glm::vec3 textureLod0(float s, float layer) const;
+
+    // GLSL textureGrad(DictionaryTex, vec2(s, layer), dPdx, dPdy).rgb
+    glm::vec3 textureGrad(float s, float layer, float dPdx, float dPdy) const;
+
+private:
+    glm::vec3 sampleLinear(int mip, int layer, float s) const;
+    int       selectLayer(float layer) const;
+
+    float   m_alpha;
+    int     m_nlevels;
+    int     m_ndists;
+    int     m_width;
+
+    // Level mip holds layerCount * (width >> mip) RGB texels,
+    // starting at m_texels[m_mipOffsets[mip]]
+    std::vector<float> m_texels;
+    std::vector<int>   m_mipOffsets;
+
+    // Second distribution of each pair of the paired layout
+    std::vector<int>   m_pairs;
+};
+
+// Round a float to the nearest half-precision value (RGB16F storage).
+float roundToHalf(float x);
+
+} // namespace glint
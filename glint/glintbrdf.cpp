@@ -0,0 +1,597 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+#include "glintbrdf.h"
+#include "cellkernel.h"
+#include "cellbudget.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace glint {
+
+//=============================================================================
+//=========================== Constants =======================================
+//=============================================================================
+static const float m_pi = 3.141592f;       /* MathConstant: PI             */
+static const float m_i_sqrt_2 = 0.707106f; /* MathConstant: 1/sqrt(2)      */
+
+//=============================================================================
+//============== Non axis aligned anisotropic Beckmann ========================
+//=============================================================================
+float non_axis_aligned_anisotropic_beckmann
+    (float x, float y, float sigma_x, float sigma_y, float rho)
+{
+    float x_sqr = x*x;
+    float y_sqr = y*y;
+    float sigma_x_sqr = sigma_x*sigma_x;
+    float sigma_y_sqr = sigma_y*sigma_y;
+
+    float z = ((x_sqr/sigma_x_sqr) - ( (2.f * rho *x*y)
+                  / (sigma_x * sigma_y)) + (y_sqr/sigma_y_sqr)) ;
+    return std::exp( - z / (2.f * (1.f - rho * rho)))
+        / ( 2.f * m_pi * sigma_x * sigma_y * std::sqrt(1.f - rho * rho));
+}
+
+// Same with the rounding of the half-precision shader: z stays in float,
+// the exponential and the normalisation are rounded to half
+float non_axis_aligned_anisotropic_beckmann_float16
+    (float x, float y, float sigma_x, float sigma_y, float rho)
+{
+    float x_sqr = x*x;
+    float y_sqr = y*y;
+    float sigma_x_sqr = sigma_x*sigma_x;
+    float sigma_y_sqr = sigma_y*sigma_y;
+
+    float z = ((x_sqr/sigma_x_sqr) - ( (2.f * rho *x*y)
+                  / (sigma_x * sigma_y)) + (y_sqr/sigma_y_sqr)) ;
+    float e = roundToHalf(std::exp(roundToHalf(- z / (2.f * (1.f - rho * rho)))));
+    float norm = roundToHalf( 2.f * m_pi * sigma_x * sigma_y * std::sqrt(1.f - rho * rho));
+    return roundToHalf(e / norm);
+}
+
+//=============================================================================
+//===================== Inverse error function ================================
+//=============================================================================
+float erfinv(float x) {
+    float w, p;
+    w = -std::log((1.0f-x)*(1.0f+x));
+    if(w < 5.000000f) {
+        w = w - 2.500000f;
+        p = 2.81022636e-08f;
+        p = 3.43273939e-07f + p*w;
+        p = -3.5233877e-06f + p*w;
+        p = -4.39150654e-06f + p*w;
+        p = 0.00021858087f + p*w;
+        p = -0.00125372503f + p*w;
+        p = -0.00417768164f + p*w;
+        p = 0.246640727f + p*w;
+        p = 1.50140941f + p*w;
+    }
+    else {
+        w = std::sqrt(w) - 3.000000f;
+        p = -0.000200214257f;
+        p = 0.000100950558f + p*w;
+        p = 0.00134934322f + p*w;
+        p = -0.00367342844f + p*w;
+        p = 0.00573950773f + p*w;
+        p = -0.0076224613f + p*w;
+        p = 0.00943887047f + p*w;
+        p = 1.00167406f + p*w;
+        p = 2.83297682f + p*w;
+    }
+    return p*x;
+}
+
+//=============================================================================
+//======================== Hash function ======================================
+//======================== Inigo Quilez =======================================
+//================ https://www.shadertoy.com/view/llGSzw ======================
+//=============================================================================
+float hashIQ(uint32_t n)
+{
+    // integer hash copied from Hugo Elias
+    n = (n << 13U) ^ n;
+    n = n * (n * n * 15731U + 789221U) + 1376312589U;
+    return float(n & 0x7fffffffU) / float(0x7fffffff);
+}
+
+//=============================================================================
+//================== Pyramid size at LOD level ================================
+//=============================================================================
+int pyramidSize(const Dictionary& dict, int level)
+{
+    return int(std::pow(2.f, float(dict.NLevels() - 1 - level)));
+}
+
+//=============================================================================
+//=============== Sampling from a normal distribution =========================
+//=============================================================================
+float sampleNormalDistribution(float U, float mu, float sigma)
+{
+    float x = sigma * 1.414213f * erfinv(2.0f * U - 1.0f) + mu;
+    return x;
+}
+
+//=============================================================================
+//===================== Spatially-varying, multiscale, ========================
+//=============== and transformed slope distribution function  ================
+//=============================== Equation 4 ==================================
+//=============================================================================
+float P22_M(const Dictionary& dict, const GlintParams& params,
+            glm::vec2 slope_h, int l, int s0, int t0,
+            glm::vec2 slope_dx, glm::vec2 slope_dy,
+            glm::vec3 sigma_x_y_rho, float l_dist)
+{
+    // Coherent index
+    int twoToTheL = int(std::pow(2.f, float(l)));
+    s0 *= twoToTheL;
+    t0 *= twoToTheL;
+
+    // Seed pseudo random generator
+    // (unsigned arithmetic: same wrap around as the GLSL int)
+    uint32_t rngSeed = uint32_t(s0) + 1549U * uint32_t(t0);
+
+    float uMicrofacetRelativeArea = hashIQ(rngSeed * 13U);
+    // Discard cells by using microfacet relative area
+    if (uMicrofacetRelativeArea > params.microfacetRelativeArea)
+        return 0.f;
+
+    float uDensityRandomisation = hashIQ(rngSeed * 2171U);
+
+    // Fix density randomisation to 2 to have better appearance
+    float densityRandomisation = 2.f;
+
+    // Sample a Gaussian to randomise the distribution LOD around the
+    // distribution level l_dist
+    l_dist = sampleNormalDistribution(uDensityRandomisation, l_dist,
+                                      densityRandomisation);
+
+    l_dist = float(std::min(std::max(int(std::round(l_dist)), 0), dict.NLevels()));
+
+    // Recover roughness and slope correlation factor
+    float sigma_x = sigma_x_y_rho.x;
+    float sigma_y = sigma_x_y_rho.y;
+    float rho     = sigma_x_y_rho.z;
+
+    // If we are too far from the surface, the SDF is a gaussian.
+    if (int(l_dist) == dict.NLevels()){
+        if (params.float16)
+            return non_axis_aligned_anisotropic_beckmann_float16(slope_h.x, slope_h.y,
+                    sigma_x, sigma_y, rho);
+        return non_axis_aligned_anisotropic_beckmann(slope_h.x, slope_h.y,
+                sigma_x, sigma_y, rho);
+    }
+
+    // Random rotations to remove glint alignment
+    float uTheta = hashIQ(rngSeed);
+    float theta = 2.0f * m_pi * uTheta;
+
+    float cosTheta = std::cos(theta);
+    float sinTheta = std::sin(theta);
+
+    //=========================================================================
+    //========= Linearly transformed isotropic Beckmann distribution ==========
+    //=========================================================================
+
+    float SIGMA_DICT = dict.Alpha() * m_i_sqrt_2;
+    float tmp1 =  SIGMA_DICT / (sigma_x * std::sqrt(1.f - rho * rho));
+    float tmp2 = -SIGMA_DICT * rho / (sigma_y * std::sqrt(1.f - rho * rho));
+    float tmp3 =  SIGMA_DICT / sigma_y;
+
+    // Equation 18 (slope correlation factor)
+    glm::mat2 invM = glm::mat2(tmp1, 0.f,     // first column
+                               tmp2, tmp3 );  // second column
+
+    // Apply random rotation
+    glm::mat2 invR = glm::mat2(cosTheta, -sinTheta,  // first column
+                               sinTheta,  cosTheta); // second column
+    invM = invR*invM;
+
+    // Get back to original space
+    // Equation 5
+    glm::vec2 slope_h_o = invM * slope_h;
+
+    // The SDF is an even function
+    glm::vec2 abs_slope_h_o = glm::vec2(std::abs(slope_h_o.x), std::abs(slope_h_o.y));
+
+    int distPerChannel = dict.N() / 3;
+    float alpha_dist_isqrt2_4 = dict.Alpha() * m_i_sqrt_2 * 4.f;
+
+    // After 4 standard deviations, the SDF equals zero
+    if (abs_slope_h_o.x > alpha_dist_isqrt2_4
+        || abs_slope_h_o.y > alpha_dist_isqrt2_4)
+        return 0.f;
+
+    float u1 = hashIQ(rngSeed * 16807U);
+    float u2 = hashIQ(rngSeed * 48271U);
+
+    int i = int(u1 * float(dict.N()));
+    int j = int(u2 * float(dict.N()));
+
+    // 3 distributions values in one texel
+    int distIdxXOver3 = i / 3;
+    int distIdxYOver3 = j / 3;
+
+    float texCoordX = abs_slope_h_o.x / alpha_dist_isqrt2_4;
+    float texCoordY = abs_slope_h_o.y / alpha_dist_isqrt2_4;
+
+    // We also need to scale the derivatives,
+    // as slope_h, to maintained coherence
+    slope_dx = slope_dx / alpha_dist_isqrt2_4;
+    slope_dy = slope_dy / alpha_dist_isqrt2_4;
+
+    glm::vec3 P_20_o, P_02_o;
+    // Contribution 1: GGAA
+    if(params.filter)
+    {
+        // As for the distribution, we transform the filtering kernel
+        glm::vec2 transformed_slope_dx = invM * slope_dx;
+        glm::vec2 transformed_slope_dy = invM * slope_dy;
+
+        // Scale the kernel by user parameter
+        transformed_slope_dx *= params.kernelSize;
+        transformed_slope_dy *= params.kernelSize;
+
+        P_20_o = dict.textureGrad(texCoordX,
+                                  l_dist * distPerChannel + distIdxXOver3,
+                                  transformed_slope_dx.x,
+                                  transformed_slope_dy.x);
+
+        P_02_o = dict.textureGrad(texCoordY,
+                                  l_dist * distPerChannel + distIdxYOver3,
+                                  transformed_slope_dx.y,
+                                  transformed_slope_dy.y);
+    }
+    else // Without geometric glint anti-aliasing
+    {
+        P_20_o = dict.textureLod0(texCoordX,
+                                  l_dist * distPerChannel + distIdxXOver3);
+        P_02_o = dict.textureLod0(texCoordY,
+                                  l_dist * distPerChannel + distIdxYOver3);
+    }
+
+    // Equation 15
+    if (params.float16)
+        return roundToHalf(roundToHalf(P_20_o[i % 3]) * roundToHalf(P_02_o[j % 3]))
+               * glm::determinant(invM);
+    return P_20_o[i % 3] * P_02_o[j % 3] * glm::determinant(invM);
+}
+
+//=============================================================================
+//===================== P-SDF for a discrete LOD ==============================
+//=============================================================================
+
+// Most of this function is similar to pbrt-v3 EWA function,
+// which itself is similar to Heckbert 1889 algorithm,
+// http://www.cs.cmu.edu/~ph/texfund/texfund.pdf, Section 3.5.9.
+// Go through cells within the pixel footprint for a givin LOD
+float P22__glint_discrete_LOD(const Dictionary& dict, const GlintParams& params,
+                              int l, glm::vec2 slope_h, glm::vec2 st, glm::vec2 dst0,
+                              glm::vec2 dst1, glm::vec2 slope_dx, glm::vec2 slope_dy,
+                              glm::vec3 sigma_x_y_rho, float l_dist,
+                              TraversalStats* stats)
+{
+    // Convert surface coordinates to appropriate scale for level
+    float pyrSize = float(pyramidSize(dict, l));
+    st[0] = st[0] * pyrSize - 0.5f;
+    st[1] = st[1] * pyrSize - 0.5f;
+    dst0[0] *= pyrSize;
+    dst0[1] *= pyrSize;
+    dst1[0] *= pyrSize;
+    dst1[1] *= pyrSize;
+
+    // Compute ellipse coefficients to bound filter region
+    float A = dst0[1] * dst0[1] + dst1[1] * dst1[1] + 1.f;
+    float B = -2.f * (dst0[0] * dst0[1] + dst1[0] * dst1[1]);
+    float C = dst0[0] * dst0[0] + dst1[0] * dst1[0] + 1.f;
+    float invF = 1.f / (A * C - B * B * 0.25f);
+    A *= invF;
+    B *= invF;
+    C *= invF;
+
+    // Compute the ellipse's bounding box in texture space
+    float det = -B * B + 4.f * A * C;
+    float invDet = 1.f / det;
+    float uSqrt = std::sqrt(det * C), vSqrt = std::sqrt(A * det);
+    int s0 = int(std::ceil(st[0] - 2.f * invDet * uSqrt));
+    int s1 = int(std::floor(st[0] + 2.f * invDet * uSqrt));
+    int t0 = int(std::ceil(st[1] - 2.f * invDet * vSqrt));
+    int t1 = int(std::floor(st[1] + 2.f * invDet * vSqrt));
+
+    // Cells inside the ellipse are evaluated by batches (see cellkernel.h).
+    // Partial sums are accumulated in the scan order.
+    CellFootprint footprint(dict, params, slope_h, l, slope_dx, slope_dy,
+                            sigma_x_y_rho, l_dist);
+    CellBatch batch;
+    float p22[kCellBatchSize];
+    float sum = 0.f;
+    float sumWts = 0.f;
+    auto flush = [&]() {
+        evaluateCells(footprint, batch, p22);
+        for (int k = 0; k < batch.count; k++) {
+            sum += p22[k] * batch.weight[k];
+            sumWts += batch.weight[k];
+        }
+        batch.count = 0;
+    };
+
+    if (stats)
+        stats->boundingBoxCells += uint64_t(std::max(0, s1 - s0 + 1))
+                                   * uint64_t(std::max(0, t1 - t0 + 1));
+
+    // Scan the rows of the ellipse bound. On a row, r2 < 1 between the roots
+    // of the quadratic A ss^2 + (B tt) ss + (C tt^2 - 1): only these cells
+    // are visited.
+    int nbrOfIter = 0;
+    for (int it = t0; it <= t1; ++it)
+    {
+        float tt = float(it) - st[1];
+        float b = B * tt;
+        float c = C * tt * tt - 1.f;
+        float delta = b * b - 4.f * A * c;
+        if (delta < 0.f)
+            continue;
+        float sqrtDelta = std::sqrt(delta);
+        int is0 = std::max(s0, int(std::ceil(st[0] + (-b - sqrtDelta) / (2.f * A))));
+        int is1 = std::min(s1, int(std::floor(st[0] + (-b + sqrtDelta) / (2.f * A))));
+
+        // The roots are rounded: include the neighbouring cell if it
+        // passes the test of the loop below
+        auto r2At = [&](int is) {
+            float ss = float(is) - st[0];
+            return A * ss * ss + B * ss * tt + C * tt * tt;
+        };
+        if (is0 > s0 && r2At(is0 - 1) < 1.f) --is0;
+        if (is1 < s1 && r2At(is1 + 1) < 1.f) ++is1;
+
+        for (int is = is0; is <= is1; ++is)
+        {
+            // Compute squared radius
+            // and filter SDF if inside ellipse
+            float r2 = r2At(is);
+            if (r2 < 1.f)
+            {
+                // Weighting function used in pbrt-v3 EWA function
+                float alpha = 2.f;
+                if (params.float16) {
+                    // Cell by cell, with the rounding of the half-precision
+                    // shader (the cell kernels are float32 only)
+                    float W_P = roundToHalf(
+                        roundToHalf(std::exp(roundToHalf(-alpha * r2)))
+                        - roundToHalf(std::exp(roundToHalf(-alpha))));
+                    sum += P22_M(dict, params, slope_h, l, is, it, slope_dx, slope_dy,
+                                 sigma_x_y_rho, l_dist) * W_P;
+                    sumWts += W_P;
+                }
+                else {
+                    float W_P = std::exp(-alpha * r2) - std::exp(-alpha);
+                    batch.s[batch.count] = is;
+                    batch.t[batch.count] = it;
+                    batch.weight[batch.count] = W_P;
+                    if (++batch.count == kCellBatchSize)
+                        flush();
+                }
+                nbrOfIter++;
+            }
+            // Guardrail (Extremely rare case.)
+            if (nbrOfIter > kMaxGlintCells)
+                break;
+        }
+        // Guardrail (Extremely rare case.)
+        if (nbrOfIter > kMaxGlintCells)
+            break;
+    }
+    if (stats)
+        stats->visitedCells += uint64_t(nbrOfIter);
+    if (batch.count > 0)
+        flush();
+    return sum/sumWts;
+}
+
+//=============================================================================
+//======== Evaluation of the procedural physically based glinty BRDF ==========
+//=============================================================================
+glm::vec3 f_P(const Dictionary& dict, const GlintParams& params, const GlintQuery& query,
+              TraversalStats* stats)
+{
+    const glm::vec3& wo = query.wo;
+    const glm::vec3& wi = query.wi;
+    const glm::vec3& sigmas_rho = query.sigmasRho;
+
+    if (wo.z <= 0.f)
+        return glm::vec3(0.f, 0.f, 0.f);
+    if (wi.z <= 0.f)
+        return glm::vec3(0.f, 0.f, 0.f);
+
+    glm::vec3 wh = glm::normalize(wo + wi);
+    if (wh.z <= 0.f)
+        return glm::vec3(0.f, 0.f, 0.f);
+
+    // Local masking shadowing
+    if (glm::dot(wo, wh) <= 0.f || glm::dot(wi, wh) <= 0.f)
+        return glm::vec3(0.f, 0.f, 0.f);
+
+    // Texture derivatives
+    glm::vec2 texCoord = query.uv;
+    glm::vec2 dst0 = query.duvdx;
+    glm::vec2 dst1 = query.duvdy;
+
+    // Normal to slope
+    glm::vec2 slope_h = glm::vec2(-wh.x / wh.z, -wh.y / wh.z);
+
+    glm::vec2 slope_dx = query.dslopedx;
+    glm::vec2 slope_dy = query.dslopedy;
+
+    glm::vec3 D_P = glm::vec3(0.f);
+    float P22_P = 0.f;
+
+    //=========================================================================
+    // Similar to pbrt-v3 MIPMap::Lookup function,
+    // http://www.pbr-book.org/3ed-2018/Texture/Image_Texture.html#EllipticallyWeightedAverage
+
+    // Compute ellipse minor and major axes
+    float dst0LengthSquared = glm::length(dst0);
+    dst0LengthSquared *= dst0LengthSquared;
+    float dst1LengthSquared = glm::length(dst1);
+    dst1LengthSquared *= dst1LengthSquared;
+
+    if (dst0LengthSquared < dst1LengthSquared)
+        std::swap(dst0, dst1);
+    float majorLength = glm::length(dst0);
+    float minorLength = glm::length(dst1);
+
+    // Clamp ellipse eccentricity if too large
+    if (minorLength * params.maxAnisotropy < majorLength
+        && minorLength > 0.f)
+    {
+        float scale = majorLength / (minorLength * params.maxAnisotropy);
+        dst1 *= scale;
+        minorLength *= scale;
+    }
+    //=========================================================================
+
+    // Without footprint -> no reflection
+    if (minorLength == 0.f) D_P = glm::vec3(0.f,0.f,0.f);
+    else
+    {
+        // Choose LOD
+        float l =
+            std::max(0.f, float(dict.NLevels()) - 1.f + std::log2(minorLength));
+        int il = int(std::floor(l));
+
+        float w = l - float(il);
+
+        // Number of microfacets in a cell at level il
+        float n_il = std::pow(2.f, float(2 * il - (2 * (dict.NLevels() - 1))));
+        n_il *= std::exp(params.logMicrofacetDensity);
+        // Corresponding continuous distribution LOD
+        float LOD_dist_il = std::log(n_il) / 1.38629f; // 2. * log(2) = 1.38629
+
+        // Number of microfacets in a cell at level il + 1
+        float n_ilp1 =
+            std::pow(2.f, float(2 * (il + 1) - (2 * (dict.NLevels() - 1))));
+        n_ilp1 *= std::exp(params.logMicrofacetDensity);
+        // Corresponding continuous distribution LOD
+        float LOD_dist_ilp1 = std::log(n_ilp1) / 1.38629f; // 2. * log(2) = 1.38629
+
+        float P22_P_il = params.float16 ?
+            non_axis_aligned_anisotropic_beckmann_float16
+            (slope_h.x, slope_h.y, sigmas_rho.x, sigmas_rho.y, sigmas_rho.z) :
+            non_axis_aligned_anisotropic_beckmann
+            (slope_h.x, slope_h.y, sigmas_rho.x, sigmas_rho.y, sigmas_rho.z);
+        float P22_P_ilp1 = P22_P_il;
+
+        bool opti = params.microfacetRelativeArea > 0.99f;
+
+        if(int(std::round(LOD_dist_il)) < dict.NLevels() || !opti)
+            P22_P_il = P22__glint_discrete_LOD
+                (dict, params, il, slope_h, texCoord, dst0, dst1,
+                 slope_dx, slope_dy, sigmas_rho, LOD_dist_il, stats);
+
+        if(int(std::round(LOD_dist_il)) < dict.NLevels() || !opti)
+            P22_P_ilp1 = P22__glint_discrete_LOD
+                (dict, params, il+1, slope_h, texCoord, dst0, dst1,
+                 slope_dx, slope_dy, sigmas_rho, LOD_dist_ilp1, stats);
+
+        P22_P = glm::mix(P22_P_il, P22_P_ilp1, w);
+
+        D_P = glm::vec3(P22_P / (wh.z * wh.z * wh.z * wh.z));
+    }
+
+    // V-cavity masking shadowing
+    float G1wowh = std::min(1.f, 2.f * wh.z * wo.z / glm::dot(wo, wh));
+    float G1wiwh = std::min(1.f, 2.f * wh.z * wi.z / glm::dot(wi, wh));
+    float G = G1wowh * G1wiwh;
+
+    // Fresnel is set to one for simplicity
+    glm::vec3 F = glm::vec3(1.f);
+
+    // (wi dot wg) is cancelled by
+    // the cosine weight in the rendering equation
+    return (F * G * D_P) / (4.f * wo.z);
+}
+
+//=============================================================================
+//=============== Upper bound of the glinty BRDF for one light ================
+//=============================================================================
+// A cell evaluates either the Beckmann distribution (farthest distribution
+// LOD) or Equation 15, which is at most MaxValue^2 * det(invM), and zero
+// when the transformed slope is farther than 4 standard deviations along
+// one axis. Whatever the random rotation of the cell, this is the case
+// beyond sqrt(2) * 4 * SIGMA_DICT = 4 * alpha.
+float f_P_upper_bound(const Dictionary& dict, glm::vec3 wo, glm::vec3 wi, glm::vec3 sigmas_rho)
+{
+    const float m_i_sqrt_2 = 0.707106f;
+
+    glm::vec3 wh = glm::normalize(wo + wi);
+    glm::vec2 slope_h = glm::vec2(-wh.x / wh.z, -wh.y / wh.z);
+
+    float P22 = non_axis_aligned_anisotropic_beckmann
+        (slope_h.x, slope_h.y, sigmas_rho.x, sigmas_rho.y, sigmas_rho.z);
+
+    // Equation 18, without the random rotation of the cells
+    float SIGMA_DICT = dict.Alpha() * m_i_sqrt_2;
+    float sqrt_1_rho_sqr = std::sqrt(1.f - sigmas_rho.z * sigmas_rho.z);
+    glm::vec3 inv_lt = glm::vec3( SIGMA_DICT / (sigmas_rho.x * sqrt_1_rho_sqr),
+                                 -SIGMA_DICT * sigmas_rho.z / (sigmas_rho.y * sqrt_1_rho_sqr),
+                                  SIGMA_DICT / sigmas_rho.y);
+    glm::vec2 slope_h_o = glm::vec2(inv_lt.x * slope_h.x + inv_lt.y * slope_h.y,
+                                    inv_lt.z * slope_h.y);
+
+    if (glm::length(slope_h_o) <= 4.f * dict.Alpha())
+        P22 = std::max(P22, dict.MaxValue() * dict.MaxValue()
+                            * inv_lt.x * inv_lt.z);
+
+    float G1wowh = std::min(1.f, 2.f * wh.z * wo.z / glm::dot(wo, wh));
+    float G1wiwh = std::min(1.f, 2.f * wh.z * wi.z / glm::dot(wi, wh));
+
+    return G1wowh * G1wiwh * P22 / (wh.z * wh.z * wh.z * wh.z * 4.f * wo.z);
+}
+
+void evaluate(const Dictionary& dict, const GlintParams& params,
+              const GlintQuery* queries, size_t count, glm::vec3* results,
+              TraversalStats* stats)
+{
+    for (size_t i = 0; i < count; i++)
+        results[i] = f_P(dict, params, queries[i], stats);
+}
+
+Float16Error measureFloat16Error(const Dictionary& dict, const GlintParams& params,
+                                 const GlintQuery* queries, size_t count)
+{
+    GlintParams params32 = params;
+    params32.float16 = false;
+    GlintParams params16 = params;
+    params16.float16 = true;
+
+    Float16Error error;
+    double sumAbsError = 0.;
+    double sumAbs = 0.;
+    for (size_t i = 0; i < count; i++) {
+        glm::vec3 f32 = f_P(dict, params32, queries[i]);
+        glm::vec3 f16 = f_P(dict, params16, queries[i]);
+        error.count++;
+        if (!std::isfinite(f16.x) || !std::isfinite(f16.y) || !std::isfinite(f16.z)) {
+            error.nonFinite++;
+            continue;
+        }
+        for (int c = 0; c < 3; c++) {
+            double e = std::abs(double(f16[c]) - double(f32[c]));
+            error.maxAbsError = std::max(error.maxAbsError, e);
+            sumAbsError += e;
+            sumAbs += std::abs(double(f32[c]));
+        }
+    }
+    error.relativeL1Error = sumAbs > 0. ? sumAbsError / sumAbs : 0.;
+    return error;
+}
+
+} // namespace glint
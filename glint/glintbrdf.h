@@ -0,0 +1,116 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// CPU port of the glinty BRDF of improved_glint_envmap.frag.glsl.
+// Functions keep the names and the order of operations of the shader so
+// that both can be compared line by line.
+
+#pragma once
+
+#include "dictionary.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/glm.hpp>
+
+namespace glint {
+
+// Uniforms of the glint shader used by f_P.
+// Material values are the ones selected by OverrideMaterials.
+struct GlintParams {
+    float logMicrofacetDensity;
+    float microfacetRelativeArea;
+    float maxAnisotropy;
+    float kernelSize;
+    bool  filter;       // GGAA
+    bool  float16;      // Rounding of the half-precision shader (GLINT_FLOAT16)
+
+    GlintParams() :
+        logMicrofacetDensity(15.f),
+        microfacetRelativeArea(0.025f),
+        maxAnisotropy(4.f),
+        kernelSize(0.5f),
+        filter(true),
+        float16(false)
+    {}
+};
+
+// One shading query, i.e. what the fragment shader knows about a pixel.
+// Directions are in the shading frame. Derivatives are the screen space
+// derivatives (dFdx, dFdy) the shader would have computed.
+struct GlintQuery {
+    glm::vec3 wo;
+    glm::vec3 wi;
+    glm::vec2 uv;           // TexCoord * ScaleUV
+    glm::vec2 duvdx;        // dFdx(uv)
+    glm::vec2 duvdy;        // dFdy(uv)
+    glm::vec2 dslopedx;     // dFdx(slope_h), or dFdx(wh.xy) with hemispherical derivatives
+    glm::vec2 dslopedy;     // dFdy(slope_h), or dFdy(wh.xy) with hemispherical derivatives
+    glm::vec3 sigmasRho;    // sigma_x, sigma_y, rho
+};
+
+// Cells of the EWA footprints, summed over the evaluated queries.
+// boundingBoxCells is what a scan of the ellipse bounding box tests,
+// visitedCells what the span traversal actually visits.
+struct TraversalStats {
+    uint64_t boundingBoxCells;
+    uint64_t visitedCells;
+
+    TraversalStats() : boundingBoxCells(0), visitedCells(0) {}
+};
+
+// Error of the half-precision path (GlintParams::float16) against float32
+struct Float16Error {
+    size_t count;           // Evaluated queries
+    size_t nonFinite;       // Queries that overflowed in half precision
+    double maxAbsError;     // Max over channels and finite queries
+    double relativeL1Error; // sum |f16 - f32| / sum |f32|
+
+    Float16Error() : count(0), nonFinite(0), maxAbsError(0.), relativeL1Error(0.) {}
+};
+
+float hashIQ(uint32_t n);
+float erfinv(float x);
+float sampleNormalDistribution(float U, float mu, float sigma);
+float non_axis_aligned_anisotropic_beckmann(float x, float y, float sigma_x, float sigma_y, float rho);
+float non_axis_aligned_anisotropic_beckmann_float16(float x, float y, float sigma_x, float sigma_y, float rho);
+int   pyramidSize(const Dictionary& dict, int level);
+
+// Equation 4
+float P22_M(const Dictionary& dict, const GlintParams& params,
+            glm::vec2 slope_h, int l, int s0, int t0,
+            glm::vec2 slope_dx, glm::vec2 slope_dy,
+            glm::vec3 sigma_x_y_rho, float l_dist);
+
+// P-SDF for a discrete LOD (EWA over the cells of the footprint)
+float P22__glint_discrete_LOD(const Dictionary& dict, const GlintParams& params,
+                              int l, glm::vec2 slope_h, glm::vec2 st, glm::vec2 dst0,
+                              glm::vec2 dst1, glm::vec2 slope_dx, glm::vec2 slope_dy,
+                              glm::vec3 sigma_x_y_rho, float l_dist,
+                              TraversalStats* stats = nullptr);
+
+// Glinty BRDF (without ks)
+glm::vec3 f_P(const Dictionary& dict, const GlintParams& params, const GlintQuery& query,
+              TraversalStats* stats = nullptr);
+
+// Conservative bound of f_P(query).x for any footprint, uv and slope
+// derivatives, without evaluating any cell (f_P_upper_bound of the shader)
+float f_P_upper_bound(const Dictionary& dict, glm::vec3 wo, glm::vec3 wi, glm::vec3 sigmas_rho);
+
+// Batch evaluation: results[i] = f_P(queries[i])
+void evaluate(const Dictionary& dict, const GlintParams& params,
+              const GlintQuery* queries, size_t count, glm::vec3* results,
+              TraversalStats* stats = nullptr);
+
+// Evaluate the queries with and without GlintParams::float16
+Float16Error measureFloat16Error(const Dictionary& dict, const GlintParams& params,
+                                 const GlintQuery* queries, size_t count);
+
+} // namespace glint
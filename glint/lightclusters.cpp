@@ -0,0 +1,65 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+
+#include "lightclusters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+namespace glint {
+
+glm::vec2 ClusterGrid::SliceScaleBias() const
+{
+    float logRange = std::log(zFar / zNear);
+    return glm::vec2(float(slices) / logRange,
+                     float(slices) * std::log(zNear) / logRange);
+}
+
+ClusterGrid makeClusterGrid(float zNear, float zFar)
+{
+    ClusterGrid grid;
+    grid.tilesX = 16;
+    grid.tilesY = 9;
+    grid.slices = 24;
+    grid.maxLightsPerCluster = 64;
+    grid.zNear = zNear;
+    grid.zFar = zFar;
+    return grid;
+}
+
+float lightRadius(float intensity, float cutoff)
+{
+    return std::sqrt(std::max(intensity, 0.f) / cutoff);
+}
+
+std::vector<ClusterLight> scatterLights(int count, const glm::vec3& boxMin, const glm::vec3& boxMax,
+                                        float intensity, float cutoff)
+{
+    std::mt19937 rng(1549u);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+
+    std::vector<ClusterLight> lights(std::max(count, 0));
+    for (ClusterLight& light : lights) {
+        glm::vec3 t(u(rng), u(rng), u(rng));
+        glm::vec3 p = boxMin + t * (boxMax - boxMin);
+
+        // Tint between 2700K-like and 6500K-like, normalized luminance
+        float w = u(rng);
+        glm::vec3 tint = glm::mix(glm::vec3(1.f, 0.75f, 0.5f), glm::vec3(0.9f, 0.95f, 1.f), w);
+        tint /= glm::dot(tint, glm::vec3(0.212671f, 0.715160f, 0.072169f));
+
+        light.positionRadius = glm::vec4(p, lightRadius(intensity * std::max(tint.x, std::max(tint.y, tint.z)), cutoff));
+        light.intensity = glm::vec4(intensity * tint, 0.f);
+    }
+    return lights;
+}
+
+} // namespace glint
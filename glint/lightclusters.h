@@ -0,0 +1,62 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+
+// Clustered forward lighting of many point lights. The view frustum is cut
+// into froxels: tiles of the screen and slices exponential in view depth.
+// light_clusters.comp.glsl lists the lights whose sphere of influence
+// touches each froxel, and the glint shader (GLINT_CLUSTERED_LIGHTS) only
+// loops over the lights of the froxel of its pixel. The layouts below must
+// match the shader storage blocks of both shaders.
+
+#pragma once
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace glint {
+
+// std430 layout of ClusterLightBuffer (binding 5):
+//   vec4 PositionRadius;   // World position, radius of influence
+//   vec4 L;                // Intensity (rgb)
+struct ClusterLight {
+    glm::vec4 positionRadius;
+    glm::vec4 intensity;
+};
+
+// Froxel grid. ClusterListBuffer (binding 6) holds, for each froxel
+// x + tilesX * (y + tilesY * z), its number of lights followed by
+// maxLightsPerCluster light indices.
+struct ClusterGrid {
+    int   tilesX, tilesY, slices;
+    int   maxLightsPerCluster;
+    float zNear, zFar;      // View depth range of the slices
+
+    int   ClusterCount() const { return tilesX * tilesY * slices; }
+    int   ListStride() const { return 1 + maxLightsPerCluster; }
+
+    // Slice of a view depth: floor(log(depth) * x - y), near boundary of
+    // slice k: zNear * (zFar / zNear)^(k / slices)
+    glm::vec2 SliceScaleBias() const;
+};
+
+// 16 x 9 tiles (16:9 screens), 24 slices from the near plane to far
+ClusterGrid makeClusterGrid(float zNear, float zFar);
+
+// Distance where the irradiance of a light, intensity / d^2, falls below
+// cutoff: beyond it the light is not listed
+float lightRadius(float intensity, float cutoff);
+
+// count lights scattered in [boxMin, boxMax] with a fixed seed, of random
+// warm to cold tints and of the same luminous intensity
+std::vector<ClusterLight> scatterLights(int count, const glm::vec3& boxMin, const glm::vec3& boxMax,
+                                        float intensity, float cutoff);
+
+} // namespace glint
@@ -0,0 +1,33 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+
+#include "lodtable.h"
+
+#include <cmath>
+
+namespace glint {
+
+GlintLodBlock makeGlintLodBlock(int nlevels, float logMicrofacetDensity,
+                                float microfacetRelativeArea)
+{
+    GlintLodBlock block = {};
+    for (int l = 0; l < kLodTableSize; l++) {
+        // Number of microfacets in a cell at level l
+        float n_l = std::pow(2.f, float(2 * l - (2 * (nlevels - 1))));
+        n_l *= std::exp(logMicrofacetDensity);
+        // Corresponding continuous distribution LOD
+        block.lodDist[l] = std::log(n_l) / 1.38629f; // 2. * log(2) = 1.38629
+    }
+    block.logMicrofacetDensity = logMicrofacetDensity;
+    block.microfacetRelativeArea = microfacetRelativeArea;
+    return block;
+}
+
+} // namespace glint
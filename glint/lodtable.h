@@ -0,0 +1,42 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+
+// Per-material constants of the glint shader, precomputed once per material
+// and uploaded as a std140 uniform block (MaterialGlintBlock and
+// UserGlintBlock of improved_glint_envmap.frag.glsl).
+
+#pragma once
+
+namespace glint {
+
+// Must match GLINT_LOD_TABLE_SIZE of improved_glint_envmap.frag.glsl
+const int kLodTableSize = 32;
+
+// std140 layout:
+//   vec4  LODDist[kLodTableSize / 4];
+//   float LogMicrofacetDensity;
+//   float MicrofacetRelativeArea;
+struct GlintLodBlock {
+    // Distribution LOD of the cells of pyramid level l (l_dist of P22_M):
+    // log(n_l) / (2 log 2), n_l the number of microfacets in a cell
+    float lodDist[kLodTableSize];
+    float logMicrofacetDensity;
+    float microfacetRelativeArea;
+    float pad[2];
+};
+
+static_assert(sizeof(GlintLodBlock) == (kLodTableSize + 4) * sizeof(float),
+              "GlintLodBlock must follow the std140 layout");
+
+// nlevels: number of levels of the dictionary
+GlintLodBlock makeGlintLodBlock(int nlevels, float logMicrofacetDensity,
+                                float microfacetRelativeArea);
+
+} // namespace glint
@@ -0,0 +1,154 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+
+#include "radiancecache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_set>
+
+namespace glint {
+
+uint32_t packCachePage(const CachePage& page)
+{
+    return 1u << 31 | uint32_t(page.mesh) << 17 | uint32_t(page.level) << 14
+         | uint32_t(page.y) << 7 | uint32_t(page.x);
+}
+
+CachePage unpackCachePage(uint32_t packed)
+{
+    CachePage page;
+    page.mesh = int((packed >> 17) & 0x3FFFu);
+    page.level = int((packed >> 14) & 0x7u);
+    page.y = int((packed >> 7) & 0x7Fu);
+    page.x = int(packed & 0x7Fu);
+    return page;
+}
+
+RadianceCache::RadianceCache(int slotCount) :
+    m_slotKeys(slotCount, 0u),
+    m_slotLastUsed(slotCount, -1),
+    m_slotStale(slotCount, 0),
+    m_frame(0)
+{}
+
+void RadianceCache::request(const uint32_t* feedback, size_t count)
+{
+    std::unordered_set<uint32_t> pages(m_requested.begin(), m_requested.end());
+    for (size_t i = 0; i < count; i++) {
+        if (feedback[i] == 0u)
+            continue;
+        pages.insert(feedback[i]);
+
+        // The single page of the coarsest level is the fallback of the
+        // missing pages of the mesh
+        CachePage coarsest = unpackCachePage(feedback[i]);
+        coarsest.level = kCacheLevels - 1;
+        coarsest.x = coarsest.y = 0;
+        pages.insert(packCachePage(coarsest));
+    }
+    m_requested.assign(pages.begin(), pages.end());
+
+    for (uint32_t key : m_requested) {
+        auto it = m_slots.find(key);
+        if (it != m_slots.end())
+            m_slotLastUsed[it->second] = m_frame;
+    }
+}
+
+bool RadianceCache::setShadingState(const std::vector<float>& state, float tolerance)
+{
+    bool changed = state.size() != m_state.size();
+    for (size_t i = 0; !changed && i < state.size(); i++)
+        changed = std::fabs(state[i] - m_state[i]) > tolerance * std::max(1.f, std::fabs(m_state[i]));
+    if (changed) {
+        m_state = state;
+        invalidate();
+    }
+    return changed;
+}
+
+void RadianceCache::invalidate()
+{
+    for (auto& slot : m_slots)
+        m_slotStale[slot.second] = 1;
+}
+
+int RadianceCache::allocateSlot()
+{
+    // Free slot, or the least recently used page not requested this frame
+    int best = -1;
+    for (int s = 0; s < SlotCount(); s++) {
+        if (m_slotKeys[s] == 0u)
+            return s;
+        if (m_slotLastUsed[s] < m_frame && (best < 0 || m_slotLastUsed[s] < m_slotLastUsed[best]))
+            best = s;
+    }
+    if (best >= 0) {
+        m_slots.erase(m_slotKeys[best]);
+        m_pageTableUpdates.push_back({ unpackCachePage(m_slotKeys[best]), 0 });
+        m_slotKeys[best] = 0u;
+    }
+    return best;
+}
+
+std::vector<CacheUpdate> RadianceCache::pagesToShade(int maxPages)
+{
+    std::vector<uint32_t> missing, stale;
+    for (uint32_t key : m_requested) {
+        auto it = m_slots.find(key);
+        if (it == m_slots.end())
+            missing.push_back(key);
+        else if (m_slotStale[it->second])
+            stale.push_back(key);
+    }
+
+    // Coarse levels first: they are the fallback of the finer ones
+    auto coarserFirst = [](uint32_t a, uint32_t b) {
+        return unpackCachePage(a).level > unpackCachePage(b).level;
+    };
+    std::stable_sort(missing.begin(), missing.end(), coarserFirst);
+    std::stable_sort(stale.begin(), stale.end(), coarserFirst);
+
+    std::vector<CacheUpdate> updates;
+    for (uint32_t key : missing) {
+        if (int(updates.size()) >= maxPages)
+            break;
+        int slot = allocateSlot();
+        if (slot < 0)
+            break;
+        m_slots[key] = slot;
+        m_slotKeys[slot] = key;
+        m_slotLastUsed[slot] = m_frame;
+        m_slotStale[slot] = 0;
+        m_pageTableUpdates.push_back({ unpackCachePage(key), uint16_t(slot + 1) });
+        updates.push_back({ unpackCachePage(key), slot });
+    }
+    for (uint32_t key : stale) {
+        if (int(updates.size()) >= maxPages)
+            break;
+        int slot = m_slots[key];
+        m_slotStale[slot] = 0;
+        updates.push_back({ unpackCachePage(key), slot });
+    }
+
+    m_requested.clear();
+    m_frame++;
+    return updates;
+}
+
+std::vector<PageTableEntry> RadianceCache::takePageTableUpdates()
+{
+    std::vector<PageTableEntry> updates;
+    updates.swap(m_pageTableUpdates);
+    return updates;
+}
+
+} // namespace glint
@@ -0,0 +1,97 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+
+// Page table of the texture-space glint radiance cache. The specular glint
+// radiance of a mesh is cached in a virtual texture that covers the UV
+// bounds of the mesh, with one mip level per footprint level. Virtual pages
+// are mapped to the pages of a physical atlas on demand: the glint shader
+// writes the page it needs (feedback), the application reads the feedback
+// back, maps the missing pages (least recently used eviction) and shades a
+// budget of pages per frame. Pages are only shaded again after
+// invalidate(), i.e. when the camera, the lights or the materials change.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace glint {
+
+// Must match CACHE_* of improved_glint_envmap.frag.glsl
+const int kCachePageSize = 64;          // Texels of a page side
+const int kCacheVirtualPages = 128;     // Pages of a side at level 0
+const int kCacheLevels = 8;             // Level 7 is a single page
+
+struct CachePage {
+    int mesh;
+    int level;
+    int x, y;
+};
+
+// Feedback encoding: 1 << 31 | mesh << 17 | level << 14 | y << 7 | x,
+// 0: no request
+uint32_t  packCachePage(const CachePage& page);
+CachePage unpackCachePage(uint32_t packed);
+
+// Page of the atlas where a virtual page is shaded
+struct CacheUpdate {
+    CachePage page;
+    int       slot;
+};
+
+// Entry of the page table (R16UI): slot + 1, 0 if not resident
+struct PageTableEntry {
+    CachePage page;
+    uint16_t  value;
+};
+
+class RadianceCache {
+public:
+    // slotCount: number of pages of the physical atlas
+    explicit RadianceCache(int slotCount);
+
+    // Pages read back from the feedback of a frame
+    void request(const uint32_t* feedback, size_t count);
+
+    // Invalidates the cache if one of the values of the shading state
+    // (camera, lights, materials) moved by more than tolerance
+    // (relative above 1). Returns true if the cache was invalidated.
+    bool setShadingState(const std::vector<float>& state, float tolerance);
+
+    // Every resident page is shaded again when requested
+    void invalidate();
+
+    // Pages to shade this frame, at most maxPages: missing pages, coarse
+    // levels first, then invalidated pages. Ends the frame.
+    std::vector<CacheUpdate> pagesToShade(int maxPages);
+
+    // Page table entries modified by pagesToShade since the last call
+    std::vector<PageTableEntry> takePageTableUpdates();
+
+    int ResidentPageCount() const { return int(m_slots.size()); }
+    int SlotCount() const { return int(m_slotKeys.size()); }
+
+private:
+    int allocateSlot();
+
+    std::unordered_map<uint32_t, int> m_slots;  // Packed page -> slot
+    std::vector<uint32_t> m_slotKeys;           // 0: free slot
+    std::vector<int>      m_slotLastUsed;       // Frame of the last request
+    std::vector<char>     m_slotStale;
+
+    std::vector<uint32_t> m_requested;          // Pages of this frame
+    std::vector<float>    m_state;
+    std::vector<PageTableEntry> m_pageTableUpdates;
+    int m_frame;
+};
+
+} // namespace glint
@@ -0,0 +1,162 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+#include "referencecheckpoint.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace glint {
+
+namespace {
+
+const char     Magic[8] = { 'G', 'L', 'I', 'N', 'T', 'R', 'E', 'F' };
+const uint32_t Version = 1;
+
+// Native endianness and float format: a checkpoint is resumed on the
+// machine that wrote it
+template <typename T>
+void put(std::ostream& out, const T& value)
+{
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void get(std::istream& in, T& value)
+{
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+}
+
+void putArray(std::ostream& out, const std::vector<float>& values)
+{
+    put(out, uint64_t(values.size()));
+    out.write(reinterpret_cast<const char*>(values.data()), std::streamsize(values.size() * sizeof(float)));
+}
+
+bool getArray(std::istream& in, std::vector<float>& values, uint64_t maxSize)
+{
+    uint64_t size = 0;
+    get(in, size);
+    if (!in || size > maxSize)
+        return false;
+    values.resize(size_t(size));
+    in.read(reinterpret_cast<char*>(values.data()), std::streamsize(size * sizeof(float)));
+    return bool(in);
+}
+
+} // namespace
+
+bool writeReferenceCheckpoint(const std::string& path, const ReferenceCheckpoint& c)
+{
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Unable to write reference checkpoint: " << tmpPath << std::endl;
+            return false;
+        }
+        out.write(Magic, sizeof(Magic));
+        put(out, Version);
+        put(out, int32_t(c.width));
+        put(out, int32_t(c.height));
+        put(out, c.cameraPosition);
+        put(out, c.cameraYaw);
+        put(out, c.cameraPitch);
+        put(out, int32_t(c.samplesPerPixel));
+        put(out, int32_t(c.sequence));
+        put(out, int32_t(c.shaderSamples));
+        put(out, int32_t(c.sampleCount));
+        put(out, uint8_t(c.adaptive));
+        put(out, int32_t(c.samplesPerRound));
+        put(out, c.errorThreshold);
+        put(out, c.convergedTarget);
+        put(out, int32_t(c.minSamples));
+        put(out, uint8_t(c.tilesValid));
+        put(out, c.scissor);
+        put(out, c.convergedFraction);
+        putArray(out, c.tileCounts);
+        putArray(out, c.mean);
+        putArray(out, c.m2);
+        out.flush();
+        if (!out) {
+            std::cerr << "Unable to write reference checkpoint: " << tmpPath << std::endl;
+            return false;
+        }
+    }
+
+    // std::rename does not replace an existing file everywhere
+    std::remove(path.c_str());
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "Unable to rename reference checkpoint: " << tmpPath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool readReferenceCheckpoint(const std::string& path, ReferenceCheckpoint& c)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Unable to open reference checkpoint: " << path << std::endl;
+        return false;
+    }
+
+    char magic[sizeof(Magic)];
+    uint32_t version = 0;
+    in.read(magic, sizeof(magic));
+    get(in, version);
+    if (!in || !std::equal(magic, magic + sizeof(magic), Magic) || version != Version) {
+        std::cerr << "Not a reference checkpoint of version " << Version << ": " << path << std::endl;
+        return false;
+    }
+
+    int32_t width = 0, height = 0, samplesPerPixel = 0, sequence = 0, shaderSamples = 0;
+    int32_t sampleCount = 0, samplesPerRound = 0, minSamples = 0;
+    uint8_t adaptive = 0, tilesValid = 0;
+    get(in, width);
+    get(in, height);
+    get(in, c.cameraPosition);
+    get(in, c.cameraYaw);
+    get(in, c.cameraPitch);
+    get(in, samplesPerPixel);
+    get(in, sequence);
+    get(in, shaderSamples);
+    get(in, sampleCount);
+    get(in, adaptive);
+    get(in, samplesPerRound);
+    get(in, c.errorThreshold);
+    get(in, c.convergedTarget);
+    get(in, minSamples);
+    get(in, tilesValid);
+    get(in, c.scissor);
+    get(in, c.convergedFraction);
+    c.width = width;
+    c.height = height;
+    c.samplesPerPixel = samplesPerPixel;
+    c.sequence = sequence;
+    c.shaderSamples = shaderSamples;
+    c.sampleCount = sampleCount;
+    c.adaptive = adaptive != 0;
+    c.samplesPerRound = samplesPerRound;
+    c.minSamples = minSamples;
+    c.tilesValid = tilesValid != 0;
+
+    uint64_t texels = uint64_t(std::max(width, 0)) * uint64_t(std::max(height, 0)) * 4;
+    if (!in || !getArray(in, c.tileCounts, texels) || !getArray(in, c.mean, texels) || !getArray(in, c.m2, texels)
+        || c.mean.size() != texels || c.m2.size() != texels) {
+        std::cerr << "Truncated reference checkpoint: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace glint
@@ -0,0 +1,65 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Checkpoint of a reference render: everything the accumulation of
+// SceneObj needs to go on from where it stopped, bit for bit. The
+// statistics are the raw RGBA32F texels, and the samples of a reference
+// are deterministic (PixelSampler, FrameIndex of the sample), so a resumed
+// reference is identical to an uninterrupted one. The scene and the
+// parameters other than the ones below are not stored: the reference must
+// be resumed with the same scene and settings.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace glint {
+
+struct ReferenceCheckpoint {
+    int         width;
+    int         height;
+
+    // Camera
+    glm::vec3   cameraPosition;
+    float       cameraYaw;
+    float       cameraPitch;
+
+    // Sampler
+    int         samplesPerPixel;
+    int         sequence;           // SampleSequence
+    int         shaderSamples;      // Subsamples per axis in the shader
+    int         sampleCount;        // Samples of the sampler accumulated
+
+    // Adaptive stopping, tested every samplesPerRound samples
+    bool        adaptive;
+    int         samplesPerRound;
+    float       errorThreshold;
+    float       convergedTarget;
+    int         minSamples;
+    bool        tilesValid;
+    glm::ivec4  scissor;
+    float       convergedFraction;
+    std::vector<float> tileCounts;  // Unconverged pixels per tile
+
+    // Welford statistics, width x height RGBA texels each
+    std::vector<float> mean;
+    std::vector<float> m2;
+};
+
+// Written to path + ".tmp" first, then renamed: a crash while writing
+// leaves the previous checkpoint intact.
+bool writeReferenceCheckpoint(const std::string& path, const ReferenceCheckpoint& checkpoint);
+
+// False if the file is missing, truncated or of another version
+bool readReferenceCheckpoint(const std::string& path, ReferenceCheckpoint& checkpoint);
+
+} // namespace glint
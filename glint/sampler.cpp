@@ -0,0 +1,141 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+#include "sampler.h"
+#include "bluenoise.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+
+namespace glint {
+
+namespace {
+
+// 2^-32
+const double InvTwoPow32 = 1. / 4294967296.;
+
+uint32_t reverseBits(uint32_t v)
+{
+    v = ((v >> 1) & 0x55555555u) | ((v & 0x55555555u) << 1);
+    v = ((v >> 2) & 0x33333333u) | ((v & 0x33333333u) << 2);
+    v = ((v >> 4) & 0x0f0f0f0fu) | ((v & 0x0f0f0f0fu) << 4);
+    v = ((v >> 8) & 0x00ff00ffu) | ((v & 0x00ff00ffu) << 8);
+    return (v >> 16) | (v << 16);
+}
+
+// Second Sobol dimension: direction numbers of the polynomial x + 1
+uint32_t sobol2(uint32_t i)
+{
+    uint32_t r = 0u;
+    for (uint32_t v = 0x80000000u; i; i >>= 1, v ^= v >> 1)
+        if (i & 1u)
+            r ^= v;
+    return r;
+}
+
+// Never rounds to 1 in single precision
+float toUnit(double x)
+{
+    return std::min(float(x), 0x1.fffffep-1f);
+}
+
+} // namespace
+
+const char* sampleSequenceName(SampleSequence sequence)
+{
+    switch (sequence) {
+    case SampleSequence::Sobol:     return "sobol";
+    case SampleSequence::R2:        return "r2";
+    case SampleSequence::BlueNoise: return "bluenoise";
+    default:                        return "grid";
+    }
+}
+
+bool parseSampleSequence(const std::string& name, SampleSequence& sequence)
+{
+    for (SampleSequence s : { SampleSequence::Grid, SampleSequence::Sobol,
+                              SampleSequence::R2, SampleSequence::BlueNoise })
+        if (name == sampleSequenceName(s)) {
+            sequence = s;
+            return true;
+        }
+    return false;
+}
+
+PixelSampler::PixelSampler() :
+    m_sequence(SampleSequence::Grid)
+{}
+
+void PixelSampler::configure(SampleSequence sequence, int count)
+{
+    m_sequence = sequence;
+    m_points.resize(std::max(count, 1));
+    int n = int(m_points.size());
+
+    switch (sequence) {
+    case SampleSequence::Grid: {
+        int size = int(std::ceil(std::sqrt(double(n))));
+        int cells = size * size;
+        // Successive samples spread over the grid. For a power of two grid,
+        // the stride (5/8 of the cells, odd) is the one of the first
+        // references.
+        int stride = (cells * 5 / 8) | 1;
+        while (std::gcd(stride, cells) != 1)
+            stride += 2;
+        for (int k = 0; k < n; k++) {
+            int i = int((int64_t(k) * stride) % cells);
+            m_points[k] = glm::vec2((float(i % size) + 0.5f) / float(size),
+                                    (float(i / size) + 0.5f) / float(size));
+        }
+        break;
+    }
+    case SampleSequence::Sobol: {
+        // The digital shift keeps the (0, 2)-sequence property and moves
+        // the first sample away from the corner of the pixel
+        std::mt19937 rng(1549u);
+        uint32_t shiftX = rng(), shiftY = rng();
+        for (int k = 0; k < n; k++)
+            m_points[k] = glm::vec2(
+                toUnit(double(reverseBits(uint32_t(k)) ^ shiftX) * InvTwoPow32),
+                toUnit(double(sobol2(uint32_t(k)) ^ shiftY) * InvTwoPow32));
+        break;
+    }
+    case SampleSequence::R2: {
+        // g^3 = g + 1
+        const double g = 1.32471795724474602596;
+        const double a1 = 1. / g, a2 = 1. / (g * g);
+        for (int k = 0; k < n; k++) {
+            double x = 0.5 + a1 * double(k), y = 0.5 + a2 * double(k);
+            m_points[k] = glm::vec2(toUnit(x - std::floor(x)), toUnit(y - std::floor(y)));
+        }
+        break;
+    }
+    case SampleSequence::BlueNoise: {
+        int size = 1;
+        while (size * size < n)
+            size *= 2;
+        // Rank r has the value (r + 0.5) / size^2
+        std::vector<float> ranks = blueNoise(size, 1549u);
+        std::vector<glm::vec2> pixels(size_t(size) * size);
+        for (int p = 0; p < size * size; p++) {
+            int r = int(ranks[p] * float(size * size));
+            pixels[r] = glm::vec2((float(p % size) + 0.5f) / float(size),
+                                  (float(p / size) + 0.5f) / float(size));
+        }
+        for (int k = 0; k < n; k++)
+            m_points[k] = pixels[k];
+        break;
+    }
+    }
+}
+
+} // namespace glint
@@ -0,0 +1,61 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Subpixel sample positions of the reference renders. Every sequence is
+// progressive: any prefix of it covers the pixel evenly, so the
+// accumulation of a reference can stop after any sample.
+//  - Grid: the centers of an n x n grid (n = ceil(sqrt(count))), visited
+//    with a stride coprime with n^2. Exact only for square counts.
+//  - Sobol: the (0, 2)-sequence in base 2 (van der Corput and the second
+//    Sobol dimension), with a fixed digital shift.
+//  - R2: the additive recurrence of the plastic number (Roberts 2018).
+//  - BlueNoise: the void-and-cluster ranks of a 2^k x 2^k tile (see
+//    bluenoise.h), the pixels of the rank r being sample r.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace glint {
+
+enum class SampleSequence {
+    Grid = 0,
+    Sobol,
+    R2,
+    BlueNoise
+};
+
+// Lowercase name, as on the command line: grid, sobol, r2, bluenoise
+const char* sampleSequenceName(SampleSequence sequence);
+
+// False if the name is unknown
+bool parseSampleSequence(const std::string& name, SampleSequence& sequence);
+
+class PixelSampler {
+public:
+    PixelSampler();
+
+    // The count first samples of the sequence
+    void configure(SampleSequence sequence, int count);
+
+    SampleSequence Sequence() const { return m_sequence; }
+    int            Count() const { return int(m_points.size()); }
+
+    // Sample i in [0, 1)^2, i < Count()
+    glm::vec2      Sample(int i) const { return m_points[i]; }
+
+private:
+    SampleSequence         m_sequence;
+    std::vector<glm::vec2> m_points;
+};
+
+} // namespace glint
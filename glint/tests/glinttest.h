@@ -0,0 +1,94 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Helpers shared by the test executables of the glint library.
+// A test is a main() that returns testResult(): CHECK reports every failed
+// condition and the test fails if any did.
+
+#pragma once
+
+#include "dictionary.h"
+#include "glintbrdf.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+
+namespace glint {
+namespace test {
+
+inline int& failureCount()
+{
+    static int count = 0;
+    return count;
+}
+
+inline int testResult()
+{
+    if (failureCount() > 0)
+        std::cerr << failureCount() << " check(s) failed" << std::endl;
+    return failureCount() > 0 ? 1 : 0;
+}
+
+#define CHECK(condition)                                                    \
+    do {                                                                    \
+        if (!(condition)) {                                                 \
+            std::cerr << __FILE__ << ":" << __LINE__                        \
+                      << ": CHECK(" #condition ") failed" << std::endl;     \
+            glint::test::failureCount()++;                                  \
+        }                                                                   \
+    } while (0)
+
+// Dictionary of the application (see SceneObj::initScene)
+inline bool loadDictionary(Dictionary& dict)
+{
+    dict.SetAlpha(0.5f);
+    return dict.load(std::string(GLINT_MEDIA_DIR) + "/dictionary/dict_16_192_64_0p5_0p02", 16, 64);
+}
+
+inline glm::vec3 randomDirection(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    float cosTheta = 0.05f + 0.95f * u(rng);
+    float sinTheta = std::sqrt(1.f - cosTheta * cosTheta);
+    float phi = 2.f * 3.141592f * u(rng);
+    return glm::vec3(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+}
+
+// Shading query of a random anisotropic pixel footprint: uv derivatives
+// from 1e-5 (close-up) to 1e-2 (far away)
+inline GlintQuery randomQuery(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    GlintQuery q;
+    // Half vector slopes within the roughness, so that most queries
+    // reflect something
+    std::normal_distribution<float> slope(0.f, 0.3f);
+    do {
+        q.wo = randomDirection(rng);
+        glm::vec3 wh = glm::normalize(glm::vec3(slope(rng), slope(rng), 1.f));
+        q.wi = 2.f * glm::dot(q.wo, wh) * wh - q.wo;
+    } while (q.wi.z < 0.05f);
+    q.uv = glm::vec2(u(rng), u(rng));
+
+    float major = std::pow(10.f, -5.f + 3.f * u(rng));
+    float minor = major * (0.1f + 0.9f * u(rng));
+    float angle = 3.141592f * u(rng);
+    q.duvdx = glm::vec2(std::cos(angle), std::sin(angle)) * major;
+    q.duvdy = glm::vec2(-std::sin(angle), std::cos(angle)) * minor;
+
+    q.dslopedx = glm::vec2(u(rng) - 0.5f, u(rng) - 0.5f) * 0.01f;
+    q.dslopedy = glm::vec2(u(rng) - 0.5f, u(rng) - 0.5f) * 0.01f;
+    q.sigmasRho = glm::vec3(0.05f + 0.45f * u(rng), 0.05f + 0.45f * u(rng), u(rng) - 0.5f);
+    return q;
+}
+
+} // namespace test
+} // namespace glint
@@ -0,0 +1,187 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Area light of the glint shader (arealight.h) against many point lights
+// spread over the light: the diffuse form factor with horizon clipping,
+// and the error of the centroid/covariance approximation of the glints.
+//
+//   test_arealight [light count]
+
+#include "glinttest.h"
+#include "arealight.h"
+
+#include <cstdlib>
+
+using namespace glint;
+
+// Rectangle of half axes u and v centred at c, facing cross(u, v), seen
+// from the origin of the shading frame (the order of the shader)
+static int rectangle(glm::vec3 c, glm::vec3 u, glm::vec3 v, glm::vec3 directions[kAreaLightMaxVertices + 1])
+{
+    directions[0] = glm::normalize(c + u + v);
+    directions[1] = glm::normalize(c - u + v);
+    directions[2] = glm::normalize(c - u - v);
+    directions[3] = glm::normalize(c + u - v);
+    return 4;
+}
+
+// Point lights at the centres of a grid of samples x samples cells of the
+// rectangle: direction and solid angle of each one
+template <typename F>
+static void pointLights(glm::vec3 c, glm::vec3 u, glm::vec3 v, int samples, F f)
+{
+    glm::vec3 normal = glm::cross(u, v);
+    float cellArea = 4.f * glm::length(normal) / float(samples * samples);
+    normal = glm::normalize(normal);
+    for (int j = 0; j < samples; j++) {
+        for (int i = 0; i < samples; i++) {
+            float x = 2.f * (float(i) + 0.5f) / float(samples) - 1.f;
+            float y = 2.f * (float(j) + 0.5f) / float(samples) - 1.f;
+            glm::vec3 p = c + x * u + y * v;
+            float d2 = glm::dot(p, p);
+            glm::vec3 wi = p / std::sqrt(d2);
+            float cosLight = -glm::dot(normal, wi);
+            if (cosLight > 0.f)
+                f(wi, cellArea * cosLight / d2);
+        }
+    }
+}
+
+// Light of half size halfSize at distance 1 in the direction (theta, phi),
+// facing the shaded point
+static void facingLight(float theta, float phi, float halfSize, glm::vec3& c, glm::vec3& u, glm::vec3& v)
+{
+    c = glm::vec3(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+    glm::vec3 up = std::abs(c.z) < 0.9f ? glm::vec3(0.f, 0.f, 1.f) : glm::vec3(1.f, 0.f, 0.f);
+    u = halfSize * glm::normalize(glm::cross(up, c));
+    v = halfSize * glm::normalize(glm::cross(u, c));
+}
+
+// Form factor and solid angle of lights above, across and below the
+// horizon against 128 x 128 point lights
+static void testFormFactor(std::mt19937& rng)
+{
+    const float m_pi = 3.141592f;
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    float maxError = 0.f, maxUnclippedError = 0.f;
+    int straddling = 0;
+    for (int i = 0; i < 300; i++) {
+        // Centres from 0.3 above to 0.3 below the horizon
+        float theta = 0.5f * m_pi + 0.6f * (unit(rng) - 0.5f) - (i % 3 == 0 ? 0.8f : 0.f);
+        glm::vec3 c, u, v;
+        facingLight(theta, 2.f * m_pi * unit(rng), 0.05f + 0.3f * unit(rng), c, u, v);
+
+        glm::vec3 light[kAreaLightMaxVertices + 1];
+        glm::vec3 clipped[kAreaLightMaxVertices + 1];
+        int n = rectangle(c, u, v, light);
+        int m = clipToHorizon(light, n, clipped);
+
+        float formFactor = 0.f, solidAngle = 0.f;
+        pointLights(c, u, v, 128, [&](glm::vec3 wi, float dOmega) {
+            formFactor += std::max(wi.z, 0.f) * dOmega / m_pi;
+            solidAngle += dOmega;
+        });
+
+        float clippedFormFactor = m > 0 ? polygonFormFactor(clipped, m) : 0.f;
+        maxError = std::max(maxError, std::abs(clippedFormFactor - formFactor) / solidAngle);
+        maxUnclippedError = std::max(maxUnclippedError,
+                                     std::abs(polygonFormFactor(light, n) - formFactor) / solidAngle);
+        CHECK(std::abs(polygonSolidAngle(light, n) - solidAngle) < 1e-3f * solidAngle);
+
+        bool above = light[0].z > 0.f && light[1].z > 0.f && light[2].z > 0.f && light[3].z > 0.f;
+        bool below = light[0].z <= 0.f && light[1].z <= 0.f && light[2].z <= 0.f && light[3].z <= 0.f;
+        if (below)
+            CHECK(m == 0);
+        if (above)
+            CHECK(m == n);
+        if (!above && !below) {
+            straddling++;
+            CHECK(m >= 3 && m <= n + 1);
+        }
+    }
+
+    std::cout << "Form factor: " << straddling << " of 300 lights across the horizon, max error "
+              << maxError << " (" << maxUnclippedError << " without clipping) of the solid angle"
+              << std::endl;
+    CHECK(straddling > 30);
+    CHECK(maxError < 1e-3f);
+    CHECK(maxUnclippedError > 1e-2f);
+}
+
+// Glints of lights around the mirror direction of random pixels, against
+// 32 x 32 point lights evaluated with the footprint of the pixel. Most
+// pixels of the sparse default material see no glint in the light. On the
+// others the approximation is biased low (about 0.75 of the reference)
+// with a relative L1 error about 0.5, against about 1.8 with one point
+// light at the centre of the light.
+static void testGlints(const Dictionary& dict, std::mt19937& rng, int count)
+{
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    GlintParams params;
+
+    double sumReference = 0., sumApprox = 0., sumAbsError = 0., sumCenterAbsError = 0.;
+    int lights = 0;
+    for (int i = 0; i < count; i++) {
+        GlintQuery q = test::randomQuery(rng);
+        float theta = std::acos(std::min(q.wi.z, 1.f));
+        float phi = std::atan2(q.wi.y, q.wi.x);
+        glm::vec3 c, u, v;
+        facingLight(theta, phi, 0.02f + 0.2f * unit(rng), c, u, v);
+
+        glm::vec3 light[kAreaLightMaxVertices + 1];
+        glm::vec3 clipped[kAreaLightMaxVertices + 1];
+        int n = rectangle(c, u, v, light);
+        int m = clipToHorizon(light, n, clipped);
+        if (m == 0)
+            continue;
+
+        double reference = 0.;
+        pointLights(c, u, v, 32, [&](glm::vec3 wi, float dOmega) {
+            GlintQuery point = q;
+            point.wi = wi;
+            reference += double(f_P(dict, params, point).x) * dOmega;
+        });
+        if (reference <= 0.)
+            continue;
+
+        // One point light at the centre, as without the approximation
+        GlintQuery center = q;
+        center.wi = glm::normalize(c);
+        double centerOnly = double(f_P(dict, params, center).x) * polygonSolidAngle(clipped, m);
+
+        double approx = areaLightGlint(dict, params, q, clipped, m).x;
+        sumReference += reference;
+        sumApprox += approx;
+        sumAbsError += std::abs(approx - reference);
+        sumCenterAbsError += std::abs(centerOnly - reference);
+        lights++;
+    }
+
+    std::cout << "Glints: " << lights << " lights, approximation / reference " << sumApprox / sumReference
+              << ", relative L1 error " << sumAbsError / sumReference << " (" << sumCenterAbsError / sumReference
+              << " with one point light at the centre)" << std::endl;
+    CHECK(lights > count / 10);
+    CHECK(std::abs(sumApprox / sumReference - 1.) < 0.5);
+    CHECK(sumAbsError < sumCenterAbsError);
+}
+
+int main(int argc, char* argv[])
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 1000;
+
+    Dictionary dict;
+    if (!test::loadDictionary(dict))
+        return 1;
+
+    std::mt19937 rng(1549u);
+    testFormFactor(rng);
+    testGlints(dict, rng, count);
+    return test::testResult();
+}
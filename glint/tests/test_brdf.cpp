@@ -0,0 +1,150 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Evaluates the fixed shading queries of a reference file with
+// glint::evaluate and compares them with the stored BRDF values.
+//
+//   test_brdf [reference] [--tolerance t] [--write]
+//
+// A line of the reference holds uv, duvdx, duvdy, dslopedx, dslopedy, wo,
+// wi, sigmas_rho (the fields of GlintQuery) and the expected f_P. A value
+// passes when |f_P - expected| <= t * (1 + |expected|). --write replaces
+// the expected values by the ones of the CPU port, for 64 random queries.
+// The default reference (data/brdf_reference.txt) was written by the CPU
+// port: the values of the shader, read back from the GPU for the same
+// queries, are compared with a looser tolerance (1e-2 or so, GPU
+// transcendentals and filtering are not exact).
+
+#include "glinttest.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace glint;
+
+static const int kQueryCount = 64;
+
+static bool readReference(const std::string& fileName,
+                          std::vector<GlintQuery>& queries,
+                          std::vector<glm::vec3>& expected)
+{
+    std::ifstream file(fileName);
+    if (!file) {
+        std::cerr << "Cannot open " << fileName << std::endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream in(line);
+        GlintQuery q;
+        glm::vec3 f;
+        in >> q.uv.x >> q.uv.y >> q.duvdx.x >> q.duvdx.y >> q.duvdy.x >> q.duvdy.y
+           >> q.dslopedx.x >> q.dslopedx.y >> q.dslopedy.x >> q.dslopedy.y
+           >> q.wo.x >> q.wo.y >> q.wo.z >> q.wi.x >> q.wi.y >> q.wi.z
+           >> q.sigmasRho.x >> q.sigmasRho.y >> q.sigmasRho.z
+           >> f.x >> f.y >> f.z;
+        if (!in) {
+            std::cerr << "Invalid line in " << fileName << ": " << line << std::endl;
+            return false;
+        }
+        queries.push_back(q);
+        expected.push_back(f);
+    }
+    return true;
+}
+
+static bool writeReference(const std::string& fileName,
+                           const std::vector<GlintQuery>& queries,
+                           const std::vector<glm::vec3>& values)
+{
+    FILE* file = std::fopen(fileName.c_str(), "w");
+    if (!file) {
+        std::cerr << "Cannot write " << fileName << std::endl;
+        return false;
+    }
+    std::fprintf(file, "# uv duvdx duvdy dslopedx dslopedy wo wi sigmas_rho f_P\n");
+    std::fprintf(file, "# GlintParams defaults but microfacetRelativeArea 0.5, dict_16_192_64_0p5_0p02, alpha 0.5\n");
+    for (size_t i = 0; i < queries.size(); i++) {
+        const GlintQuery& q = queries[i];
+        const float v[] = {
+            q.uv.x, q.uv.y, q.duvdx.x, q.duvdx.y, q.duvdy.x, q.duvdy.y,
+            q.dslopedx.x, q.dslopedx.y, q.dslopedy.x, q.dslopedy.y,
+            q.wo.x, q.wo.y, q.wo.z, q.wi.x, q.wi.y, q.wi.z,
+            q.sigmasRho.x, q.sigmasRho.y, q.sigmasRho.z,
+            values[i].x, values[i].y, values[i].z };
+        for (size_t k = 0; k < sizeof(v) / sizeof(v[0]); k++)
+            std::fprintf(file, k == 0 ? "%.9g" : " %.9g", v[k]);
+        std::fprintf(file, "\n");
+    }
+    std::fclose(file);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string fileName = std::string(GLINT_TEST_DATA_DIR) + "/brdf_reference.txt";
+    float tolerance = 1e-4f;
+    bool write = false;
+    for (int i = 1; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--write"))
+            write = true;
+        else if (!std::strcmp(argv[i], "--tolerance") && i + 1 < argc)
+            tolerance = float(std::atof(argv[++i]));
+        else
+            fileName = argv[i];
+    }
+
+    Dictionary dict;
+    if (!test::loadDictionary(dict))
+        return 1;
+    // Half of the cells are occupied: with the default 2.5%, most of the
+    // footprints of a few cells are empty
+    GlintParams params;
+    params.microfacetRelativeArea = 0.5f;
+
+    std::vector<GlintQuery> queries;
+    std::vector<glm::vec3> expected;
+    if (write) {
+        std::mt19937 rng(1549u);
+        for (int i = 0; i < kQueryCount; i++)
+            queries.push_back(test::randomQuery(rng));
+    }
+    else if (!readReference(fileName, queries, expected)) {
+        return 1;
+    }
+
+    std::vector<glm::vec3> values(queries.size());
+    evaluate(dict, params, queries.data(), queries.size(), values.data());
+
+    if (write)
+        return writeReference(fileName, queries, values) ? 0 : 1;
+
+    CHECK(!queries.empty());
+    int nonZero = 0;
+    for (size_t i = 0; i < queries.size(); i++) {
+        for (int c = 0; c < 3; c++) {
+            float error = std::fabs(values[i][c] - expected[i][c]);
+            if (!(error <= tolerance * (1.f + std::fabs(expected[i][c])))) {
+                std::cerr << "Query " << i << ", channel " << c << ": " << values[i][c]
+                          << " instead of " << expected[i][c] << std::endl;
+                test::failureCount()++;
+            }
+        }
+        if (expected[i].x != 0.f)
+            nonZero++;
+    }
+    std::cout << queries.size() << " queries, " << nonZero << " with glints" << std::endl;
+    return test::testResult();
+}
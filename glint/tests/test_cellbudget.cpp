@@ -0,0 +1,97 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// CellBudgetController against a simulated GPU whose frame time is linear
+// in the number of visited cells and is read back a few frames late, as
+// with the timer queries of SceneObj.
+
+#include "glinttest.h"
+#include "cellbudget.h"
+
+#include <algorithm>
+#include <deque>
+
+using namespace glint;
+
+struct SimulatedGpu {
+    float baseMs;       // Frame time without glints
+    float msPerCell;    // Cost of one cell of the budget
+    std::deque<float> pending;
+
+    // Time of the frame rendered with maxCells, returns the time of the
+    // frame of latency frames ago (the last one available)
+    float frame(int maxCells, int latency = 3)
+    {
+        pending.push_back(baseMs + msPerCell * float(maxCells));
+        float ms = pending.front();
+        if (int(pending.size()) > latency)
+            pending.pop_front();
+        return ms;
+    }
+};
+
+int main()
+{
+    const float targetMs = 16.6f;
+    CellBudgetController controller(targetMs);
+
+    // Unconstrained budget
+    CellBudget budget = controller.Budget();
+    CHECK(budget.maxCells == kMaxGlintCells);
+    CHECK(budget.maxAnisotropy == 4.f);
+
+    // 100 cells take 40 ms: whatever the latency of the measures, the
+    // budget converges below the target, above the recover margin,
+    // without oscillating
+    for (int latency = 1; latency <= 4; latency++) {
+        CellBudgetController heavy(targetMs);
+        CellBudget heavyBudget = heavy.Budget();
+        SimulatedGpu gpu = { 4.f, 0.36f, {} };
+        int minCells = kMaxGlintCells, maxCells = 0;
+        float lastMs = 0.f;
+        for (int frame = 0; frame < 300; frame++) {
+            lastMs = gpu.frame(heavyBudget.maxCells, latency);
+            heavyBudget = heavy.update(lastMs);
+            if (frame >= 200) {
+                minCells = std::min(minCells, heavyBudget.maxCells);
+                maxCells = std::max(maxCells, heavyBudget.maxCells);
+            }
+        }
+        std::cout << "Heavy load, latency " << latency << ": " << minCells << " to "
+                  << maxCells << " cells, " << lastMs << " ms" << std::endl;
+        CHECK(lastMs <= targetMs);
+        CHECK(lastMs >= 0.6f * targetMs);
+        CHECK(maxCells - minCells <= 2);
+        CHECK(heavyBudget.maxAnisotropy >= 1.f && heavyBudget.maxAnisotropy < 4.f);
+    }
+
+    // Far above the target: the budget bottoms out at the minimum, with
+    // isotropic footprints
+    SimulatedGpu slowGpu = { 30.f, 0.36f, {} };
+    for (int frame = 0; frame < 100; frame++)
+        budget = controller.update(slowGpu.frame(budget.maxCells));
+    CHECK(budget.maxCells == 8);
+    CHECK(budget.maxAnisotropy == 1.f);
+
+    // The load goes away: back to the unconstrained budget
+    SimulatedGpu lightGpu = { 2.f, 0.05f, {} };
+    for (int frame = 0; frame < 150; frame++)
+        budget = controller.update(lightGpu.frame(budget.maxCells));
+    CHECK(budget.maxCells == kMaxGlintCells);
+    CHECK(budget.maxAnisotropy == 4.f);
+
+    // reset() restores the unconstrained budget at once
+    for (int frame = 0; frame < 10; frame++)
+        controller.update(4.f * targetMs);
+    CHECK(controller.Budget().maxCells < kMaxGlintCells);
+    controller.reset();
+    CHECK(controller.Budget().maxCells == kMaxGlintCells);
+
+    return test::testResult();
+}
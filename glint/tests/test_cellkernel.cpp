@@ -0,0 +1,98 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// The scalar, AVX2 and AVX-512 cell kernels must return exactly the values
+// of P22_M. Random batches of cells are evaluated by every kernel supported
+// by the build and the CPU, and compared bit for bit.
+
+#include "glinttest.h"
+#include "cellkernel.h"
+
+#include <cstring>
+
+using namespace glint;
+
+int main()
+{
+    Dictionary dict;
+    if (!test::loadDictionary(dict))
+        return 1;
+
+    const CellKernel kernels[] = { CellKernel::Scalar, CellKernel::AVX2, CellKernel::AVX512 };
+    bool supported[3];
+    for (int k = 0; k < 3; k++) {
+        setCellKernel(kernels[k]);
+        supported[k] = getCellKernel() == kernels[k];
+        std::cout << cellKernelName(kernels[k])
+                  << (supported[k] ? ": tested" : ": not supported, skipped") << std::endl;
+    }
+
+    std::mt19937 rng(1549u);
+    std::uniform_real_distribution<float> u(0.f, 1.f);
+    std::uniform_int_distribution<int> cell(-40000, 40000);
+    const float areas[] = { 0.025f, 0.5f, 1.f };
+
+    // Without GLINT_SIMD, only the scalar kernel exists: kernels are selected
+    // with setCellKernel rather than called by name
+    int evaluatedCells = 0;
+    int nonZeroCells = 0;
+    for (int footprintIndex = 0; footprintIndex < 2000; footprintIndex++) {
+        GlintParams params;
+        params.microfacetRelativeArea = areas[footprintIndex % 3];
+        params.filter = (footprintIndex / 3) % 2 == 0;
+
+        int l = int(u(rng) * float(dict.NLevels() + 1));
+        glm::vec2 slope_h((u(rng) - 0.5f) * 2.f, (u(rng) - 0.5f) * 2.f);
+        glm::vec2 slope_dx((u(rng) - 0.5f) * 0.1f, (u(rng) - 0.5f) * 0.1f);
+        glm::vec2 slope_dy((u(rng) - 0.5f) * 0.1f, (u(rng) - 0.5f) * 0.1f);
+        glm::vec3 sigmas(0.05f + 0.45f * u(rng), 0.05f + 0.45f * u(rng), u(rng) - 0.5f);
+        float l_dist = u(rng) * float(dict.NLevels() + 2);
+
+        CellFootprint footprint(dict, params, slope_h, l, slope_dx, slope_dy, sigmas, l_dist);
+        CellBatch batch;
+        batch.count = 1 + int(u(rng) * float(kCellBatchSize - 1));
+        for (int k = 0; k < batch.count; k++) {
+            // Neighbouring cells, as in a footprint, or anywhere
+            batch.s[k] = k % 2 ? cell(rng) : (k > 0 ? batch.s[k - 1] + 1 : cell(rng));
+            batch.t[k] = k % 2 ? cell(rng) : (k > 0 ? batch.t[k - 1] : cell(rng));
+            batch.weight[k] = u(rng);
+        }
+
+        float expected[kCellBatchSize];
+        for (int k = 0; k < batch.count; k++)
+            expected[k] = P22_M(dict, params, slope_h, l, batch.s[k], batch.t[k],
+                                slope_dx, slope_dy, sigmas, l_dist);
+
+        for (int k = 0; k < 3; k++) {
+            if (!supported[k])
+                continue;
+            float p22[kCellBatchSize];
+            setCellKernel(kernels[k]);
+            evaluateCells(footprint, batch, p22);
+            for (int c = 0; c < batch.count; c++) {
+                if (std::memcmp(&p22[c], &expected[c], sizeof(float)) != 0) {
+                    std::cerr << cellKernelName(kernels[k]) << ", footprint " << footprintIndex
+                              << ", cell (" << batch.s[c] << ", " << batch.t[c] << "): "
+                              << p22[c] << " instead of " << expected[c] << std::endl;
+                    test::failureCount()++;
+                }
+            }
+        }
+
+        setCellKernel(bestCellKernel());
+
+        evaluatedCells += batch.count;
+        for (int c = 0; c < batch.count; c++)
+            nonZeroCells += expected[c] != 0.f;
+    }
+
+    std::cout << evaluatedCells << " cells, " << nonZeroCells << " non-zero" << std::endl;
+    CHECK(nonZeroCells > evaluatedCells / 10);
+    return test::testResult();
+}
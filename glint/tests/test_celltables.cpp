@@ -0,0 +1,71 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Precomputed cell tables (celltables.h) against the hashes of P22_M.
+
+#include "glinttest.h"
+#include "celltables.h"
+
+using namespace glint;
+
+static const int kLevelCount = 17; // NLevels + 1, as SceneObj
+
+// Every bit of every level is the relative area test of P22_M, for the
+// user default, a few material values and thresholds equal to the hash of
+// a cell (the cell must be kept)
+static void testOccupancyBitmask(const Dictionary& dict)
+{
+    std::vector<float> areas = { 0.025f, 0.1f, 0.5f, 0.99f, 1.f };
+    areas.push_back(hashIQ(cellSeed(0, 17, 42) * 13U));
+    areas.push_back(hashIQ(cellSeed(7, 255, 3) * 13U));
+
+    for (float area : areas) {
+        std::vector<uint32_t> words = occupancyBitmask(area, kLevelCount);
+        CHECK(words.size() == size_t(kLevelCount) * kOccupancyWordsPerLevel);
+
+        int mismatches = 0;
+        for (int l = 0; l < kLevelCount; l++) {
+            const uint32_t* level = &words[size_t(l) * kOccupancyWordsPerLevel];
+            for (int t = 0; t < kCellTileSize; t++) {
+                for (int s = 0; s < kCellTileSize; s++) {
+                    bool bit = (level[(t * kCellTileSize + s) / 32] >> (s % 32) & 1U) != 0;
+                    // Test of P22_M: discarded when the hash is greater
+                    bool kept = !(hashIQ(cellSeed(l, s, t) * 13U) > area);
+                    mismatches += bit != kept;
+                }
+            }
+        }
+        CHECK(mismatches == 0);
+    }
+
+    // Cells that the bitmask skips are cells that P22_M discards
+    GlintParams params;
+    std::vector<uint32_t> words = occupancyBitmask(params.microfacetRelativeArea, kLevelCount);
+    std::mt19937 rng(1549u);
+    std::uniform_int_distribution<int> cell(0, kCellTileSize - 1);
+    std::uniform_int_distribution<int> level(0, dict.NLevels() - 1);
+    for (int i = 0; i < 10000; i++) {
+        int l = level(rng), s = cell(rng), t = cell(rng);
+        bool bit = (words[size_t(l) * kOccupancyWordsPerLevel
+                          + (t * kCellTileSize + s) / 32] >> (s % 32) & 1U) != 0;
+        if (!bit)
+            CHECK(P22_M(dict, params, glm::vec2(0.f), l, s, t, glm::vec2(0.f),
+                        glm::vec2(0.f), glm::vec3(0.3f, 0.3f, 0.f), 0.f) == 0.f);
+    }
+}
+
+int main()
+{
+    Dictionary dict;
+    if (!test::loadDictionary(dict))
+        return 1;
+
+    testOccupancyBitmask(dict);
+    return test::testResult();
+}
@@ -0,0 +1,49 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Error of the half-precision path (GlintParams::float16) against float32,
+// see measureFloat16Error.
+//
+//   test_float16 [query count]
+
+#include "glinttest.h"
+
+#include <cstdlib>
+#include <vector>
+
+using namespace glint;
+
+int main(int argc, char* argv[])
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 20000;
+
+    Dictionary dict;
+    if (!test::loadDictionary(dict))
+        return 1;
+
+    std::mt19937 rng(1549u);
+    std::vector<GlintQuery> queries;
+    for (int i = 0; i < count; i++)
+        queries.push_back(test::randomQuery(rng));
+
+    const float areas[] = { 0.025f, 0.5f };
+    for (float area : areas) {
+        GlintParams params;
+        params.microfacetRelativeArea = area;
+        Float16Error error = measureFloat16Error(dict, params, queries.data(), queries.size());
+        std::cout << "Relative area " << area << ": " << error.count << " queries, "
+                  << error.nonFinite << " overflowed, max abs error " << error.maxAbsError
+                  << ", relative L1 error " << error.relativeL1Error << std::endl;
+
+        CHECK(error.count == queries.size());
+        CHECK(error.nonFinite == 0);
+        CHECK(error.relativeL1Error < 1e-3);
+    }
+    return test::testResult();
+}
@@ -0,0 +1,156 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Page table of the radiance cache: feedback encoding, on demand mapping,
+// least recently used eviction, shading budget and invalidation.
+
+#include "glinttest.h"
+#include "radiancecache.h"
+
+using namespace glint;
+
+static bool samePage(const CachePage& a, const CachePage& b)
+{
+    return a.mesh == b.mesh && a.level == b.level && a.x == b.x && a.y == b.y;
+}
+
+static uint32_t page(int mesh, int level, int x, int y)
+{
+    return packCachePage({ mesh, level, x, y });
+}
+
+static bool contains(const std::vector<CacheUpdate>& updates, uint32_t key)
+{
+    for (const CacheUpdate& u : updates)
+        if (packCachePage(u.page) == key)
+            return true;
+    return false;
+}
+
+static void testPacking()
+{
+    const CachePage pages[] = { { 0, 0, 0, 0 }, { 3, 2, 17, 99 },
+                                { 0x3FFF, kCacheLevels - 1, 127, 127 } };
+    for (const CachePage& p : pages) {
+        uint32_t packed = packCachePage(p);
+        CHECK(packed != 0u);
+        CHECK(samePage(unpackCachePage(packed), p));
+    }
+}
+
+static void testMappingAndEviction()
+{
+    RadianceCache cache(4);
+    const uint32_t coarsest = page(0, kCacheLevels - 1, 0, 0);
+    const uint32_t a = page(0, 0, 1, 1), b = page(0, 0, 2, 1), c = page(0, 1, 3, 1);
+    const uint32_t d = page(0, 0, 4, 4);
+
+    // Frame 0: the three pages and the coarsest page of the mesh, coarse
+    // levels first, each in its own slot
+    const uint32_t feedback0[] = { a, 0u, b, c, a };
+    cache.request(feedback0, 5);
+    std::vector<CacheUpdate> updates = cache.pagesToShade(16);
+    CHECK(updates.size() == 4);
+    CHECK(packCachePage(updates[0].page) == coarsest);
+    for (size_t i = 1; i < updates.size(); i++)
+        CHECK(updates[i - 1].page.level >= updates[i].page.level);
+    CHECK(contains(updates, a) && contains(updates, b) && contains(updates, c));
+    CHECK(cache.ResidentPageCount() == 4);
+
+    std::vector<PageTableEntry> entries = cache.takePageTableUpdates();
+    CHECK(entries.size() == 4);
+    unsigned usedSlots = 0;
+    for (const PageTableEntry& e : entries) {
+        CHECK(e.value >= 1 && e.value <= 4);
+        usedSlots |= 1u << (e.value - 1);
+    }
+    CHECK(usedSlots == 0xFu);
+    CHECK(cache.takePageTableUpdates().empty());
+
+    // Frame 1: a is used again, d is new. The atlas is full: the least
+    // recently used page (b or c) is evicted, and its slot goes to d
+    const uint32_t feedback1[] = { a, d };
+    cache.request(feedback1, 2);
+    updates = cache.pagesToShade(16);
+    CHECK(updates.size() == 1 && packCachePage(updates[0].page) == d);
+    entries = cache.takePageTableUpdates();
+    CHECK(entries.size() == 2);
+    if (entries.size() == 2) {
+        uint32_t evicted = packCachePage(entries[0].page);
+        CHECK(entries[0].value == 0);
+        CHECK(evicted == b || evicted == c);
+        CHECK(packCachePage(entries[1].page) == d);
+        CHECK(entries[1].value == updates[0].slot + 1);
+    }
+    CHECK(cache.ResidentPageCount() == 4);
+
+    // Frame 2: resident pages cost nothing
+    cache.request(feedback1, 2);
+    CHECK(cache.pagesToShade(16).empty());
+    CHECK(cache.takePageTableUpdates().empty());
+
+    // Frame 3: more missing pages than slots not requested this frame.
+    // Only one page can be evicted (the one of b or c that is left)
+    const uint32_t feedback3[] = { a, d, page(0, 0, 9, 9), page(0, 0, 10, 9), page(0, 0, 11, 9) };
+    cache.request(feedback3, 5);
+    updates = cache.pagesToShade(16);
+    CHECK(updates.size() == 1);
+    CHECK(cache.ResidentPageCount() == 4);
+}
+
+static void testBudgetAndInvalidation()
+{
+    RadianceCache cache(64);
+    std::vector<uint32_t> feedback;
+    for (int x = 0; x < 10; x++)
+        feedback.push_back(page(1, 0, x, 0));
+
+    // The budget limits the pages shaded per frame: the missing pages are
+    // shaded over the next frames, as long as they are requested
+    cache.request(feedback.data(), feedback.size());
+    CHECK(cache.pagesToShade(4).size() == 4);
+    cache.request(feedback.data(), feedback.size());
+    CHECK(cache.pagesToShade(4).size() == 4);
+    cache.request(feedback.data(), feedback.size());
+    CHECK(cache.pagesToShade(4).size() == 3);
+    cache.request(feedback.data(), feedback.size());
+    CHECK(cache.pagesToShade(4).empty());
+    CHECK(cache.ResidentPageCount() == 11);
+    cache.takePageTableUpdates();
+
+    // Shading state: small moves keep the cache
+    std::vector<float> state = { 1.f, 2.f, 100.f };
+    CHECK(cache.setShadingState(state, 1e-3f));
+    cache.request(feedback.data(), feedback.size());
+    cache.pagesToShade(64);
+    state[2] = 100.05f;
+    CHECK(!cache.setShadingState(state, 1e-3f));
+    cache.request(feedback.data(), feedback.size());
+    CHECK(cache.pagesToShade(64).empty());
+
+    // Invalidated pages are shaded again in place, only when requested
+    state[0] = 1.1f;
+    CHECK(cache.setShadingState(state, 1e-3f));
+    cache.request(feedback.data(), 3);
+    std::vector<CacheUpdate> updates = cache.pagesToShade(64);
+    CHECK(updates.size() == 4);     // 3 pages and the coarsest one
+    CHECK(cache.takePageTableUpdates().empty());
+    cache.request(feedback.data(), 3);
+    CHECK(cache.pagesToShade(64).empty());
+    cache.request(feedback.data(), feedback.size());
+    CHECK(cache.pagesToShade(64).size() == 7);
+}
+
+int main()
+{
+    testPacking();
+    testMappingAndEviction();
+    testBudgetAndInvalidation();
+    return test::testResult();
+}
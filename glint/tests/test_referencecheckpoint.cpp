@@ -0,0 +1,148 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Reference checkpoints: bit exact round trip, atomic replacement, and
+// rejection of truncated or foreign files.
+
+#include "glinttest.h"
+#include "referencecheckpoint.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+using namespace glint;
+
+static ReferenceCheckpoint makeCheckpoint(int width, int height, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(-10.f, 10.f);
+
+    ReferenceCheckpoint c;
+    c.width = width;
+    c.height = height;
+    c.cameraPosition = glm::vec3(u(rng), u(rng), u(rng));
+    c.cameraYaw = u(rng);
+    c.cameraPitch = u(rng);
+    c.samplesPerPixel = 1024;
+    c.sequence = 2;
+    c.shaderSamples = 1;
+    c.sampleCount = 77;
+    c.adaptive = true;
+    c.samplesPerRound = 4;
+    c.errorThreshold = 0.01f;
+    c.convergedTarget = 0.99f;
+    c.minSamples = 16;
+    c.tilesValid = true;
+    c.scissor = glm::ivec4(32, 0, 64, 96);
+    c.convergedFraction = 0.75f;
+    c.tileCounts.resize(6);
+    for (float& v : c.tileCounts)
+        v = float(int(u(rng) + 10.f));
+    c.mean.resize(size_t(width) * height * 4);
+    c.m2.resize(c.mean.size());
+    for (size_t i = 0; i < c.mean.size(); i++) {
+        c.mean[i] = u(rng);
+        c.m2[i] = std::fabs(u(rng));
+    }
+    // Values that a text format would not keep
+    c.mean[0] = 1.f / 3.f;
+    c.mean[1] = 1e-42f;
+    return c;
+}
+
+static bool sameFloats(const std::vector<float>& a, const std::vector<float>& b)
+{
+    return a.size() == b.size()
+        && (a.empty() || std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0);
+}
+
+static bool sameCheckpoint(const ReferenceCheckpoint& a, const ReferenceCheckpoint& b)
+{
+    return a.width == b.width && a.height == b.height
+        && std::memcmp(&a.cameraPosition, &b.cameraPosition, sizeof(a.cameraPosition)) == 0
+        && a.cameraYaw == b.cameraYaw && a.cameraPitch == b.cameraPitch
+        && a.samplesPerPixel == b.samplesPerPixel && a.sequence == b.sequence
+        && a.shaderSamples == b.shaderSamples && a.sampleCount == b.sampleCount
+        && a.adaptive == b.adaptive && a.samplesPerRound == b.samplesPerRound
+        && a.errorThreshold == b.errorThreshold && a.convergedTarget == b.convergedTarget
+        && a.minSamples == b.minSamples && a.tilesValid == b.tilesValid
+        && a.scissor.x == b.scissor.x && a.scissor.y == b.scissor.y
+        && a.scissor.z == b.scissor.z && a.scissor.w == b.scissor.w
+        && a.convergedFraction == b.convergedFraction
+        && sameFloats(a.tileCounts, b.tileCounts)
+        && sameFloats(a.mean, b.mean) && sameFloats(a.m2, b.m2);
+}
+
+static std::string readFile(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+static void writeFile(const std::string& path, const std::string& bytes)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), std::streamsize(bytes.size()));
+}
+
+static bool fileExists(const std::string& path)
+{
+    return bool(std::ifstream(path));
+}
+
+int main()
+{
+    const std::string path = "test_referencecheckpoint.ckpt";
+    std::remove(path.c_str());
+
+    // Round trip, bit for bit
+    ReferenceCheckpoint written = makeCheckpoint(5, 3, 1u);
+    CHECK(writeReferenceCheckpoint(path, written));
+    CHECK(!fileExists(path + ".tmp"));
+    ReferenceCheckpoint read;
+    CHECK(readReferenceCheckpoint(path, read));
+    CHECK(sameCheckpoint(written, read));
+
+    // A new checkpoint replaces the previous one
+    ReferenceCheckpoint next = makeCheckpoint(7, 2, 2u);
+    CHECK(writeReferenceCheckpoint(path, next));
+    CHECK(readReferenceCheckpoint(path, read));
+    CHECK(sameCheckpoint(next, read));
+
+    // Every truncation is rejected
+    const std::string bytes = readFile(path);
+    const std::string truncatedPath = path + ".truncated";
+    int accepted = 0;
+    for (size_t size = 0; size < bytes.size(); size++) {
+        writeFile(truncatedPath, bytes.substr(0, size));
+        accepted += readReferenceCheckpoint(truncatedPath, read);
+    }
+    CHECK(accepted == 0);
+
+    // Other files: missing, not a checkpoint, other version, corrupted size
+    CHECK(!readReferenceCheckpoint(path + ".missing", read));
+    std::string corrupted = bytes;
+    corrupted[0] = 'X';
+    writeFile(truncatedPath, corrupted);
+    CHECK(!readReferenceCheckpoint(truncatedPath, read));
+    corrupted = bytes;
+    corrupted[8] = char(corrupted[8] + 1);
+    writeFile(truncatedPath, corrupted);
+    CHECK(!readReferenceCheckpoint(truncatedPath, read));
+    corrupted = bytes;
+    corrupted[12] = char(0x7f); // width
+    writeFile(truncatedPath, corrupted);
+    CHECK(!readReferenceCheckpoint(truncatedPath, read));
+
+    std::remove(truncatedPath.c_str());
+    std::remove(path.c_str());
+    return test::testResult();
+}
@@ -0,0 +1,147 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Subpixel sample sequences of the reference renders (sampler.h):
+// stratification of the complete sequences and even coverage of every
+// prefix.
+
+#include "glinttest.h"
+#include "sampler.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace glint;
+
+static const SampleSequence kSequences[] = {
+    SampleSequence::Grid, SampleSequence::Sobol, SampleSequence::R2, SampleSequence::BlueNoise };
+
+// Number of samples of [0, count) in each cell of a cellsX x cellsY grid
+static std::vector<int> strata(const PixelSampler& sampler, int count, int cellsX, int cellsY)
+{
+    std::vector<int> counts(size_t(cellsX) * cellsY, 0);
+    for (int i = 0; i < count; i++) {
+        glm::vec2 p = sampler.Sample(i);
+        counts[size_t(int(p.y * float(cellsY))) * cellsX + int(p.x * float(cellsX))]++;
+    }
+    return counts;
+}
+
+static void testNames()
+{
+    for (SampleSequence s : kSequences) {
+        SampleSequence parsed = SampleSequence::Grid;
+        CHECK(parseSampleSequence(sampleSequenceName(s), parsed));
+        CHECK(parsed == s);
+    }
+    SampleSequence unchanged = SampleSequence::R2;
+    CHECK(!parseSampleSequence("halton", unchanged));
+    CHECK(unchanged == SampleSequence::R2);
+}
+
+static void testRangeAndDeterminism()
+{
+    for (SampleSequence s : kSequences) {
+        for (int count : { 0, 1, 7, 64, 100, 1024 }) {
+            PixelSampler a, b;
+            a.configure(s, count);
+            b.configure(s, count);
+            CHECK(a.Sequence() == s);
+            CHECK(a.Count() == std::max(count, 1));
+            for (int i = 0; i < a.Count(); i++) {
+                glm::vec2 p = a.Sample(i);
+                CHECK(p.x >= 0.f && p.x < 1.f && p.y >= 0.f && p.y < 1.f);
+                CHECK(p.x == b.Sample(i).x && p.y == b.Sample(i).y);
+            }
+        }
+    }
+}
+
+// Complete sequences: one sample per stratum
+static void testStratification()
+{
+    // Grid and blue noise, square counts: one sample per pixel of the grid
+    for (SampleSequence s : { SampleSequence::Grid, SampleSequence::BlueNoise }) {
+        for (int size : { 1, 2, 4, 8, 16, 32 }) {
+            PixelSampler sampler;
+            sampler.configure(s, size * size);
+            std::vector<int> counts = strata(sampler, size * size, size, size);
+            CHECK(std::all_of(counts.begin(), counts.end(), [](int c) { return c == 1; }));
+        }
+    }
+
+    // Sobol: the first 2^m samples are a (0, m, 2)-net, one sample in each
+    // elementary interval of area 2^-m
+    PixelSampler sobol;
+    sobol.configure(SampleSequence::Sobol, 1 << 12);
+    for (int m = 0; m <= 12; m++) {
+        for (int a = 0; a <= m; a++) {
+            std::vector<int> counts = strata(sobol, 1 << m, 1 << a, 1 << (m - a));
+            CHECK(std::all_of(counts.begin(), counts.end(), [](int c) { return c == 1; }));
+        }
+    }
+    // And so is every block of 2^m samples that follows
+    for (int block = 1; block < 16; block++) {
+        std::vector<int> counts(64, 0);
+        for (int i = block * 64; i < (block + 1) * 64; i++) {
+            glm::vec2 p = sobol.Sample(i);
+            counts[size_t(int(p.y * 8.f)) * 8 + int(p.x * 8.f)]++;
+        }
+        CHECK(std::all_of(counts.begin(), counts.end(), [](int c) { return c == 1; }));
+    }
+}
+
+// Every prefix covers the pixel evenly: its quadrants hold a quarter of the
+// samples and its sum is k / 2 per axis, up to a few samples
+static void testPrefixes()
+{
+    for (SampleSequence s : kSequences) {
+        PixelSampler sampler;
+        sampler.configure(s, 256);
+        int worstQuadrant = 0;
+        float worstSum = 0.f;
+        glm::vec2 sum(0.f);
+        int quadrants[4] = { 0, 0, 0, 0 };
+        for (int k = 1; k <= sampler.Count(); k++) {
+            glm::vec2 p = sampler.Sample(k - 1);
+            sum += p;
+            quadrants[(p.y >= 0.5f ? 2 : 0) + (p.x >= 0.5f ? 1 : 0)]++;
+            if (k < 16)
+                continue;
+            for (int q = 0; q < 4; q++)
+                worstQuadrant = std::max(worstQuadrant, std::abs(4 * quadrants[q] - k));
+            worstSum = std::max(worstSum, std::max(std::fabs(sum.x - 0.5f * float(k)),
+                                                   std::fabs(sum.y - 0.5f * float(k))));
+        }
+        std::cout << sampleSequenceName(s) << ": worst quadrant error "
+                  << 0.25f * float(worstQuadrant) << " samples, worst sum error "
+                  << worstSum << " samples" << std::endl;
+        CHECK(worstQuadrant <= 4 * 4);
+        CHECK(worstSum <= 4.f);
+    }
+
+    // The Sobol and R2 sequences do not depend on the count: shorter
+    // references are prefixes of longer ones
+    for (SampleSequence s : { SampleSequence::Sobol, SampleSequence::R2 }) {
+        PixelSampler shorter, longer;
+        shorter.configure(s, 100);
+        longer.configure(s, 1000);
+        for (int i = 0; i < shorter.Count(); i++)
+            CHECK(shorter.Sample(i).x == longer.Sample(i).x && shorter.Sample(i).y == longer.Sample(i).y);
+    }
+}
+
+int main()
+{
+    testNames();
+    testRangeAndDeterminism();
+    testStratification();
+    testPrefixes();
+    return test::testResult();
+}
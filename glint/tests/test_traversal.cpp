@@ -0,0 +1,184 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// Cells tested by the scan of the ellipse bounding boxes and cells visited
+// by the span traversal of P22__glint_discrete_LOD (TraversalStats), and
+// evaluation time, over random anisotropic queries. Occupied cells of the
+// span traversal read from the occupancy bitmask, as the shader does.
+//
+//   test_traversal [query count]
+
+#include "glinttest.h"
+
+#include "celltables.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+using namespace glint;
+
+static const int kLevelCount = 17; // NLevels + 1, as SceneObj
+
+// Span traversal of P22__glint_discrete_LOD_cells at level l, in cells,
+// visited cells firstCell to endCell - 1. The occupancy of a cell is read
+// from the word of the bitmask cached for the row, and compared with the
+// relative area test of P22_M. Returns the number of visited cells.
+static int occupancyTraversal(const uint32_t* level, float area, int l, glm::vec2 st,
+                              glm::vec2 dst0, glm::vec2 dst1, int firstCell, int endCell,
+                              std::vector<bool>& occupied, int& mismatches, int& unalignedRows)
+{
+    float A = dst0[1] * dst0[1] + dst1[1] * dst1[1] + 1.f;
+    float B = -2.f * (dst0[0] * dst0[1] + dst1[0] * dst1[1]);
+    float C = dst0[0] * dst0[0] + dst1[0] * dst1[0] + 1.f;
+    float invF = 1.f / (A * C - B * B * 0.25f);
+    A *= invF;
+    B *= invF;
+    C *= invF;
+    float det = -B * B + 4.f * A * C;
+    float invDet = 1.f / det;
+    float uSqrt = std::sqrt(det * C), vSqrt = std::sqrt(A * det);
+    int s0 = int(std::ceil(st[0] - 2.f * invDet * uSqrt));
+    int s1 = int(std::floor(st[0] + 2.f * invDet * uSqrt));
+    int t0 = int(std::ceil(st[1] - 2.f * invDet * vSqrt));
+    int t1 = int(std::floor(st[1] + 2.f * invDet * vSqrt));
+    // Only the footprints inside the tile read the bitmask
+    if (s0 < 0 || t0 < 0 || s1 >= kCellTileSize || t1 >= kCellTileSize)
+        return 0;
+
+    int nbrOfIter = 0;
+    for (int it = t0; it <= t1; ++it)
+    {
+        float tt = float(it) - st[1];
+        float b = B * tt;
+        float c = C * tt * tt - 1.f;
+        float delta = b * b - 4.f * A * c;
+        if (delta < 0.f)
+            continue;
+        float sqrtDelta = std::sqrt(delta);
+        int is0 = std::max(s0, int(std::ceil(st[0] + (-b - sqrtDelta) / (2.f * A))));
+        int is1 = std::min(s1, int(std::floor(st[0] + (-b + sqrtDelta) / (2.f * A))));
+        float ss0 = float(is0 - 1) - st[0];
+        float ss1 = float(is1 + 1) - st[0];
+        if (is0 > s0 && A * ss0 * ss0 + B * ss0 * tt + C * tt * tt < 1.f) --is0;
+        if (is1 < s1 && A * ss1 * ss1 + B * ss1 * tt + C * tt * tt < 1.f) ++is1;
+        if (is0 <= is1 && is0 % 32 != 0)
+            unalignedRows++;
+
+        int occupancyWord = (is0 >> 5) - 1;
+        uint32_t occupancyBits = 0u;
+        for (int is = is0; is <= is1; ++is)
+        {
+            float ss = float(is) - st[0];
+            float r2 = A * ss * ss + B * ss * tt + C * tt * tt;
+            if (r2 < 1.f && nbrOfIter++ >= firstCell)
+            {
+                if (is >> 5 != occupancyWord)
+                {
+                    occupancyWord = is >> 5;
+                    occupancyBits = level[it * kCellTileSize / 32 + (is >> 5)];
+                }
+                bool bit = ((occupancyBits >> uint32_t(is & 31)) & 1u) != 0u;
+                bool kept = !(hashIQ(cellSeed(l, is, it) * 13U) > area);
+                if (bit != kept)
+                    mismatches++;
+                if (bit)
+                    occupied[size_t(it) * kCellTileSize + size_t(is)] = true;
+            }
+            if (nbrOfIter >= endCell)
+                break;
+        }
+        if (nbrOfIter >= endCell)
+            break;
+    }
+    return nbrOfIter;
+}
+
+// The bitmask traversal visits the occupied cells of the hash traversal,
+// over the whole footprint and over chunks of 16 cells (glint_tiled.comp)
+static void testOccupancyTraversal(std::mt19937& rng, int count)
+{
+    const float area = 0.5f;
+    std::vector<uint32_t> words = occupancyBitmask(area, kLevelCount);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+
+    int mismatches = 0, unalignedRows = 0, footprints = 0;
+    long long cells = 0;
+    for (int i = 0; i < count; i++)
+    {
+        int l = int(unit(rng) * float(kLevelCount - 1));
+        float radius = 0.5f + 40.f * unit(rng) * unit(rng);
+        float aspect = 0.1f + 0.9f * unit(rng);
+        float angle = 6.283185f * unit(rng);
+        glm::vec2 dst0(radius * std::cos(angle), radius * std::sin(angle));
+        glm::vec2 dst1(-aspect * dst0[1], aspect * dst0[0]);
+        glm::vec2 st(48.f + 160.f * unit(rng), 48.f + 160.f * unit(rng));
+        const uint32_t* level = &words[size_t(l) * kOccupancyWordsPerLevel];
+
+        std::vector<bool> whole(size_t(kCellTileSize) * kCellTileSize, false);
+        std::vector<bool> chunked(whole.size(), false);
+        int unaligned = 0;
+        int visited = occupancyTraversal(level, area, l, st, dst0, dst1, 0, 1 << 30,
+                                         whole, mismatches, unaligned);
+        if (visited == 0)
+            continue;
+        for (int first = 0; first < visited; first += 16)
+        {
+            int ignored = 0;
+            occupancyTraversal(level, area, l, st, dst0, dst1, first, first + 16,
+                               chunked, mismatches, ignored);
+        }
+        CHECK(whole == chunked);
+        unalignedRows += unaligned;
+        footprints++;
+        cells += visited;
+    }
+
+    std::cout << footprints << " footprints, " << cells << " cells, " << unalignedRows
+              << " rows starting inside a word, " << mismatches << " occupancy mismatches"
+              << std::endl;
+    CHECK(footprints > 0);
+    CHECK(unalignedRows > 0);
+    CHECK(mismatches == 0);
+}
+
+int main(int argc, char* argv[])
+{
+    int count = argc > 1 ? std::atoi(argv[1]) : 50000;
+
+    Dictionary dict;
+    if (!test::loadDictionary(dict))
+        return 1;
+    GlintParams params;
+
+    std::mt19937 rng(1549u);
+    std::vector<GlintQuery> queries;
+    for (int i = 0; i < count; i++)
+        queries.push_back(test::randomQuery(rng));
+
+    std::vector<glm::vec3> results(queries.size());
+    TraversalStats stats;
+    auto start = std::chrono::steady_clock::now();
+    evaluate(dict, params, queries.data(), queries.size(), results.data(), &stats);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << count << " queries: " << stats.boundingBoxCells << " bounding box cells, "
+              << stats.visitedCells << " visited cells ("
+              << 100. * double(stats.visitedCells) / double(stats.boundingBoxCells) << "%), "
+              << 1e6 * seconds / double(count) << " us per query" << std::endl;
+
+    // The spans are inside the bounding boxes, and the ellipses do not
+    // fill them
+    CHECK(stats.visitedCells > 0);
+    CHECK(stats.visitedCells < stats.boundingBoxCells);
+
+    testOccupancyTraversal(rng, 2000);
+    return test::testResult();
+}
@@ -0,0 +1,58 @@
+// The MIT License
+// Copyright © 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions: The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software. THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+// Implementation of
+// Real-Time Geometric Glint Anti-Aliasing with Normal Map Filtering
+// 2021 Xavier Chermain (ICUBE), Simon Lucas(ICUBE), Basile Sauvage (ICUBE), Jean-Michel Dishler (ICUBE) and Carsten Dachsbacher (KIT)
+// Accepted for [i3D 2021](http://i3dsymposium.github.io/2021/).
+
+// f_P_upper_bound must bound f_P for any footprint: random queries, with
+// half vectors around the normal and anywhere in the hemisphere.
+
+#include "glinttest.h"
+
+using namespace glint;
+
+int main()
+{
+    Dictionary dict;
+    if (!test::loadDictionary(dict))
+        return 1;
+
+    std::mt19937 rng(1549u);
+    const float areas[] = { 0.025f, 0.5f, 1.f };
+    int evaluated = 0, nonZero = 0, violations = 0;
+    double sumRatio = 0.;
+    for (int i = 0; i < 600; i++) {
+        GlintParams params;
+        params.microfacetRelativeArea = areas[i % 3];
+        params.filter = (i / 3) % 2 == 0;
+
+        GlintQuery q = test::randomQuery(rng);
+        if (i % 4 == 0)
+            q.wi = test::randomDirection(rng);
+
+        glm::vec3 wh = glm::normalize(q.wo + q.wi);
+        if (wh.z <= 0.f || glm::dot(q.wo, wh) <= 0.f || glm::dot(q.wi, wh) <= 0.f)
+            continue;
+
+        float f = f_P(dict, params, q).x;
+        float bound = f_P_upper_bound(dict, q.wo, q.wi, q.sigmasRho);
+        evaluated++;
+        if (f > 0.f) {
+            nonZero++;
+            sumRatio += double(f) / double(bound);
+        }
+        if (!(f <= bound * (1.f + 1e-5f))) {
+            if (violations++ < 10)
+                std::cerr << "Query " << i << ": f_P " << f << " > bound " << bound << std::endl;
+        }
+    }
+
+    std::cout << evaluated << " queries, " << nonZero << " non-zero, mean f_P / bound "
+              << (nonZero > 0 ? sumRatio / nonZero : 0.) << std::endl;
+    CHECK(violations == 0);
+    CHECK(nonZero > evaluated / 10);
+    return test::testResult();
+}
@@ -43,6 +43,16 @@ GLSLProgram::~GLSLProgram() {
     glDeleteProgram(handle);
 }
 
+void GLSLProgram::reset() {
+    if (handle != 0) {
+        detachAndDeleteShaderObjects();
+        glDeleteProgram(handle);
+    }
+    handle = 0;
+    linked = false;
+    uniformLocations.clear();
+}
+
 void GLSLProgram::detachAndDeleteShaderObjects() {
 	// Detach and delete the shader objects (if they are not already removed)
 	GLint numShaders = 0;
@@ -262,6 +272,12 @@ void GLSLProgram::bindFragDataLocation(GLuint location, const char *name) {
     glBindFragDataLocation(handle, location, name);
 }
 
+void GLSLProgram::bindUniformBlock(GLuint binding, const char *blockName) {
+    GLuint index = glGetUniformBlockIndex(handle, blockName);
+    if (index != GL_INVALID_INDEX)
+        glUniformBlockBinding(handle, index, binding);
+}
+
 void GLSLProgram::setUniform(const char *name, float x, float y, float z) {
     GLint loc = getUniformLocation(name);
     glUniform3f(loc, x, y, z);
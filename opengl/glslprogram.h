@@ -53,6 +53,8 @@ public:
                        const char *fileName = NULL);
 
     void link();
+    // Delete the program, to compile and link it again
+    void reset();
     void validate();
     void use();
 
@@ -61,6 +63,7 @@ public:
 
     void bindAttribLocation(GLuint location, const char *name);
     void bindFragDataLocation(GLuint location, const char *name);
+    void bindUniformBlock(GLuint binding, const char *blockName);
 
     void setUniform(const char *name, float x, float y, float z);
     void setUniform(const char *name, const glm::vec2 &v);
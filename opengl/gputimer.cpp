@@ -0,0 +1,59 @@
+#include "gputimer.h"
+
+GpuTimer::GpuTimer() :
+	next(0),
+	oldest(0),
+	initialized(false)
+{
+	for (int i = 0; i < QueryCount; i++)
+		pending[i] = false;
+}
+
+GpuTimer::~GpuTimer()
+{
+	if (initialized)
+		glDeleteQueries(QueryCount, queries);
+}
+
+void GpuTimer::begin()
+{
+	// Queries are created with the first measure (needs a context)
+	if (!initialized) {
+		glGenQueries(QueryCount, queries);
+		initialized = true;
+	}
+
+	// Every query is in flight: drop the oldest measure
+	if (pending[next]) {
+		pending[next] = false;
+		oldest = (next + 1) % QueryCount;
+	}
+	glBeginQuery(GL_TIME_ELAPSED, queries[next]);
+}
+
+void GpuTimer::end()
+{
+	glEndQuery(GL_TIME_ELAPSED);
+	pending[next] = true;
+	next = (next + 1) % QueryCount;
+}
+
+bool GpuTimer::lastResult(float& ms)
+{
+	bool found = false;
+	while (pending[oldest]) {
+		GLint available = 0;
+		glGetQueryObjectiv(queries[oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			break;
+
+		GLuint64 ns = 0;
+		glGetQueryObjectui64v(queries[oldest], GL_QUERY_RESULT, &ns);
+		ms = float(double(ns) * 1e-6);
+		found = true;
+
+		pending[oldest] = false;
+		oldest = (oldest + 1) % QueryCount;
+	}
+	return found;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "openglogl.h"
+
+// GPU time of a sequence of commands (GL_TIME_ELAPSED queries).
+// Results are read a few frames later from a ring of queries, so that
+// reading them never stalls the pipeline.
+class GpuTimer
+{
+public:
+	GpuTimer();
+	~GpuTimer();
+
+	// Only one timer can be active at a time
+	void begin();
+	void end();
+
+	// Latest available measure, false if none since the last call
+	bool lastResult(float& ms);
+
+private:
+	static const int QueryCount = 4;
+
+	GLuint queries[QueryCount];
+	bool   pending[QueryCount];
+	int    next;		// Query of the next begin()
+	int    oldest;		// Oldest pending query
+	bool   initialized;
+};
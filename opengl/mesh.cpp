@@ -16,6 +16,7 @@ using std::ifstream;
 #include <sstream>
 using std::istringstream;
 #include <map>
+#include <limits>
 
 Mesh::Mesh( std::vector<Vertex> vertices,
             std::vector<unsigned int> indices,
@@ -53,6 +54,19 @@ Mesh::Mesh( std::vector<Vertex> vertices,
     this->Ns = Ns;
     this->name = name;
     this->texturePool = texturePool;
+    this->glintUBO = 0;
+    this->index = 0;
+
+    // UV bounds of the scaled texture coordinates
+    vec2 uvMin(std::numeric_limits<float>::max());
+    vec2 uvMax(-std::numeric_limits<float>::max());
+    for (const Vertex& v : vertices) {
+        uvMin = glm::min(uvMin, v.TexCoords * scaleUV);
+        uvMax = glm::max(uvMax, v.TexCoords * scaleUV);
+    }
+    if (vertices.empty())
+        uvMin = uvMax = vec2(0.f);
+    this->uvBounds = glm::vec4(uvMin, glm::max(uvMax - uvMin, vec2(1e-6f)));
 
 
     setupMesh();
@@ -120,10 +134,11 @@ void Mesh::Draw(GLSLProgram& shader)
     float alpha = 1.41421356f / sqrt(Ns + 2.f);
     shader.setUniform("Material.Alpha", alpha);
 
-    shader.setUniform("Material.LogMicrofacetDensity", logMicrofacetDensity);
-    shader.setUniform("Material.MicrofacetRelativeArea", microfacetRelativeArea);
+    glBindBufferBase(GL_UNIFORM_BUFFER, GlintBlockBinding, glintUBO);
     
     shader.setUniform("ScaleUV", scaleUV);
+    shader.setUniform("MeshIndex", index);
+    shader.setUniform("MeshUVBounds", uvBounds);
 
     // draw mesh
     glBindVertexArray(VAO);
@@ -131,6 +146,35 @@ void Mesh::Draw(GLSLProgram& shader)
     glBindVertexArray(0);
 }
 
+void Mesh::DrawDepth(GLSLProgram& shader)
+{
+    if (hasMask()) {
+        glActiveTexture(GL_TEXTURE5);
+        texturePool->GetMask(maskTextures[0])->Bind();
+    }
+    shader.setUniform("ScaleUV", scaleUV);
+
+    glBindVertexArray(VAO);
+    glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+    glBindVertexArray(0);
+}
+
+void Mesh::updateGlintLod(int nlevels)
+{
+    glintLod = glint::makeGlintLodBlock(nlevels, logMicrofacetDensity, microfacetRelativeArea);
+
+    if (glintUBO == 0) {
+        glGenBuffers(1, &glintUBO);
+        glBindBuffer(GL_UNIFORM_BUFFER, glintUBO);
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(glintLod), &glintLod, GL_STATIC_DRAW);
+    }
+    else {
+        glBindBuffer(GL_UNIFORM_BUFFER, glintUBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glintLod), &glintLod);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
 void Mesh::setupMesh()
 {
     // create buffers/arrays
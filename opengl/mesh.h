@@ -12,6 +12,7 @@
 #include "glslprogram.h"
 #include "texture.h"
 #include "texturepool.h"
+#include "lodtable.h"
 
 struct Vertex {
     // position
@@ -44,12 +45,21 @@ public:
     float logMicrofacetDensity;
     float microfacetRelativeArea;
 
+    // Glint constants of the material (MaterialGlintBlock)
+    glint::GlintLodBlock glintLod;
+    GLuint glintUBO;
+
     glm::vec3 Kd, Ks;
     float Ns;
 
     unsigned int VAO;
     std::string name;
 
+    // Index in the model and UV bounds (min, extent) of the scaled texture
+    // coordinates: virtual texture of the glint radiance cache
+    int index;
+    glm::vec4 uvBounds;
+
     Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, TexturePool* texturePool,
          std::vector<int> diffuseTextures,
          std::vector<int> heightTextures,
@@ -66,6 +76,18 @@ public:
          const std::string& name);
 
     void Draw(GLSLProgram& shader);
+
+    // Depth only: binds the mask texture (unit 5) and the UV scale, nothing
+    // else
+    void DrawDepth(GLSLProgram& shader);
+    bool hasMask() const { return !maskTextures.empty(); }
+
+    // Uniform buffer binding point of MaterialGlintBlock
+    static const GLuint GlintBlockBinding = 0;
+
+    // Precompute the glint constants of the material, nlevels: number of
+    // levels of the dictionary
+    void updateGlintLod(int nlevels);
 private:
     //  render data
     unsigned int VBO, EBO;
@@ -16,6 +16,7 @@ using std::ifstream;
 #include <sstream>
 using std::istringstream;
 #include <map>
+#include <algorithm>
 
 #include "stb/stb_image.h"
 
@@ -30,11 +31,33 @@ void Model::DrawMeshX(GLSLProgram& shader, int X)
 	meshes[X].Draw(shader);
 }
 
+void Model::DrawDepth(GLSLProgram& shader, bool masked)
+{
+	for (Mesh& mesh : meshes)
+		if (mesh.hasMask() == masked)
+			mesh.DrawDepth(shader);
+}
+
 std::string Model::getNameMeshX(int X)
 {
 	return meshes[X].name;
 }
 
+std::vector<float> Model::getMicrofacetRelativeAreas()
+{
+	std::vector<float> areas;
+	for (const Mesh& mesh : meshes)
+		if (std::find(areas.begin(), areas.end(), mesh.microfacetRelativeArea) == areas.end())
+			areas.push_back(mesh.microfacetRelativeArea);
+	return areas;
+}
+
+void Model::updateGlintLod(int nlevels)
+{
+	for (Mesh& mesh : meshes)
+		mesh.updateGlintLod(nlevels);
+}
+
 void Model::loadModel(const std::string& path)
 {
 	Assimp::Importer importer;
@@ -56,8 +79,10 @@ void Model::processNode(aiNode* node, const aiScene* scene)
 	for (unsigned int i = 0; i < node->mNumMeshes; i++)
 	{
 		aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-		if(mesh->mTangents != NULL)
+		if(mesh->mTangents != NULL) {
 			meshes.push_back(processMesh(mesh, scene));
+			meshes.back().index = int(meshes.size()) - 1;
+		}
 	}
 	// then do the same for each of its children
 	for (unsigned int i = 0; i < node->mNumChildren; i++)
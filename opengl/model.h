@@ -26,7 +26,18 @@ public:
 	}
 	void Draw(GLSLProgram& shader);
 	void DrawMeshX(GLSLProgram& shader, int X);
+	// Depth prepass of the meshes with (masked) or without a mask texture
+	void DrawDepth(GLSLProgram& shader, bool masked);
 	std::string getNameMeshX(int X);
+	int getMeshCount() const { return int(meshes.size()); }
+	// UV bounds (min, extent) of the scaled texture coordinates of mesh X
+	glm::vec4 getUVBoundsMeshX(int X) const { return meshes[X].uvBounds; }
+	// Glint constants of the material of mesh X
+	const glint::GlintLodBlock& getGlintLodMeshX(int X) const { return meshes[X].glintLod; }
+	// Distinct microfacet relative areas of the materials
+	std::vector<float> getMicrofacetRelativeAreas();
+	// Precompute the glint constants of all the materials
+	void updateGlintLod(int nlevels);
 private:
 	// texture data
 	TexturePool* texturePool;
@@ -18,6 +18,10 @@ struct SceneSettings {
     glm::vec2   directional_light_direction;
     float       directional_light_intensity;
     float       scale_intensity_envmap;
+    int         reference_samples = 1024;   // Samples per pixel of the references
+    int         reference_sequence = 0;     // Subpixel sample positions (glint::SampleSequence)
+    std::string reference_checkpoint;       // Checkpoint file of the references, none if empty
+    bool        reference_resume = false;   // Resume the reference of the checkpoint file
 };
 
 class Scene
@@ -29,8 +33,10 @@ public:
     int width;
     int height;
     int samples;
+    bool shaderFloat16; // float16_t arithmetic in shaders (see SceneRunner)
+    bool computeShaders; // compute shaders and storage buffers (OpenGL 4.3)
 
-	Scene() : width(800), height(600) { }
+	Scene() : width(800), height(600), samples(0), shaderFloat16(false), computeShaders(false) { }
 	virtual ~Scene() {}
 
 	void setDimensions( int w, int h ) {
@@ -139,9 +139,43 @@ public:
         return recipeName;
     }
 
+    // float16_t arithmetic in GLSL 4.50 shaders, through one of the
+    // extensions enabled by improved_glint_envmap.frag.glsl. Without them
+    // the half-precision variant is not offered.
+    // GL_EXT_shader_explicit_arithmetic_types_float16 is not an OpenGL
+    // extension: the GL drivers do not accept it in #version 450 core.
+    static bool supportsShaderFloat16() {
+#ifdef __APPLE__
+        return false;
+#else
+        const char* float16Extensions[] = {
+            "GL_AMD_gpu_shader_half_float",
+            "GL_NV_gpu_shader5"
+        };
+        GLint nExtensions = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &nExtensions);
+        for (GLint i = 0; i < nExtensions; i++) {
+            const char* ext = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            for (const char* float16Ext : float16Extensions)
+                if (std::string(ext) == float16Ext)
+                    return true;
+        }
+        return false;
+#endif
+    }
+
+    // The Mac context is OpenGL 4.1
+    static bool supportsComputeShaders() {
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major);
+        glGetIntegerv(GL_MINOR_VERSION, &minor);
+        return major > 4 || (major == 4 && minor >= 3);
+    }
+
 private:
     static void printHelpInfo(const char * exeFile,  std::map<std::string, std::string> & sceneData) {
-        printf("Usage: %s scene-name\n\n", exeFile);
+        printf("Usage: %s scene-name [--samples spp] [--sampler grid|sobol|r2|bluenoise]\n"
+               "       [--checkpoint file] [--resume]\n\n", exeFile);
         printf("Scene names: \n");
         for( auto it : sceneData ) {
             printf("  %11s : %s\n", it.first.c_str(), it.second.c_str());
@@ -152,6 +186,8 @@ private:
         
         scene->setDimensions(fbw, fbh);
         scene->samples = samples;
+        scene->shaderFloat16 = supportsShaderFloat16();
+        scene->computeShaders = supportsComputeShaders();
         scene->initScene();
         scene->resize(fbw, fbh);
 
@@ -1,79 +1,41 @@
-#define TINYEXR_IMPLEMENTATION
-
 #include "texture.h"
 #include "stb/stb_image.h"
 #include "glutils.h"
-#include "tinyexr.h"
+#include "dictionary.h"
+#include "celltables.h"
+#include "bluenoise.h"
+#include "radiancecache.h"
+#include <algorithm>
 #include <cmath>
 #include <array>
 
-const char* err = nullptr;
-
 GLuint Texture::loadMultiscaleMarginalDistributions(const std::string& baseName, const unsigned int nlevels, const GLsizei ndists)
 {
-	GLuint texID;
-	glGenTextures(1, &texID);
-	glBindTexture(GL_TEXTURE_1D_ARRAY, texID);
-
-	GLint width;
-	GLint height;
-	GLsizei layerCount = ndists * nlevels;
-
-	// Load the first one to get width/height
-	std::string texName = baseName + "_0000" + "_" + "0000" + ".exr";
-	float* data;
-	bool ret = exrio::LoadEXRRGBA(&data, &width, &height, texName.c_str(), err);
-	if (!ret) {
+	// The EXR files are read by the CPU dictionary of the glint library,
+	// so that the texture and the CPU evaluation share the same texels.
+	glint::Dictionary dictionary;
+	if (!dictionary.load(baseName, nlevels, ndists)) {
 		exit(-1);
 	}
 
+	return createMultiscaleMarginalDistributions(dictionary);
+}
 
+GLuint Texture::createMultiscaleMarginalDistributions(const glint::Dictionary& dictionary)
+{
+	GLuint texID;
+	glGenTextures(1, &texID);
+	glBindTexture(GL_TEXTURE_1D_ARRAY, texID);
 
-	GLsizei mipLevelCount = 1 + (GLsizei)log2f(width);
+	GLint width = dictionary.GetWidth();
+	GLsizei layerCount = dictionary.GetLayerCount();
+	GLsizei mipLevelCount = dictionary.GetMipLevelCount();
 
 	// Allocate the storage
 	glTexStorage2D(GL_TEXTURE_1D_ARRAY, mipLevelCount, GL_RGB16F, width, layerCount);
 
 	// Upload pixel data
-	glTexSubImage2D(GL_TEXTURE_1D_ARRAY, 0, 0, 0, width, 1, GL_RGBA, GL_FLOAT, data);
-
-	free(data);
-
-	// Load the other 1D distributions
-	for (GLsizei l = 0; l < nlevels; ++l) {
-		std::string index_level;
-		if (l < 10)
-			index_level = "000" + std::to_string(l);
-		else if (l < 100)
-			index_level = "00" + std::to_string(l);
-		else if (l < 1000)
-			index_level = "0" + std::to_string(l);
-		else
-			index_level = std::to_string(l);
-
-		for (int i = 0; i < ndists; i++) {
-
-			if (l == 0 && i == 0) continue;
-
-			std::string index_dist;
-			if (i < 10)
-				index_dist = "000" + std::to_string(i);
-			else if (i < 100)
-				index_dist = "00" + std::to_string(i);
-			else if (i < 1000)
-				index_dist = "0" + std::to_string(i);
-			else
-				index_dist = std::to_string(i);
-
-			texName = baseName + "_" + index_dist + "_" + index_level + ".exr";
-			bool ret = exrio::LoadEXRRGBA(&data, &width, &height, texName.c_str(), err);
-			if (!ret) {
-				exit(-1);
-			}
-			glTexSubImage2D(GL_TEXTURE_1D_ARRAY, 0, 0, l * ndists + i, width, 1, GL_RGBA, GL_FLOAT, data);
-			free(data);
-		}
-	}
+	glTexSubImage2D(GL_TEXTURE_1D_ARRAY, 0, 0, 0, width, layerCount, GL_RGB, GL_FLOAT, dictionary.GetTexels(0, 0));
 
 	glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 	glTexParameteri(GL_TEXTURE_1D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
@@ -84,6 +46,118 @@ GLuint Texture::loadMultiscaleMarginalDistributions(const std::string& baseName,
 	return texID;
 }
 
+GLuint Texture::createPairedMarginalDistributions(const glint::Dictionary& dictionary)
+{
+	GLuint texID;
+	glGenTextures(1, &texID);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texID);
+
+	GLint width = dictionary.GetWidth();
+	GLsizei layerCount = dictionary.GetPairedLayerCount();
+	GLsizei layersPerLevel = dictionary.N() / 4;
+	GLsizei mipLevelCount = dictionary.GetMipLevelCount();
+
+	// 16 levels of 192 distributions: 768 layers of 64 x 64, 33 MB
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, mipLevelCount, GL_RGBA16F, width, width, layerCount);
+
+	// Products of the mip levels of the marginals (exact box filter)
+	std::vector<float> texels;
+	for (GLsizei m = 0; m < mipLevelCount; m++) {
+		GLint mipWidth = std::max(1, width >> m);
+		for (int l = 0; l < dictionary.NLevels(); l++) {
+			dictionary.GetPairedTexels(m, l, texels);
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, m, 0, 0, l * layersPerLevel, mipWidth, mipWidth, layersPerLevel, GL_RGBA, GL_FLOAT, texels.data());
+		}
+	}
+
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_MIRRORED_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_MIRRORED_REPEAT);
+
+	return texID;
+}
+
+GLuint Texture::createCellOccupancyTexture(const std::vector<float>& areas, int levelCount)
+{
+	GLuint texID;
+	glGenTextures(1, &texID);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texID);
+
+	// 32 cells per texel
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_R32UI, glint::kCellTileSize / 32, glint::kCellTileSize, GLsizei(areas.size()) * levelCount);
+
+	// Integer texture: only texelFetch is used
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	for (int i = 0; i < int(areas.size()); i++)
+		updateCellOccupancyTexture(texID, i, areas[i], levelCount);
+
+	return texID;
+}
+
+void Texture::updateCellOccupancyTexture(GLuint texID, int areaIndex, float area, int levelCount)
+{
+	std::vector<uint32_t> words = glint::occupancyBitmask(area, levelCount);
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texID);
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, areaIndex * levelCount, glint::kCellTileSize / 32, glint::kCellTileSize, levelCount, GL_RED_INTEGER, GL_UNSIGNED_INT, words.data());
+}
+
+GLuint Texture::createBlueNoiseTexture(int size)
+{
+	std::vector<float> values = glint::blueNoise(size);
+
+	GLuint texID;
+	glGenTextures(1, &texID);
+	glBindTexture(GL_TEXTURE_2D, texID);
+
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, size, size);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, size, size, GL_RED, GL_FLOAT, values.data());
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+	return texID;
+}
+
+GLuint Texture::createCachePageTable(int meshCount)
+{
+	GLuint texID;
+	glGenTextures(1, &texID);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texID);
+
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, glint::kCacheLevels, GL_R16UI, glint::kCacheVirtualPages, glint::kCacheVirtualPages, std::max(1, meshCount));
+
+	// Nothing is resident
+	std::vector<uint16_t> zeros(size_t(glint::kCacheVirtualPages) * glint::kCacheVirtualPages * std::max(1, meshCount), 0);
+	for (int l = 0; l < glint::kCacheLevels; l++) {
+		int size = glint::kCacheVirtualPages >> l;
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, l, 0, 0, 0, size, size, std::max(1, meshCount), GL_RED_INTEGER, GL_UNSIGNED_SHORT, zeros.data());
+	}
+
+	// Integer texture: only texelFetch is used
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, glint::kCacheLevels - 1);
+
+	return texID;
+}
+
+void Texture::updateCachePageTable(GLuint texID, const glint::PageTableEntry* entries, size_t count)
+{
+	glBindTexture(GL_TEXTURE_2D_ARRAY, texID);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+	for (size_t i = 0; i < count; i++) {
+		const glint::CachePage& page = entries[i].page;
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, page.level, page.x, page.y, page.mesh, 1, 1, 1, GL_RED_INTEGER, GL_UNSIGNED_SHORT, &entries[i].value);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
 
 GLuint Texture::loadTexture(const std::string& fName, bool generate_mipmap, bool flip, int& width_out, int& height_out) {
 	int width, height, bytesPerPix, mipLevelCount;
@@ -19,6 +19,8 @@
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+namespace glint { class Dictionary; struct PageTableEntry; }
+
 class Texture {
 // Static declarations
 public:
@@ -35,6 +37,22 @@ public:
     };
 
     static GLuint loadMultiscaleMarginalDistributions(const std::string& baseName, const unsigned int nlevels, const GLsizei ndists);
+    static GLuint createMultiscaleMarginalDistributions(const glint::Dictionary& dictionary);
+    // Paired layout (see glint::Dictionary::GetPairedTexels), RGBA16F 2D array
+    static GLuint createPairedMarginalDistributions(const glint::Dictionary& dictionary);
+
+    // Cell occupancy bitmasks of the glint shader (see glint/celltables.h).
+    // R32UI 2D array, layer = area index * levelCount + level.
+    static GLuint createCellOccupancyTexture(const std::vector<float>& areas, int levelCount);
+    static void   updateCellOccupancyTexture(GLuint texID, int areaIndex, float area, int levelCount);
+
+    // Blue noise tile (R32F, repeated), see glint/bluenoise.h.
+    static GLuint createBlueNoiseTexture(int size);
+
+    // Page table of the glint radiance cache (see glint/radiancecache.h),
+    // R16UI 2D array, one mip level per cache level, layer = mesh.
+    static GLuint createCachePageTable(int meshCount);
+    static void   updateCachePageTable(GLuint texID, const glint::PageTableEntry* entries, size_t count);
 
     static GLuint loadTexture(const std::string& fName, bool generate_mipmap, bool flip, int& width_out, int& height_out);
     static GLuint loadTexture1D(const std::string& fName, bool generate_mipmap = true, bool flip = false);